@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+#include "glm/vec2.hpp"
+
+#include "vecy/rect.h"
+
+inline glm::vec2 from_to(const glm::vec2& f, const glm::vec2& t)
+{
+    return t - f;
+}
+
+struct CanvasTransform
+{
+    // canvas view
+    glm::vec2 scroll = glm::vec2{0.0f, 0.0f};
+    float scale = 1.0f;
+
+    // "config"
+    float scale_range_min = 0.1f;
+    float scale_range_max = 15.0f;
+
+    void zoom(const glm::vec2& mouse, float zoom)
+    {
+        // todo(Gustav): change to use screen_to_world
+        const auto focus = from_screen_to_world(mouse);
+
+        const float scale_factor = 1 + 0.01f * std::abs(zoom);
+
+        if (zoom < 0.0f)
+        {
+            scale /= scale_factor;
+        }
+
+        if (zoom > 0.0f)
+        {
+            scale *= scale_factor;
+        }
+
+        scale = std::min(std::max(scale_range_min, scale), scale_range_max);
+
+        const auto new_focus = from_world_to_screen(focus);
+        scroll = scroll + from_to(new_focus, mouse);
+    }
+
+    [[nodiscard]] glm::vec2 from_screen_to_world(const glm::vec2& p) const
+    {
+        return (p - scroll) / scale;
+    }
+
+    [[nodiscard]] glm::vec2 from_world_to_screen(const glm::vec2& p) const
+    {
+        return scroll + p * scale;
+    }
+};
+
+inline Rect from_world_to_screen(const CanvasTransform& t, const Rect& r)
+{
+    const glm::vec2 p = t.from_world_to_screen(r.topleft);
+    const glm::vec2 s = t.from_world_to_screen(r.topleft + r.size);
+    return {p, s - p};
+}
+
+inline Rect from_screen_to_world(const CanvasTransform& t, const Rect& r)
+{
+    const glm::vec2 p = t.from_screen_to_world(r.topleft);
+    const glm::vec2 s = t.from_screen_to_world(r.topleft + r.size);
+    return {p, s - p};
+}
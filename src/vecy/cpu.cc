@@ -0,0 +1,41 @@
+#include "vecy/cpu.h"
+
+#if defined(VECY_X86) && defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+bool has_sse2()
+{
+#if defined(VECY_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#elif defined(VECY_X86)
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+bool has_avx2()
+{
+#if defined(VECY_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) { return false; }
+
+    // the os must also save the ymm registers
+    __cpuid(info, 1);
+    const bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    const bool has_avx = (info[2] & (1 << 28)) != 0;
+    if (has_osxsave == false || has_avx == false) { return false; }
+    if ((_xgetbv(0) & 6) != 6) { return false; }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(VECY_X86)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define VECY_X86 1
+    #include <immintrin.h>
+#endif
+
+// lets gcc and clang compile a function for a newer instruction set than the rest of the file
+#if defined(__GNUC__)
+    #define VECY_TARGET(x) __attribute__((target(x)))
+#else
+    #define VECY_TARGET(x)
+#endif
+
+// if the cpu, and for avx2 the os, supports the instruction set. always false off x86
+bool has_sse2();
+bool has_avx2();
@@ -0,0 +1,643 @@
+#include "vecy/document.h"
+
+#include <cmath>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+
+#include "open-color.h"
+
+#include "vecy/profiler.h"
+
+Id Document::add_rectangle(const Rgba& color, const Rect& rect)
+{
+    const auto id = ids.create();
+    shapes.add({ id, color, rect });
+    index.insert(id, rect);
+    version += 1;
+    add_change(rect);
+    return id;
+}
+
+Id Document::add_path(PathGeometry geometry, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    const auto id = ids.create();
+    shapes.add(PathShape{ id, std::move(geometry), fill, outline });
+    const auto bounds = shapes.paths.bounds.back();
+    index.insert(id, bounds);
+    version += 1;
+    add_change(bounds);
+    return id;
+}
+
+Id Document::add_instance(u32 symbol, const glm::vec2& offset, float scale, const std::optional<Rgba>& color)
+{
+    const auto id = ids.create();
+    shapes.add(InstanceShape{ id, symbol, offset, scale, color });
+    const auto bounds = shapes.instances.bounds.back();
+    index.insert(id, bounds);
+    version += 1;
+    add_change(bounds);
+    return id;
+}
+
+void Document::add_rectangles(std::vector<RectangleShape>* new_shapes)
+{
+    if (new_shapes->empty())
+    {
+        return;
+    }
+
+    // the shapes are appended so their slots are the last ones in the store
+    const auto first = static_cast<u32>(shapes.rectangles.size());
+    auto area = new_shapes->front().rect;
+    for (auto& shape : *new_shapes)
+    {
+        shape.id = ids.create();
+        shapes.add(shape);
+        area.include(shape.rect);
+    }
+
+    const auto& rectangles = shapes.rectangles;
+    index.insert_bulk(rectangles.ids.data() + first, rectangles.rects.data() + first, new_shapes->size());
+    version += 1;
+    add_change(area);
+}
+
+void Document::restore_rectangles(const std::vector<RectangleShape>& old_shapes)
+{
+    if (old_shapes.empty())
+    {
+        return;
+    }
+
+    const auto first = static_cast<u32>(shapes.rectangles.size());
+    auto area = old_shapes.front().rect;
+    for (const auto& shape : old_shapes)
+    {
+        assert(shapes.contains(shape.id) == false);
+        shapes.add(shape);
+        area.include(shape.rect);
+    }
+
+    const auto& rectangles = shapes.rectangles;
+    index.insert_bulk(rectangles.ids.data() + first, rectangles.rects.data() + first, old_shapes.size());
+    version += 1;
+    add_change(area);
+}
+
+void Document::add_paths(std::vector<PathShape>* new_shapes)
+{
+    for (auto& shape : *new_shapes)
+    {
+        shape.id = ids.create();
+    }
+    restore_paths(*new_shapes);
+}
+
+void Document::restore_paths(const std::vector<PathShape>& old_shapes)
+{
+    if (old_shapes.empty())
+    {
+        return;
+    }
+
+    const auto first = static_cast<u32>(shapes.paths.size());
+    for (const auto& shape : old_shapes)
+    {
+        assert(shapes.contains(shape.id) == false);
+        shapes.add(shape);
+    }
+
+    const auto& paths = shapes.paths;
+    auto area = paths.bounds[first];
+    for (u32 slot = first; slot < paths.size(); slot += 1)
+    {
+        area.include(paths.bounds[slot]);
+    }
+    index.insert_bulk(paths.ids.data() + first, paths.bounds.data() + first, old_shapes.size());
+    version += 1;
+    add_change(area);
+}
+
+void Document::add_instances(std::vector<InstanceShape>* new_shapes)
+{
+    for (auto& shape : *new_shapes)
+    {
+        shape.id = ids.create();
+    }
+    restore_instances(*new_shapes);
+}
+
+void Document::restore_instances(const std::vector<InstanceShape>& old_shapes)
+{
+    if (old_shapes.empty())
+    {
+        return;
+    }
+
+    const auto first = static_cast<u32>(shapes.instances.size());
+    for (const auto& shape : old_shapes)
+    {
+        assert(shapes.contains(shape.id) == false);
+        shapes.add(shape);
+    }
+
+    const auto& instances = shapes.instances;
+    auto area = instances.bounds[first];
+    for (u32 slot = first; slot < instances.size(); slot += 1)
+    {
+        area.include(instances.bounds[slot]);
+    }
+    index.insert_bulk(instances.ids.data() + first, instances.bounds.data() + first, old_shapes.size());
+    version += 1;
+    add_change(area);
+}
+
+void Document::remove(const std::vector<Id>& removed)
+{
+    std::optional<Rect> area;
+    const auto include = [&area](const Rect& r)
+    {
+        if (area) { area->include(r); }
+        else { area = r; }
+    };
+
+    for (const auto id : removed)
+    {
+        if (const auto found = find_base(id))
+        {
+            hide_base(*found);
+            include(base->get_rect(*found));
+            continue;
+        }
+
+        if (const auto old = index.get_bounds(id))
+        {
+            include(*old);
+        }
+        index.remove(id);
+        shapes.remove(id);
+    }
+
+    version += 1;
+    if (area)
+    {
+        add_change(*area);
+    }
+}
+
+void Document::remove(Id id)
+{
+    if (const auto found = find_base(id))
+    {
+        hide_base(*found);
+        version += 1;
+        add_change(base->get_rect(*found));
+        return;
+    }
+
+    const auto old = index.get_bounds(id);
+    index.remove(id);
+    shapes.remove(id);
+    version += 1;
+    if (old)
+    {
+        add_change(*old);
+    }
+}
+
+void Document::on_changed(Id id)
+{
+    const auto ref = shapes.find(id);
+    if (ref.kind == ShapeKind::none) { assert(false); return; }
+
+    // both where the shape was and where it is now needs to be redrawn
+    const auto old = index.get_bounds(id);
+    const auto bounds = shapes.get_bounds(ref);
+    index.update(id, bounds);
+    version += 1;
+    if (old)
+    {
+        add_change(*old);
+    }
+    add_change(bounds);
+}
+
+void Document::on_changed(const std::vector<Id>& changed)
+{
+    // one change for where the shapes were and one for where they are, instead of two per shape
+    std::optional<Rect> old_area;
+    std::optional<Rect> new_area;
+    const auto include = [](std::optional<Rect>* area, const Rect& r)
+    {
+        if (*area) { (*area)->include(r); }
+        else { *area = r; }
+    };
+
+    // many shapes are refit in place, moving them one by one in the index costs more than the edit
+    constexpr std::size_t min_refit_count = 256;
+    const bool refit = changed.size() >= min_refit_count;
+    std::vector<Id> refit_ids;
+    std::vector<Rect> refit_bounds;
+
+    for (const auto id : changed)
+    {
+        const auto ref = shapes.find(id);
+        if (ref.kind == ShapeKind::none) { assert(false); continue; }
+
+        const auto bounds = shapes.get_bounds(ref);
+        const auto old = index.get_bounds(id);
+        include(&new_area, bounds);
+        if (old && old->topleft == bounds.topleft && old->size == bounds.size)
+        {
+            // restyled, the index doesn't change
+            continue;
+        }
+        if (old)
+        {
+            include(&old_area, *old);
+        }
+        if (refit)
+        {
+            refit_ids.push_back(id);
+            refit_bounds.push_back(bounds);
+        }
+        else
+        {
+            index.update(id, bounds);
+        }
+    }
+    index.refit(refit_ids.data(), refit_bounds.data(), refit_ids.size());
+
+    version += 1;
+    if (old_area) { add_change(*old_area); }
+    if (new_area) { add_change(*new_area); }
+}
+
+void Document::set_base(std::shared_ptr<const DocumentFile> file)
+{
+    shapes.clear();
+    index.clear();
+    base = std::move(file);
+    base_hidden.clear();
+    base_hidden_count = 0;
+    ids.next = base ? base->get_header().next_id : 0;
+
+    // nothing cached from the old shapes is valid
+    version += 1;
+    changes.clear();
+    changes_start_version = version;
+}
+
+bool Document::materialize(Id id)
+{
+    if (shapes.contains(id))
+    {
+        return true;
+    }
+
+    const auto found = find_base(id);
+    if (found.has_value() == false)
+    {
+        return false;
+    }
+
+    // keeps the id so the paint order is the same
+    const auto rect = base->get_rect(*found);
+    shapes.add({ id, base->get_color(*found), rect });
+    index.insert(id, rect);
+    hide_base(*found);
+    return true;
+}
+
+std::optional<u32> Document::find_base(Id id) const
+{
+    if (base == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    const auto found = base->find(id);
+    if (found && is_base_hidden(*found))
+    {
+        return std::nullopt;
+    }
+    return found;
+}
+
+std::optional<Rect> Document::get_bounds(Id id) const
+{
+    const auto ref = shapes.find(id);
+    if (ref.kind != ShapeKind::none)
+    {
+        return shapes.get_bounds(ref);
+    }
+    if (const auto found = find_base(id))
+    {
+        return base->get_rect(*found);
+    }
+    return std::nullopt;
+}
+
+std::size_t Document::size() const
+{
+    const std::size_t base_size = base ? base->size() - base_hidden_count : 0;
+    return shapes.size() + base_size;
+}
+
+void Document::hide_base(u32 index)
+{
+    if (base_hidden.empty())
+    {
+        base_hidden.resize(base->size(), false);
+    }
+    if (base_hidden[index] == false)
+    {
+        base_hidden[index] = true;
+        base_hidden_count += 1;
+    }
+}
+
+void Document::add_change(const Rect& area)
+{
+    // a long log costs more to walk than redrawing everything
+    constexpr std::size_t max_changes = 4096;
+    if (changes.size() >= max_changes)
+    {
+        changes.clear();
+        changes_start_version = version;
+    }
+    changes.push_back({ version, area });
+}
+
+WorldHitTest::WorldHitTest(const CanvasTransform& t, const glm::vec2& p, float e)
+    : transform(t)
+    , screen_point(p)
+    , extra(e)
+    , world_point(t.from_screen_to_world(p))
+    , world_extra(e / t.scale)
+{
+    // a pixel of slack so the query also has every shape the rounding could include
+    query = Rect{ world_point, {0, 0} }.extend((extra + 1.0f) / t.scale);
+    magnitude =
+        (std::abs(t.scroll.x) + std::abs(t.scroll.y) + std::abs(p.x) + std::abs(p.y) + 2.0f * extra) / t.scale
+        + std::abs(world_point.x) + std::abs(world_point.y) + 2.0f * world_extra;
+}
+
+bool WorldHitTest::is_rectangle_hit(const Rect& rect) const
+{
+    if (const auto hit = get_world_rectangle_hit(rect))
+    {
+        return *hit;
+    }
+    return ::is_rectangle_hit(transform, rect, screen_point, extra);
+}
+
+std::optional<bool> WorldHitTest::get_world_rectangle_hit(const Rect& rect) const
+{
+    // how far inside the extended rect the point is, negative when outside
+    const auto& w = world_point;
+    const float inside = std::min
+    (
+        std::min(w.x - (rect.topleft.x - world_extra), (rect.topleft.x + rect.size.x + world_extra) - w.x),
+        std::min(w.y - (rect.topleft.y - world_extra), (rect.topleft.y + rect.size.y + world_extra) - w.y)
+    );
+
+    // both tests round a handful of times on values about this large. the check disagrees with the screen
+    // test below half an epsilon, the rest is margin. wider only sends more tests to the screen space
+    const float slack = 16.0f * std::numeric_limits<float>::epsilon() *
+        (magnitude + 2.0f * (std::abs(rect.topleft.x) + std::abs(rect.topleft.y) + std::abs(rect.size.x) + std::abs(rect.size.y)));
+    if (inside > slack) { return true; }
+    if (inside < -slack) { return false; }
+    return std::nullopt;
+}
+
+bool WorldHitTest::is_path_hit(const PathArray& paths, u32 slot) const
+{
+    // the flattening is within a fraction of a pixel of the curves, closer than the rounding matters
+    const auto view = paths.get_flattened(slot, transform.scale).get_view();
+    if (paths.fills[slot] && is_inside_path(view, world_point))
+    {
+        return true;
+    }
+    const auto& outline = paths.outlines[slot];
+    const float half_width = outline ? static_cast<float>(outline->width) * 0.5f : 0.0f;
+    return is_near_path_outline(view, world_point, world_extra + half_width);
+}
+
+bool WorldHitTest::is_instance_hit(const ShapeStore& store, u32 slot) const
+{
+    // the symbol is tested as if it was drawn on its own with the transform of the instance,
+    // so the instance is hit where the same shapes added to the document would be
+    const auto& symbol = store.symbols[store.instances.symbols[slot]];
+    const auto local = WorldHitTest{ get_instance_transform(transform, store.instances, slot), screen_point, extra };
+    for (u32 shape = 0; shape < symbol.rectangles.size(); shape += 1)
+    {
+        if (local.is_rectangle_hit(symbol.rectangles.rects[shape]))
+        {
+            return true;
+        }
+    }
+    for (u32 shape = 0; shape < symbol.paths.size(); shape += 1)
+    {
+        if (local.is_rectangle_hit(symbol.paths.bounds[shape]) && local.is_path_hit(symbol.paths, shape))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename F>
+void Document::for_each_hit(const WorldHitTest& hit, F&& on_hit) const
+{
+    index.query_intersecting(hit.query, [&](Id id, const Rect& bounds)
+    {
+        const auto ref = shapes.find(id);
+        switch (ref.kind)
+        {
+        case ShapeKind::rectangle:
+            // the bounds of a rectangle is the rectangle
+            if (hit.is_rectangle_hit(bounds))
+            {
+                on_hit(id);
+            }
+            break;
+        case ShapeKind::path:
+            // most misses are outside the bounds and never look at the flattened path
+            if (hit.is_rectangle_hit(bounds) && hit.is_path_hit(shapes.paths, ref.slot))
+            {
+                on_hit(id);
+            }
+            break;
+        case ShapeKind::instance:
+            if (hit.is_rectangle_hit(bounds) && hit.is_instance_hit(shapes, ref.slot))
+            {
+                on_hit(id);
+            }
+            break;
+        case ShapeKind::none:
+            assert(false);
+            break;
+        }
+    });
+    if (base != nullptr)
+    {
+        base->query_intersecting(hit.query, [&](u32 index)
+        {
+            if (is_base_hidden(index) == false && hit.is_rectangle_hit(base->get_rect(index)))
+            {
+                on_hit(base->get_id(index));
+            }
+        });
+    }
+}
+
+void Document::get_hit(const CanvasTransform& t, const glm::vec2& p, float extra, IdSet* hits) const
+{
+    VECY_PROFILE_SCOPE("get_hit");
+    hits->clear();
+    for_each_hit(WorldHitTest{ t, p, extra }, [&](Id id) { hits->insert(id); });
+}
+
+void Document::get_hits(const CanvasTransform& t, const glm::vec2& p, float extra, std::vector<Id>* hits, std::size_t max_hits) const
+{
+    VECY_PROFILE_SCOPE("get_hit");
+    hits->clear();
+    if (max_hits == 0)
+    {
+        return;
+    }
+
+    // shapes are painted in id order so the topmost has the largest id
+    const auto is_above = [](const Id& lhs, const Id& rhs) { return lhs.id > rhs.id; };
+    for_each_hit(WorldHitTest{ t, p, extra }, [&](Id id)
+    {
+        if (hits->size() < max_hits)
+        {
+            hits->push_back(id);
+            std::push_heap(hits->begin(), hits->end(), is_above);
+        }
+        else if (is_above(id, hits->front()))
+        {
+            // replace the lowest of the kept hits
+            std::pop_heap(hits->begin(), hits->end(), is_above);
+            hits->back() = id;
+            std::push_heap(hits->begin(), hits->end(), is_above);
+        }
+    });
+    std::sort_heap(hits->begin(), hits->end(), is_above);
+}
+
+std::optional<Id> Document::get_topmost_hit(const CanvasTransform& t, const glm::vec2& p, float extra) const
+{
+    VECY_PROFILE_SCOPE("get_hit");
+    std::optional<Id> topmost;
+    for_each_hit(WorldHitTest{ t, p, extra }, [&](Id id)
+    {
+        if (topmost.has_value() == false || id.id > topmost->id)
+        {
+            topmost = id;
+        }
+    });
+    return topmost;
+}
+
+void Document::get_selection(const CanvasTransform& t, const Rect& screen_rect, bool enclosed, IdSet* selection) const
+{
+    selection->clear();
+    const auto world = from_screen_to_world(t, screen_rect);
+    const auto on_hit = [&](Id id, const Rect&) { selection->insert(id); };
+    if (enclosed)
+    {
+        index.query_enclosed(world, on_hit);
+    }
+    else
+    {
+        index.query_intersecting(world, on_hit);
+    }
+    if (base != nullptr)
+    {
+        base->query_intersecting(world, [&](u32 index)
+        {
+            if (is_base_hidden(index) == false && (enclosed == false || world.contains(base->get_rect(index))))
+            {
+                selection->insert(base->get_id(index));
+            }
+        });
+    }
+}
+
+void add_example_shapes(Document* document)
+{
+    document->add_rectangle(open_color::red_5 , Rect{{10, 10}, {10, 10}});
+    document->add_rectangle(open_color::blue_5, Rect{{25, 10}, {10, 30}});
+
+    PathGeometry drop;
+    drop.move_to({50, 10});
+    drop.cubic_to({58, 22}, {60, 28}, {50, 40});
+    drop.quad_to({40, 28}, {50, 10});
+    drop.close();
+    document->add_path(std::move(drop), Fill{ open_color::green_5, FillStyle::solid }, Outline{ open_color::green_9, 1, LineStyle::solid });
+
+    // a component with pins, placed a few times
+    Symbol chip;
+    chip.add_rectangle(open_color::gray_7, Rect{{0, 0}, {12, 16}});
+    for (int pin = 0; pin < 3; pin += 1)
+    {
+        const auto y = 2.0f + static_cast<float>(pin) * 5.0f;
+        chip.add_rectangle(open_color::yellow_6, Rect{{-3, y}, {3, 2}});
+        chip.add_rectangle(open_color::yellow_6, Rect{{12, y}, {3, 2}});
+    }
+    PathGeometry notch;
+    notch.move_to({4, 0});
+    notch.quad_to({6, 4}, {8, 0});
+    notch.close();
+    chip.add_path(std::move(notch), Fill{ open_color::gray_4, FillStyle::solid }, std::nullopt);
+
+    const auto symbol = document->shapes.add_symbol(std::move(chip));
+    document->add_instance(symbol, {70, 10});
+    document->add_instance(symbol, {90, 10}, 0.5f);
+    document->add_instance(symbol, {105, 10}, 1.5f, Rgba{ open_color::indigo_5 });
+}
+
+bool is_rectangle_hit(const CanvasTransform& t, const Rect& rect, const glm::vec2& p, float extra)
+{
+    return from_world_to_screen(t, rect).extend(extra).contains(p);
+}
+
+bool is_path_hit(const CanvasTransform& t, const PathArray& paths, u32 slot, const glm::vec2& p, float extra)
+{
+    return is_rectangle_hit(t, paths.bounds[slot], p, extra) && WorldHitTest{ t, p, extra }.is_path_hit(paths, slot);
+}
+
+bool is_instance_hit(const CanvasTransform& t, const ShapeStore& store, u32 slot, const glm::vec2& p, float extra)
+{
+    return is_rectangle_hit(t, store.instances.bounds[slot], p, extra) && WorldHitTest{ t, p, extra }.is_instance_hit(store, slot);
+}
+
+CanvasTransform get_instance_transform(const CanvasTransform& t, const InstanceArray& instances, u32 slot)
+{
+    auto local = t;
+    local.scroll = t.from_world_to_screen(instances.offsets[slot]);
+    local.scale = t.scale * instances.scales[slot];
+    return local;
+}
+
+bool is_hit(const CanvasTransform& t, const ShapeStore& store, const ShapeRef& ref, const glm::vec2& p, float extra)
+{
+    switch (ref.kind)
+    {
+    case ShapeKind::rectangle:
+        return is_rectangle_hit(t, store.rectangles.rects[ref.slot], p, extra);
+    case ShapeKind::path:
+        return is_path_hit(t, store.paths, ref.slot, p, extra);
+    case ShapeKind::instance:
+        return is_instance_hit(t, store, ref.slot, p, extra);
+    case ShapeKind::none:
+    default:
+        assert(false);
+        return false;
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <limits>
+#include <optional>
+
+#include "glm/vec2.hpp"
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/rgba.h"
+#include "vecy/canvas_transform.h"
+#include "vecy/shape_store.h"
+#include "vecy/spatial_index.h"
+#include "vecy/id_set.h"
+#include "vecy/document_file.h"
+
+// a world area that was touched by an edit
+struct DocumentChange
+{
+    u64 version;
+    Rect area;
+};
+
+// A screen point and a tolerance in pixels moved to world space once, so shapes are tested
+// against their world bounds instead of each being projected to the screen.
+// Rounding differs between the spaces, so the few tests that land within a rounding error
+// of an edge are redone in screen space to always give the same result as is_rectangle_hit.
+struct WorldHitTest
+{
+    WorldHitTest(const CanvasTransform& t, const glm::vec2& p, float extra);
+
+    [[nodiscard]] bool is_rectangle_hit(const Rect& rect) const;
+
+    // the answer of the world space test alone, nothing if the point is within a rounding error of an edge
+    [[nodiscard]] std::optional<bool> get_world_rectangle_hit(const Rect& rect) const;
+
+    // tests the flattened path for the zoom, the caller has checked the bounds
+    [[nodiscard]] bool is_path_hit(const PathArray& paths, u32 slot) const;
+
+    // tests the shapes of the symbol, the caller has checked the bounds
+    [[nodiscard]] bool is_instance_hit(const ShapeStore& store, u32 slot) const;
+
+    CanvasTransform transform;
+    glm::vec2 screen_point;
+    float extra;
+
+    glm::vec2 world_point;
+    float world_extra;
+
+    // every shape that can be hit intersects this
+    Rect query;
+
+    // how large the values in the screen space test are, in world units
+    float magnitude;
+};
+
+// The shapes and the spatial index, kept in sync.
+// A loaded document keeps its shapes in the mapped file and only copies a shape
+// to the editable shapes when it is edited, the copy hides the one in the file.
+struct Document
+{
+    IdGenerator ids;
+    ShapeStore shapes;
+    SpatialIndex index;
+
+    // the loaded file, shapes in it that have been edited or removed are hidden
+    std::shared_ptr<const DocumentFile> base;
+
+    // changed on every edit so cached renderings know when to redraw
+    u64 version = 0;
+
+    // the areas edited so far, oldest first, so caches can redraw only what changed.
+    // the log is dropped when it grows too big, a cache that has seen an older version
+    // than changes_start_version must assume everything changed
+    std::vector<DocumentChange> changes;
+    u64 changes_start_version = 0;
+
+    Id add_rectangle(const Rgba& color, const Rect& rect);
+    Id add_path(PathGeometry geometry, const std::optional<Fill>& fill, const std::optional<Outline>& outline);
+    Id add_instance(u32 symbol, const glm::vec2& offset, float scale = 1.0f, const std::optional<Rgba>& color = std::nullopt);
+    void remove(Id id);
+
+    // add the shapes in order with new ids, written back to the shapes,
+    // the index is built for all of them at once instead of per shape
+    void add_rectangles(std::vector<RectangleShape>* new_shapes);
+    void add_paths(std::vector<PathShape>* new_shapes);
+    void add_instances(std::vector<InstanceShape>* new_shapes);
+
+    // add shapes back with the ids they had, when undoing a remove
+    void restore_rectangles(const std::vector<RectangleShape>& old_shapes);
+    void restore_paths(const std::vector<PathShape>& old_shapes);
+    void restore_instances(const std::vector<InstanceShape>& old_shapes);
+
+    // remove or update many shapes as one edit
+    void remove(const std::vector<Id>& removed);
+
+    // start over with the shapes of a file
+    void set_base(std::shared_ptr<const DocumentFile> file);
+
+    // copy a shape from the file to the editable shapes, call before editing it.
+    // returns false if the shape doesn't exist
+    bool materialize(Id id);
+
+    // the shape index in the file, if the shape is there and hasn't been edited or removed
+    [[nodiscard]] std::optional<u32> find_base(Id id) const;
+    [[nodiscard]] bool is_base_hidden(u32 index) const
+    {
+        return base_hidden.empty() == false && base_hidden[index];
+    }
+
+    [[nodiscard]] std::optional<Rect> get_bounds(Id id) const;
+    [[nodiscard]] std::size_t size() const;
+
+    // call after a shape has been edited so the spatial index is kept in sync
+    void on_changed(Id id);
+    void on_changed(const std::vector<Id>& changed);
+
+    // the queries fill a set or buffer owned by the caller, reusing it for every mouse
+    // move means they stop allocating once it has grown
+
+    // replaces hits with all shapes within extra pixels of the screen point
+    void get_hit(const CanvasTransform& t, const glm::vec2& p, float extra, IdSet* hits) const;
+
+    // replaces hits with the shapes within extra pixels of the screen point, topmost first.
+    // the index isn't ordered so every shape near the point is tested, but only the
+    // max_hits topmost are kept and sorted
+    void get_hits(const CanvasTransform& t, const glm::vec2& p, float extra, std::vector<Id>* hits, std::size_t max_hits = std::numeric_limits<std::size_t>::max()) const;
+
+    // the shape a click picks
+    std::optional<Id> get_topmost_hit(const CanvasTransform& t, const glm::vec2& p, float extra) const;
+
+    // calls on_change(const Rect&) for each area edited after the version, returns false
+    // if the log doesn't go back that far and everything should be assumed to have changed
+    template<typename F>
+    bool get_changes_since(u64 seen_version, F&& on_change) const
+    {
+        if (seen_version < changes_start_version)
+        {
+            return false;
+        }
+        for (auto it = changes.rbegin(); it != changes.rend() && it->version > seen_version; ++it)
+        {
+            on_change(it->area);
+        }
+        return true;
+    }
+
+    // replaces selection with the shapes in the rect
+    // enclosed: only shapes fully inside the rect, otherwise all shapes that intersect it
+    void get_selection(const CanvasTransform& t, const Rect& screen_rect, bool enclosed, IdSet* selection) const;
+
+private:
+    // calls on_hit(Id) for each shape the hit test hits
+    template<typename F>
+    void for_each_hit(const WorldHitTest& hit, F&& on_hit) const;
+
+    void add_change(const Rect& area);
+    void hide_base(u32 index);
+
+    // allocated on the first edit of a shape in the file
+    std::vector<bool> base_hidden;
+    std::size_t base_hidden_count = 0;
+};
+
+// the shapes a new document starts with
+void add_example_shapes(Document* document);
+
+bool is_rectangle_hit(const CanvasTransform& t, const Rect& rect, const glm::vec2& p, float extra);
+bool is_path_hit(const CanvasTransform& t, const PathArray& paths, u32 slot, const glm::vec2& p, float extra);
+bool is_instance_hit(const CanvasTransform& t, const ShapeStore& store, u32 slot, const glm::vec2& p, float extra);
+
+// the transform that draws the symbol of the instance where the instance is
+[[nodiscard]] CanvasTransform get_instance_transform(const CanvasTransform& t, const InstanceArray& instances, u32 slot);
+bool is_hit(const CanvasTransform& t, const ShapeStore& store, const ShapeRef& ref, const glm::vec2& p, float extra);
@@ -0,0 +1,677 @@
+#include "vecy/document_file.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "vecy/document.h"
+
+namespace
+{
+    constexpr char document_magic[4] = { 'V', 'E', 'C', 'Y' };
+    constexpr u32 byte_order_mark = 0x01020304;
+    constexpr u32 max_leaf_size = 8;
+
+    bool is_little_endian()
+    {
+        const u32 value = 1;
+        u8 first = 0;
+        std::memcpy(&first, &value, 1);
+        return first == 1;
+    }
+
+    std::size_t align16(std::size_t offset)
+    {
+        return (offset + 15) & ~static_cast<std::size_t>(15);
+    }
+
+    // the section is inside the file and aligned for its records
+    bool is_section_valid(u64 offset, u64 count, std::size_t record_size, std::size_t file_size)
+    {
+        if (offset % 16 != 0 || offset > file_size)
+        {
+            return false;
+        }
+        return count <= (file_size - offset) / record_size;
+    }
+
+    struct IndexBuilder
+    {
+        const std::vector<ShapeRecord>* shapes;
+        std::vector<u32> order;
+        std::vector<IndexNode> nodes;
+
+        float get_center(u32 shape, int axis) const
+        {
+            const auto& s = (*shapes)[shape];
+            return axis == 0 ? s.x + s.width * 0.5f : s.y + s.height * 0.5f;
+        }
+
+        // top down, split on the median of the longest axis so the tree is balanced
+        void build(u32 first, u32 count)
+        {
+            const auto node_index = static_cast<u32>(nodes.size());
+            nodes.push_back({});
+
+            auto node = IndexNode{ 0, 0, 0, 0, first, count };
+            for (u32 i = first; i < first + count; i += 1)
+            {
+                const auto& s = (*shapes)[order[i]];
+                if (i == first)
+                {
+                    node.min_x = s.x;
+                    node.min_y = s.y;
+                    node.max_x = s.x + s.width;
+                    node.max_y = s.y + s.height;
+                }
+                node.min_x = std::min(node.min_x, s.x);
+                node.min_y = std::min(node.min_y, s.y);
+                node.max_x = std::max(node.max_x, s.x + s.width);
+                node.max_y = std::max(node.max_y, s.y + s.height);
+            }
+
+            if (count > max_leaf_size)
+            {
+                const int axis = node.max_x - node.min_x >= node.max_y - node.min_y ? 0 : 1;
+                const u32 half = count / 2;
+                std::nth_element
+                (
+                    order.begin() + first, order.begin() + first + half, order.begin() + first + count,
+                    [&](u32 lhs, u32 rhs) { return get_center(lhs, axis) < get_center(rhs, axis); }
+                );
+
+                build(first, half);
+                node.first = static_cast<u32>(nodes.size());
+                node.count = 0;
+                build(first + half, count - half);
+            }
+
+            nodes[node_index] = node;
+        }
+    };
+
+    // how many points the verbs use, or nothing if a verb is broken
+    std::optional<u32> get_point_count(const u8* verbs, u32 count)
+    {
+        u32 points = 0;
+        for (u32 i = 0; i < count; i += 1)
+        {
+            switch (static_cast<PathVerb>(verbs[i]))
+            {
+            case PathVerb::move: case PathVerb::line: points += 1; break;
+            case PathVerb::quad: points += 2; break;
+            case PathVerb::cubic: points += 3; break;
+            case PathVerb::close: break;
+            default: return std::nullopt;
+            }
+        }
+        return points;
+    }
+
+    void write_color(u8* dst, const Rgba& c)
+    {
+        dst[0] = c.r;
+        dst[1] = c.g;
+        dst[2] = c.b;
+        dst[3] = c.a;
+    }
+
+    Rgba read_color(const u8* src)
+    {
+        return Rgba{ (static_cast<u32>(src[0]) << 16) | (static_cast<u32>(src[1]) << 8) | src[2], src[3] };
+    }
+
+    template<typename T>
+    bool write_section(std::FILE* file, const std::vector<T>& items, std::size_t* offset)
+    {
+        // pad up to the section start
+        const auto start = align16(*offset);
+        const u8 zeros[16] = {};
+        if (start != *offset && std::fwrite(zeros, 1, start - *offset, file) != start - *offset)
+        {
+            return false;
+        }
+        *offset = start + items.size() * sizeof(T);
+        return items.empty() || std::fwrite(items.data(), sizeof(T), items.size(), file) == items.size();
+    }
+}
+
+bool DocumentFile::open(const std::string& path)
+{
+    header = nullptr;
+    if (is_little_endian() == false || file.open(path) == false)
+    {
+        return false;
+    }
+
+    const auto* data = file.get_data();
+    const auto size = file.get_size();
+    if (size < document_file_header_size_v1)
+    {
+        file.close();
+        return false;
+    }
+
+    // only the fields of the version are read from an older header
+    const auto* h = reinterpret_cast<const DocumentFileHeader*>(data);
+    const bool is_v1 = h->version == 1 && h->header_size == document_file_header_size_v1;
+    const bool is_v2 = h->version == 2 && h->header_size == document_file_header_size_v2;
+    const bool is_current = h->version == document_file_version && h->header_size == sizeof(DocumentFileHeader);
+    const bool is_header_valid
+        =  std::memcmp(h->magic, document_magic, 4) == 0
+        && (is_v1 || is_v2 || is_current)
+        && h->header_size <= size
+        && h->byte_order == byte_order_mark
+        && h->shape_count <= UINT32_MAX && h->style_count <= UINT32_MAX && h->node_count <= UINT32_MAX
+        && is_section_valid(h->style_offset, h->style_count, sizeof(StyleRecord), size)
+        && is_section_valid(h->shape_offset, h->shape_count, sizeof(ShapeRecord), size)
+        && is_section_valid(h->order_offset, h->shape_count, sizeof(u32), size)
+        && is_section_valid(h->node_offset, h->node_count, sizeof(IndexNode), size)
+        ;
+    const bool are_paths_valid
+        =  is_v1
+        || (  h->path_count <= UINT32_MAX && h->path_verb_count <= UINT32_MAX && h->path_point_count <= UINT32_MAX
+           && is_section_valid(h->path_offset, h->path_count, sizeof(PathRecord), size)
+           && is_section_valid(h->path_verb_offset, h->path_verb_count, sizeof(u8), size)
+           && is_section_valid(h->path_point_offset, h->path_point_count, sizeof(PathPoint), size)
+           );
+    const bool are_symbols_valid
+        =  is_v1 || is_v2
+        || (  h->symbol_count <= UINT32_MAX && h->symbol_shape_count <= UINT32_MAX && h->symbol_path_count <= UINT32_MAX && h->instance_count <= UINT32_MAX
+           && is_section_valid(h->symbol_offset, h->symbol_count, sizeof(SymbolRecord), size)
+           && is_section_valid(h->symbol_shape_offset, h->symbol_shape_count, sizeof(ShapeRecord), size)
+           && is_section_valid(h->symbol_path_offset, h->symbol_path_count, sizeof(PathRecord), size)
+           && is_section_valid(h->instance_offset, h->instance_count, sizeof(InstanceRecord), size)
+           );
+    if (is_header_valid == false || are_paths_valid == false || are_symbols_valid == false)
+    {
+        file.close();
+        return false;
+    }
+
+    header = h;
+    styles = reinterpret_cast<const StyleRecord*>(data + h->style_offset);
+    shapes = reinterpret_cast<const ShapeRecord*>(data + h->shape_offset);
+    order = reinterpret_cast<const u32*>(data + h->order_offset);
+    nodes = reinterpret_cast<const IndexNode*>(data + h->node_offset);
+    style_count = static_cast<u32>(h->style_count);
+    shape_count = static_cast<u32>(h->shape_count);
+    node_count = static_cast<u32>(h->node_count);
+
+    paths = nullptr;
+    path_verbs = nullptr;
+    path_points = nullptr;
+    path_count = 0;
+    path_verb_count = 0;
+    path_point_count = 0;
+    if (is_v1 == false)
+    {
+        paths = reinterpret_cast<const PathRecord*>(data + h->path_offset);
+        path_verbs = data + h->path_verb_offset;
+        path_points = reinterpret_cast<const PathPoint*>(data + h->path_point_offset);
+        path_count = static_cast<u32>(h->path_count);
+        path_verb_count = static_cast<u32>(h->path_verb_count);
+        path_point_count = static_cast<u32>(h->path_point_count);
+    }
+
+    symbols = nullptr;
+    symbol_shapes = nullptr;
+    symbol_paths = nullptr;
+    instances = nullptr;
+    symbol_count = 0;
+    symbol_shape_count = 0;
+    symbol_path_count = 0;
+    instance_count = 0;
+    if (is_current)
+    {
+        symbols = reinterpret_cast<const SymbolRecord*>(data + h->symbol_offset);
+        symbol_shapes = reinterpret_cast<const ShapeRecord*>(data + h->symbol_shape_offset);
+        symbol_paths = reinterpret_cast<const PathRecord*>(data + h->symbol_path_offset);
+        instances = reinterpret_cast<const InstanceRecord*>(data + h->instance_offset);
+        symbol_count = static_cast<u32>(h->symbol_count);
+        symbol_shape_count = static_cast<u32>(h->symbol_shape_count);
+        symbol_path_count = static_cast<u32>(h->symbol_path_count);
+        instance_count = static_cast<u32>(h->instance_count);
+    }
+    return true;
+}
+
+Rgba DocumentFile::get_color(u32 index) const
+{
+    return read_style(shapes[index].style);
+}
+
+Rgba DocumentFile::read_style(u32 style) const
+{
+    if (style >= style_count)
+    {
+        return Rgba{ 0, 0 };
+    }
+    const auto& s = styles[style];
+    return Rgba{ (static_cast<u32>(s.r) << 16) | (static_cast<u32>(s.g) << 8) | s.b, s.a };
+}
+
+Rect DocumentFile::get_bounds() const
+{
+    const auto* b = header->bounds;
+    return { {b[0], b[1]}, {b[2] - b[0], b[3] - b[1]} };
+}
+
+PathShape DocumentFile::get_path(u32 index) const
+{
+    return read_path(paths[index]);
+}
+
+Symbol DocumentFile::get_symbol(u32 index) const
+{
+    const auto& s = symbols[index];
+    Symbol symbol;
+    const bool shapes_fit = s.first_shape <= symbol_shape_count && s.shape_count <= symbol_shape_count - s.first_shape;
+    const bool paths_fit = s.first_path <= symbol_path_count && s.path_count <= symbol_path_count - s.first_path;
+    const u32 shape_end = shapes_fit ? s.first_shape + s.shape_count : s.first_shape;
+    const u32 path_end = paths_fit ? s.first_path + s.path_count : s.first_path;
+
+    // the rectangles and paths are interleaved on id, the symbol gives them new ids in the same order
+    u32 next_shape = s.first_shape;
+    u32 next_path = s.first_path;
+    while (next_shape < shape_end || next_path < path_end)
+    {
+        const bool is_path = next_shape == shape_end || (next_path < path_end && symbol_paths[next_path].id < symbol_shapes[next_shape].id);
+        if (is_path)
+        {
+            auto path = read_path(symbol_paths[next_path]);
+            if (path.geometry.empty() == false)
+            {
+                symbol.add_path(std::move(path.geometry), path.fill, path.outline);
+            }
+            next_path += 1;
+        }
+        else
+        {
+            const auto& r = symbol_shapes[next_shape];
+            if (r.kind == static_cast<u8>(ShapeKind::rectangle))
+            {
+                symbol.add_rectangle(read_style(r.style), Rect{ {r.x, r.y}, {r.width, r.height} });
+            }
+            next_shape += 1;
+        }
+    }
+    return symbol;
+}
+
+std::optional<InstanceShape> DocumentFile::get_instance(u32 index) const
+{
+    const auto& i = instances[index];
+    if (i.symbol >= symbol_count || (i.scale > 0.0f && std::isfinite(i.scale)) == false)
+    {
+        return std::nullopt;
+    }
+
+    auto shape = InstanceShape{ Id{ i.id }, i.symbol, { i.x, i.y }, i.scale, std::nullopt };
+    if (i.flags & instance_recolored)
+    {
+        shape.color = read_color(i.color);
+    }
+    return shape;
+}
+
+PathShape DocumentFile::read_path(const PathRecord& p) const
+{
+    PathShape shape{ Id{ p.id }, {}, std::nullopt, std::nullopt };
+
+    // a broken path is empty
+    const bool fits
+        =  p.first_verb <= path_verb_count && p.verb_count <= path_verb_count - p.first_verb
+        && p.first_point <= path_point_count && p.point_count <= path_point_count - p.first_point
+        ;
+    if (fits == false || get_point_count(path_verbs + p.first_verb, p.verb_count) != p.point_count)
+    {
+        return shape;
+    }
+
+    auto& geometry = shape.geometry;
+    geometry.verbs.reserve(p.verb_count);
+    for (u32 i = 0; i < p.verb_count; i += 1)
+    {
+        geometry.verbs.push_back(static_cast<PathVerb>(path_verbs[p.first_verb + i]));
+    }
+    geometry.points.reserve(p.point_count);
+    for (u32 i = 0; i < p.point_count; i += 1)
+    {
+        const auto& point = path_points[p.first_point + i];
+        geometry.points.push_back({ point.x, point.y });
+    }
+
+    // styles this version doesn't know are drawn solid
+    if (p.flags & path_filled)
+    {
+        const auto style = p.fill_style <= static_cast<u8>(FillStyle::vertical_hatch) ? static_cast<FillStyle>(p.fill_style) : FillStyle::solid;
+        shape.fill = Fill{ read_color(p.fill), style };
+    }
+    if (p.flags & path_outlined)
+    {
+        const auto style = p.outline_style <= static_cast<u8>(LineStyle::dot_dash) ? static_cast<LineStyle>(p.outline_style) : LineStyle::solid;
+        shape.outline = Outline{ read_color(p.outline), static_cast<int>(std::min(p.outline_width, u32{0xFFFF})), style };
+    }
+    return shape;
+}
+
+std::optional<u32> DocumentFile::find(Id id) const
+{
+    const auto* end = shapes + shape_count;
+    const auto* found = std::lower_bound(shapes, end, id.id, [](const ShapeRecord& s, u64 value) { return s.id < value; });
+    if (found == end || found->id != id.id)
+    {
+        return std::nullopt;
+    }
+    return static_cast<u32>(found - shapes);
+}
+
+bool save_document(const Document& document, const std::string& path)
+{
+    if (is_little_endian() == false)
+    {
+        return false;
+    }
+
+    std::vector<ShapeRecord> shapes;
+    shapes.reserve(document.size());
+
+    // the styles are found by sorting the keys of all shapes, a hash map from key to style
+    // would be a heap allocation per style and most shapes have a color of their own
+    std::vector<u64> shape_styles;
+    shape_styles.reserve(document.size());
+
+    const auto get_style_key = [](const Rgba& color)
+    {
+        // the shapes are only solid colored for now, the fill style is there for later
+        const auto fill_style = static_cast<u64>(FillStyle::solid);
+        return (fill_style << 32) | (static_cast<u64>(color.r) << 24) | (static_cast<u64>(color.g) << 16) | (static_cast<u64>(color.b) << 8) | color.a;
+    };
+    const auto add = [&](Id id, ShapeKind kind, const Rect& rect, const Rgba& color)
+    {
+        shape_styles.push_back(get_style_key(color));
+        shapes.push_back(ShapeRecord{ id.id, rect.topleft.x, rect.topleft.y, rect.size.x, rect.size.y, 0, static_cast<u8>(kind), {} });
+    };
+
+    if (document.base != nullptr)
+    {
+        const auto& base = *document.base;
+        for (u32 i = 0; i < base.size(); i += 1)
+        {
+            if (document.is_base_hidden(i) == false)
+            {
+                add(base.get_id(i), base.get_kind(i), base.get_rect(i), base.get_color(i));
+            }
+        }
+    }
+    const auto& rectangles = document.shapes.rectangles;
+    for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+    {
+        add(rectangles.ids[slot], ShapeKind::rectangle, rectangles.rects[slot], rectangles.colors[slot]);
+    }
+
+    // the rectangles of the symbols share the style table
+    std::vector<ShapeRecord> symbol_shapes;
+    std::vector<u64> symbol_shape_styles;
+    for (const auto& symbol : document.shapes.symbols)
+    {
+        const auto& r = symbol.rectangles;
+        for (u32 slot = 0; slot < r.size(); slot += 1)
+        {
+            symbol_shape_styles.push_back(get_style_key(r.colors[slot]));
+            symbol_shapes.push_back(ShapeRecord{ r.ids[slot].id, r.rects[slot].topleft.x, r.rects[slot].topleft.y, r.rects[slot].size.x, r.rects[slot].size.y, 0, static_cast<u8>(ShapeKind::rectangle), {} });
+        }
+    }
+
+    auto style_keys = shape_styles;
+    style_keys.insert(style_keys.end(), symbol_shape_styles.begin(), symbol_shape_styles.end());
+    std::sort(style_keys.begin(), style_keys.end());
+    style_keys.erase(std::unique(style_keys.begin(), style_keys.end()), style_keys.end());
+    std::vector<StyleRecord> styles;
+    styles.reserve(style_keys.size());
+    for (const auto key : style_keys)
+    {
+        const auto byte = [key](int shift) { return static_cast<u8>((key >> shift) & 0xff); };
+        styles.push_back(StyleRecord{ byte(24), byte(16), byte(8), byte(0), byte(32), {} });
+    }
+    const auto get_style = [&](u64 key)
+    {
+        return static_cast<u32>(std::lower_bound(style_keys.begin(), style_keys.end(), key) - style_keys.begin());
+    };
+    for (std::size_t i = 0; i < shapes.size(); i += 1)
+    {
+        shapes[i].style = get_style(shape_styles[i]);
+    }
+    for (std::size_t i = 0; i < symbol_shapes.size(); i += 1)
+    {
+        symbol_shapes[i].style = get_style(symbol_shape_styles[i]);
+    }
+    std::sort(shapes.begin(), shapes.end(), [](const ShapeRecord& lhs, const ShapeRecord& rhs) { return lhs.id < rhs.id; });
+
+    // the paths are written as they are, they are few compared to rectangles and read into memory when loaded
+    std::vector<PathRecord> path_records;
+    std::vector<u8> path_verbs;
+    std::vector<PathPoint> path_points;
+    const auto add_path = [&](std::vector<PathRecord>* records, const PathArray& paths, u32 slot)
+    {
+        const auto& geometry = paths.geometries[slot];
+        auto record = PathRecord{};
+        record.id = paths.ids[slot].id;
+        record.first_verb = static_cast<u32>(path_verbs.size());
+        record.verb_count = static_cast<u32>(geometry.verbs.size());
+        record.first_point = static_cast<u32>(path_points.size());
+        record.point_count = static_cast<u32>(geometry.points.size());
+        if (const auto& fill = paths.fills[slot])
+        {
+            record.flags |= path_filled;
+            write_color(record.fill, fill->color);
+            record.fill_style = static_cast<u8>(fill->style);
+        }
+        if (const auto& outline = paths.outlines[slot])
+        {
+            record.flags |= path_outlined;
+            write_color(record.outline, outline->color);
+            record.outline_width = static_cast<u32>(std::max(0, outline->width));
+            record.outline_style = static_cast<u8>(outline->style);
+        }
+        records->push_back(record);
+
+        for (const auto verb : geometry.verbs)
+        {
+            path_verbs.push_back(static_cast<u8>(verb));
+        }
+        for (const auto& p : geometry.points)
+        {
+            path_points.push_back({ p.x, p.y });
+        }
+    };
+    const auto& paths = document.shapes.paths;
+    path_records.reserve(paths.size());
+    for (u32 slot = 0; slot < paths.size(); slot += 1)
+    {
+        add_path(&path_records, paths, slot);
+    }
+    std::sort(path_records.begin(), path_records.end(), [](const PathRecord& lhs, const PathRecord& rhs) { return lhs.id < rhs.id; });
+
+    // the symbols are written once however many instances there are
+    std::vector<SymbolRecord> symbols;
+    std::vector<PathRecord> symbol_paths;
+    u32 next_symbol_shape = 0;
+    for (const auto& symbol : document.shapes.symbols)
+    {
+        const auto first_path = static_cast<u32>(symbol_paths.size());
+        for (u32 slot = 0; slot < symbol.paths.size(); slot += 1)
+        {
+            add_path(&symbol_paths, symbol.paths, slot);
+        }
+        const auto shape_count = static_cast<u32>(symbol.rectangles.size());
+        symbols.push_back({ next_symbol_shape, shape_count, first_path, static_cast<u32>(symbol.paths.size()) });
+        next_symbol_shape += shape_count;
+    }
+
+    std::vector<InstanceRecord> instances;
+    const auto& document_instances = document.shapes.instances;
+    instances.reserve(document_instances.size());
+    for (u32 slot = 0; slot < document_instances.size(); slot += 1)
+    {
+        auto record = InstanceRecord{};
+        record.id = document_instances.ids[slot].id;
+        record.symbol = document_instances.symbols[slot];
+        record.x = document_instances.offsets[slot].x;
+        record.y = document_instances.offsets[slot].y;
+        record.scale = document_instances.scales[slot];
+        if (const auto& color = document_instances.colors[slot])
+        {
+            record.flags |= instance_recolored;
+            write_color(record.color, *color);
+        }
+        instances.push_back(record);
+    }
+    std::sort(instances.begin(), instances.end(), [](const InstanceRecord& lhs, const InstanceRecord& rhs) { return lhs.id < rhs.id; });
+
+    IndexBuilder builder;
+    builder.shapes = &shapes;
+    builder.order.resize(shapes.size());
+    for (u32 i = 0; i < shapes.size(); i += 1)
+    {
+        builder.order[i] = i;
+    }
+    if (shapes.empty() == false)
+    {
+        builder.build(0, static_cast<u32>(shapes.size()));
+    }
+
+    DocumentFileHeader header = {};
+    std::memcpy(header.magic, document_magic, 4);
+    header.version = document_file_version;
+    header.header_size = sizeof(DocumentFileHeader);
+    header.byte_order = byte_order_mark;
+    header.next_id = document.ids.next;
+
+    std::size_t offset = align16(sizeof(DocumentFileHeader));
+    header.style_offset = offset;
+    header.style_count = styles.size();
+    offset = align16(offset + styles.size() * sizeof(StyleRecord));
+    header.shape_offset = offset;
+    header.shape_count = shapes.size();
+    offset = align16(offset + shapes.size() * sizeof(ShapeRecord));
+    header.order_offset = offset;
+    offset = align16(offset + builder.order.size() * sizeof(u32));
+    header.node_offset = offset;
+    header.node_count = builder.nodes.size();
+    offset = align16(offset + builder.nodes.size() * sizeof(IndexNode));
+    header.path_offset = offset;
+    header.path_count = path_records.size();
+    offset = align16(offset + path_records.size() * sizeof(PathRecord));
+    header.path_verb_offset = offset;
+    header.path_verb_count = path_verbs.size();
+    offset = align16(offset + path_verbs.size() * sizeof(u8));
+    header.path_point_offset = offset;
+    header.path_point_count = path_points.size();
+    offset = align16(offset + path_points.size() * sizeof(PathPoint));
+    header.symbol_offset = offset;
+    header.symbol_count = symbols.size();
+    offset = align16(offset + symbols.size() * sizeof(SymbolRecord));
+    header.symbol_shape_offset = offset;
+    header.symbol_shape_count = symbol_shapes.size();
+    offset = align16(offset + symbol_shapes.size() * sizeof(ShapeRecord));
+    header.symbol_path_offset = offset;
+    header.symbol_path_count = symbol_paths.size();
+    offset = align16(offset + symbol_paths.size() * sizeof(PathRecord));
+    header.instance_offset = offset;
+    header.instance_count = instances.size();
+    if (builder.nodes.empty() == false)
+    {
+        const auto& root = builder.nodes[0];
+        header.bounds[0] = root.min_x;
+        header.bounds[1] = root.min_y;
+        header.bounds[2] = root.max_x;
+        header.bounds[3] = root.max_y;
+    }
+
+    // written next to the target and moved over it, the target may be the mapped file of the document
+    const auto temp_path = path + ".tmp";
+    std::FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    std::size_t written = sizeof(DocumentFileHeader);
+    const bool ok
+        =  std::fwrite(&header, sizeof(DocumentFileHeader), 1, file) == 1
+        && write_section(file, styles, &written)
+        && write_section(file, shapes, &written)
+        && write_section(file, builder.order, &written)
+        && write_section(file, builder.nodes, &written)
+        && write_section(file, path_records, &written)
+        && write_section(file, path_verbs, &written)
+        && write_section(file, path_points, &written)
+        && write_section(file, symbols, &written)
+        && write_section(file, symbol_shapes, &written)
+        && write_section(file, symbol_paths, &written)
+        && write_section(file, instances, &written)
+        ;
+    const bool closed = std::fclose(file) == 0;
+    if (ok == false || closed == false)
+    {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+
+#if defined(_WIN32)
+    // rename doesn't replace on windows
+    std::remove(path.c_str());
+#endif
+    return std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+bool load_document(Document* document, const std::string& path)
+{
+    auto file = std::make_shared<DocumentFile>();
+    if (file->open(path) == false)
+    {
+        return false;
+    }
+
+    // the paths and instances are edited in memory, only the rectangles are used from the file
+    std::vector<PathShape> paths;
+    paths.reserve(file->get_path_count());
+    for (u32 i = 0; i < file->get_path_count(); i += 1)
+    {
+        auto path = file->get_path(i);
+        if (path.geometry.empty() == false)
+        {
+            paths.push_back(std::move(path));
+        }
+    }
+
+    // the symbols keep their index so the instances refer to the same ones
+    std::vector<Symbol> symbols;
+    symbols.reserve(file->get_symbol_count());
+    for (u32 i = 0; i < file->get_symbol_count(); i += 1)
+    {
+        symbols.push_back(file->get_symbol(i));
+    }
+    std::vector<InstanceShape> instances;
+    instances.reserve(file->get_instance_count());
+    for (u32 i = 0; i < file->get_instance_count(); i += 1)
+    {
+        if (const auto instance = file->get_instance(i))
+        {
+            instances.push_back(*instance);
+        }
+    }
+
+    document->set_base(std::move(file));
+    for (auto& symbol : symbols)
+    {
+        document->shapes.add_symbol(std::move(symbol));
+    }
+    document->restore_paths(paths);
+    document->restore_instances(instances);
+    return true;
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <optional>
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/rgba.h"
+#include "vecy/style.h"
+#include "vecy/shape_store.h"
+#include "vecy/mapped_file.h"
+
+// The binary document format. Everything is little-endian and every section starts on a
+// 16 byte boundary so the records can be used straight from the mapped file:
+//   header
+//   style table: style_count StyleRecord
+//   shapes: shape_count ShapeRecord, sorted on id
+//   index order: shape_count u32 shape indices, in the order the index leaves refer to them
+//   index: node_count IndexNode, a bounding volume hierarchy in depth first order
+//   paths: path_count PathRecord, sorted on id
+//   path verbs: path_verb_count u8 PathVerb
+//   path points: path_point_count PathPoint
+//   symbols: symbol_count SymbolRecord
+//   symbol shapes: symbol_shape_count ShapeRecord, the rectangles of the symbols in symbol space
+//   symbol paths: symbol_path_count PathRecord, using the same verbs and points as the paths
+//   instances: instance_count InstanceRecord, sorted on id
+// The shapes and the index are rectangles only, paths and instances are read into the editable shapes when loaded.
+// The ids of the symbol shapes are the order within the symbol.
+// Version 1 files have no paths and end the header before the path sections,
+// version 2 files have no symbols and end the header before the symbol sections.
+constexpr u32 document_file_version = 3;
+
+struct DocumentFileHeader
+{
+    char magic[4];
+    u32 version;
+    u32 header_size;
+
+    // written as 0x01020304, a file from a big-endian machine reads differently
+    u32 byte_order;
+
+    u64 next_id;
+
+    u64 style_offset;
+    u64 style_count;
+    u64 shape_offset;
+    u64 shape_count;
+    u64 order_offset;
+    u64 node_offset;
+    u64 node_count;
+
+    // the bounds of all shapes
+    float bounds[4];
+
+    // added in version 2, use DocumentFile::get_path_count since a version 1 header ends before these
+    u64 path_offset;
+    u64 path_count;
+    u64 path_verb_offset;
+    u64 path_verb_count;
+    u64 path_point_offset;
+    u64 path_point_count;
+
+    // added in version 3, use DocumentFile::get_symbol_count and get_instance_count
+    u64 symbol_offset;
+    u64 symbol_count;
+    u64 symbol_shape_offset;
+    u64 symbol_shape_count;
+    u64 symbol_path_offset;
+    u64 symbol_path_count;
+    u64 instance_offset;
+    u64 instance_count;
+};
+
+constexpr u32 document_file_header_size_v1 = 96;
+constexpr u32 document_file_header_size_v2 = 144;
+
+struct StyleRecord
+{
+    u8 r;
+    u8 g;
+    u8 b;
+    u8 a;
+    u8 fill_style;
+    u8 reserved[3];
+};
+
+struct ShapeRecord
+{
+    u64 id;
+    float x;
+    float y;
+    float width;
+    float height;
+    u32 style;
+    u8 kind;
+    u8 reserved[3];
+};
+
+enum PathRecordFlags : u8
+{
+    path_filled = 1,
+    path_outlined = 2
+};
+
+// the fill and outline are only used when the flags have them, the outline width is in world units
+struct PathRecord
+{
+    u64 id;
+    u32 first_verb;
+    u32 verb_count;
+    u32 first_point;
+    u32 point_count;
+    u8 fill[4];
+    u8 outline[4];
+    u32 outline_width;
+    u8 fill_style;
+    u8 outline_style;
+    u8 flags;
+    u8 reserved;
+};
+
+struct PathPoint
+{
+    float x;
+    float y;
+};
+
+// the shapes of a symbol are ranges in the symbol shapes and symbol paths
+struct SymbolRecord
+{
+    u32 first_shape;
+    u32 shape_count;
+    u32 first_path;
+    u32 path_count;
+};
+
+enum InstanceRecordFlags : u8
+{
+    instance_recolored = 1
+};
+
+// the color is only used when the flags have it
+struct InstanceRecord
+{
+    u64 id;
+    u32 symbol;
+    float x;
+    float y;
+    float scale;
+    u8 color[4];
+    u8 flags;
+    u8 reserved[3];
+};
+
+// count 0 is an inner node, the left child is the next node and first is the right child.
+// otherwise a leaf with count shapes starting at first in the index order
+struct IndexNode
+{
+    float min_x;
+    float min_y;
+    float max_x;
+    float max_y;
+    u32 first;
+    u32 count;
+};
+
+static_assert(sizeof(DocumentFileHeader) == 208, "the header is part of the file format");
+static_assert(sizeof(StyleRecord) == 8, "style records are part of the file format");
+static_assert(sizeof(ShapeRecord) == 32, "shape records are part of the file format");
+static_assert(sizeof(IndexNode) == 24, "index nodes are part of the file format");
+static_assert(sizeof(PathRecord) == 40, "path records are part of the file format");
+static_assert(sizeof(PathPoint) == 8, "path points are part of the file format");
+static_assert(sizeof(SymbolRecord) == 16, "symbol records are part of the file format");
+static_assert(sizeof(InstanceRecord) == 32, "instance records are part of the file format");
+
+// A saved document used straight from the mapped file. Opening only checks the header
+// and that the sections fit in the file, no shape is read until it is asked for.
+struct DocumentFile
+{
+    // returns false if the file is missing or isn't a document this version can read
+    bool open(const std::string& path);
+
+    [[nodiscard]] const DocumentFileHeader& get_header() const
+    {
+        return *header;
+    }
+
+    [[nodiscard]] u32 size() const
+    {
+        return shape_count;
+    }
+
+    [[nodiscard]] Id get_id(u32 index) const
+    {
+        return { shapes[index].id };
+    }
+
+    [[nodiscard]] ShapeKind get_kind(u32 index) const
+    {
+        return shapes[index].kind == static_cast<u8>(ShapeKind::rectangle) ? ShapeKind::rectangle : ShapeKind::none;
+    }
+
+    [[nodiscard]] Rect get_rect(u32 index) const
+    {
+        const auto& s = shapes[index];
+        return { {s.x, s.y}, {s.width, s.height} };
+    }
+
+    [[nodiscard]] Rgba get_color(u32 index) const;
+
+    [[nodiscard]] Rect get_bounds() const;
+
+    [[nodiscard]] u32 get_path_count() const
+    {
+        return path_count;
+    }
+
+    // copies the path out of the file
+    [[nodiscard]] PathShape get_path(u32 index) const;
+
+    [[nodiscard]] u32 get_symbol_count() const
+    {
+        return symbol_count;
+    }
+
+    // copies the shapes of the symbol out of the file, a broken range of shapes is left out
+    [[nodiscard]] Symbol get_symbol(u32 index) const;
+
+    [[nodiscard]] u32 get_instance_count() const
+    {
+        return instance_count;
+    }
+
+    // copies the instance out of the file, nothing if it's broken
+    [[nodiscard]] std::optional<InstanceShape> get_instance(u32 index) const;
+
+    // the shape index of the id, shapes are sorted on id so this is a binary search
+    [[nodiscard]] std::optional<u32> find(Id id) const;
+
+    // calls on_hit(u32 shape_index) for each shape whose bounds overlaps the rect
+    template<typename F>
+    void query_intersecting(const Rect& r, F&& on_hit) const
+    {
+        if (node_count == 0)
+        {
+            return;
+        }
+
+        const auto bottomright = r.get_bottomright();
+        u32 stack[64];
+        int count = 0;
+        stack[count++] = 0;
+        while (count > 0)
+        {
+            const auto& node = nodes[stack[--count]];
+            if (node.max_x < r.topleft.x || node.min_x > bottomright.x || node.max_y < r.topleft.y || node.min_y > bottomright.y)
+            {
+                continue;
+            }
+
+            if (node.count == 0)
+            {
+                // the tree is built balanced so the stack can't overflow, a broken file is skipped
+                const auto index = static_cast<u32>(&node - nodes);
+                if (count + 2 > 64 || node.first >= node_count || index + 1 >= node_count) { continue; }
+                stack[count++] = node.first;
+                stack[count++] = index + 1;
+                continue;
+            }
+
+            if (node.first > shape_count || node.count > shape_count - node.first) { continue; }
+            for (u32 i = node.first; i < node.first + node.count; i += 1)
+            {
+                const auto shape = order[i];
+                if (shape < shape_count && get_rect(shape).intersects(r))
+                {
+                    on_hit(shape);
+                }
+            }
+        }
+    }
+
+private:
+    MappedFile file;
+    const DocumentFileHeader* header = nullptr;
+    const StyleRecord* styles = nullptr;
+    const ShapeRecord* shapes = nullptr;
+    const u32* order = nullptr;
+    const IndexNode* nodes = nullptr;
+    const PathRecord* paths = nullptr;
+    const u8* path_verbs = nullptr;
+    const PathPoint* path_points = nullptr;
+    const SymbolRecord* symbols = nullptr;
+    const ShapeRecord* symbol_shapes = nullptr;
+    const PathRecord* symbol_paths = nullptr;
+    const InstanceRecord* instances = nullptr;
+    u32 style_count = 0;
+    u32 shape_count = 0;
+    u32 node_count = 0;
+    u32 path_count = 0;
+    u32 path_verb_count = 0;
+    u32 path_point_count = 0;
+    u32 symbol_count = 0;
+    u32 symbol_shape_count = 0;
+    u32 symbol_path_count = 0;
+    u32 instance_count = 0;
+
+    [[nodiscard]] PathShape read_path(const PathRecord& p) const;
+    [[nodiscard]] Rgba read_style(u32 style) const;
+};
+
+struct Document;
+
+// writes all shapes, the shapes of a loaded document that haven't been edited are copied from its file
+bool save_document(const Document& document, const std::string& path);
+
+// replaces the document with the file, the rectangles stay in the mapped file until they are edited
+bool load_document(Document* document, const std::string& path);
@@ -0,0 +1,381 @@
+#include "vecy/history.h"
+
+#include <cassert>
+#include <utility>
+
+#include "vecy/document.h"
+
+namespace
+{
+    template<typename T>
+    std::size_t get_vector_bytes(const std::vector<T>& v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+
+    std::size_t get_paths_bytes(const std::vector<PathShape>& paths)
+    {
+        std::size_t bytes = get_vector_bytes(paths);
+        for (const auto& path : paths)
+        {
+            bytes += get_vector_bytes(path.geometry.verbs) + get_vector_bytes(path.geometry.points);
+        }
+        return bytes;
+    }
+
+    void set_rects(Document* document, const std::vector<Id>& ids, const std::vector<Rect>& rects)
+    {
+        auto& shapes = document->shapes;
+        for (std::size_t i = 0; i < ids.size(); i += 1)
+        {
+            const auto ref = shapes.find(ids[i]);
+            if (ref.kind == ShapeKind::none) { assert(false); continue; }
+            shapes.set_bounds(ref, rects[i]);
+        }
+        document->on_changed(ids);
+    }
+
+    void set_colors(Document* document, const std::vector<Id>& ids, const std::vector<Rgba>& colors)
+    {
+        auto& shapes = document->shapes;
+        for (std::size_t i = 0; i < ids.size(); i += 1)
+        {
+            const auto ref = shapes.find(ids[i]);
+            if (ref.kind == ShapeKind::none) { assert(false); continue; }
+            shapes.set_color(ref, colors[i]);
+        }
+        document->on_changed(ids);
+    }
+
+    // the rects and colors may be fewer than the ids, the rest are paths and instances
+    std::vector<RectangleShape> get_shapes(const std::vector<Id>& ids, const std::vector<Rect>& rects, const std::vector<Rgba>& colors)
+    {
+        std::vector<RectangleShape> ret;
+        ret.reserve(rects.size());
+        for (std::size_t i = 0; i < rects.size(); i += 1)
+        {
+            ret.push_back({ ids[i], colors[i], rects[i] });
+        }
+        return ret;
+    }
+
+    // the shapes that exist, shapes in the loaded file are copied to the editable shapes
+    // so the edit can write to them
+    std::vector<Id> materialize(Document* document, const std::vector<Id>& ids)
+    {
+        std::vector<Id> ret;
+        ret.reserve(ids.size());
+        for (const auto id : ids)
+        {
+            if (document->materialize(id))
+            {
+                ret.push_back(id);
+            }
+        }
+        return ret;
+    }
+
+    // copies the shapes that exist, the rectangles first and then the paths and instances like a command keeps them.
+    // shapes in the loaded file come back as editable shapes when restored.
+    // returns the ids in that order
+    std::vector<Id> copy_shapes(const Document& document, const std::vector<Id>& ids, std::vector<Rect>* rects, std::vector<Rgba>* colors, std::vector<PathShape>* paths, std::vector<InstanceShape>* instances)
+    {
+        std::vector<Id> ret;
+        ret.reserve(ids.size());
+        rects->reserve(ids.size());
+        colors->reserve(ids.size());
+        for (const auto id : ids)
+        {
+            const auto ref = document.shapes.find(id);
+            if (ref.kind == ShapeKind::path)
+            {
+                paths->push_back(document.shapes.paths.get(ref.slot));
+            }
+            else if (ref.kind == ShapeKind::instance)
+            {
+                instances->push_back(document.shapes.instances.get(ref.slot));
+            }
+            else if (ref.kind == ShapeKind::rectangle)
+            {
+                ret.push_back(id);
+                rects->push_back(document.shapes.rectangles.rects[ref.slot]);
+                colors->push_back(document.shapes.rectangles.colors[ref.slot]);
+            }
+            else if (const auto found = document.find_base(id))
+            {
+                ret.push_back(id);
+                rects->push_back(document.base->get_rect(*found));
+                colors->push_back(document.base->get_color(*found));
+            }
+        }
+        for (const auto& path : *paths)
+        {
+            ret.push_back(path.id);
+        }
+        for (const auto& instance : *instances)
+        {
+            ret.push_back(instance.id);
+        }
+        return ret;
+    }
+
+    template<typename T>
+    void free_vector(std::vector<T>* v)
+    {
+        std::vector<T>{}.swap(*v);
+    }
+}
+
+std::size_t Command::get_memory_usage() const
+{
+    return sizeof(Command)
+        + get_vector_bytes(ids)
+        + get_vector_bytes(rects_before)
+        + get_vector_bytes(rects_after)
+        + get_vector_bytes(colors_before)
+        + get_vector_bytes(colors_after)
+        + get_paths_bytes(paths)
+        + get_vector_bytes(instances)
+        ;
+}
+
+void History::add(Document* document, std::vector<RectangleShape>* shapes)
+{
+    if (shapes->empty())
+    {
+        return;
+    }
+
+    document->add_rectangles(shapes);
+
+    // the shapes are in the document until the add is undone
+    Command command;
+    command.kind = CommandKind::add;
+    command.ids.reserve(shapes->size());
+    for (const auto& shape : *shapes)
+    {
+        command.ids.push_back(shape.id);
+    }
+    push(std::move(command));
+}
+
+void History::add(Document* document, std::vector<RectangleShape> rectangles, std::vector<PathShape> paths)
+{
+    if (rectangles.empty() && paths.empty())
+    {
+        return;
+    }
+
+    document->restore_rectangles(rectangles);
+    document->restore_paths(paths);
+
+    Command command;
+    command.kind = CommandKind::add;
+    command.ids.reserve(rectangles.size() + paths.size());
+    for (const auto& shape : rectangles)
+    {
+        command.ids.push_back(shape.id);
+    }
+    for (const auto& path : paths)
+    {
+        command.ids.push_back(path.id);
+    }
+    push(std::move(command));
+}
+
+void History::remove(Document* document, const std::vector<Id>& ids)
+{
+    Command command;
+    command.kind = CommandKind::remove;
+    command.ids = copy_shapes(*document, ids, &command.rects_before, &command.colors_before, &command.paths, &command.instances);
+    if (command.ids.empty())
+    {
+        return;
+    }
+
+    document->remove(command.ids);
+    push(std::move(command));
+}
+
+void History::move(Document* document, const std::vector<Id>& ids, const glm::vec2& delta, bool continue_previous)
+{
+    const bool can_merge
+        =  continue_previous
+        && position > 0
+        && position == commands.size()
+        && commands.back().kind == CommandKind::move
+        ;
+
+    if (can_merge)
+    {
+        auto& previous = commands.back();
+        if (previous.ids == ids)
+        {
+            for (auto& rect : previous.rects_after)
+            {
+                rect.topleft += delta;
+            }
+            set_rects(document, previous.ids, previous.rects_after);
+            return;
+        }
+    }
+
+    Command command;
+    command.kind = CommandKind::move;
+    command.ids = materialize(document, ids);
+    if (command.ids.empty())
+    {
+        return;
+    }
+
+    command.rects_before.reserve(command.ids.size());
+    for (const auto id : command.ids)
+    {
+        command.rects_before.push_back(document->shapes.get_bounds(document->shapes.find(id)));
+    }
+    command.rects_after = command.rects_before;
+    for (auto& rect : command.rects_after)
+    {
+        rect.topleft += delta;
+    }
+
+    set_rects(document, command.ids, command.rects_after);
+    push(std::move(command));
+}
+
+void History::set_color(Document* document, const std::vector<Id>& ids, const Rgba& color)
+{
+    Command command;
+    command.kind = CommandKind::restyle;
+    command.ids = materialize(document, ids);
+    if (command.ids.empty())
+    {
+        return;
+    }
+
+    command.colors_before.reserve(command.ids.size());
+    for (const auto id : command.ids)
+    {
+        const auto ref = document->shapes.find(id);
+        command.colors_before.push_back(document->shapes.get_color(ref));
+        if (ref.kind == ShapeKind::instance)
+        {
+            command.instances.push_back(document->shapes.instances.get(ref.slot));
+        }
+    }
+    command.colors_after.assign(command.ids.size(), color);
+
+    set_colors(document, command.ids, command.colors_after);
+    push(std::move(command));
+}
+
+bool History::undo(Document* document)
+{
+    if (can_undo() == false)
+    {
+        return false;
+    }
+
+    position -= 1;
+    apply(document, &commands[position], false);
+    return true;
+}
+
+bool History::redo(Document* document)
+{
+    if (can_redo() == false)
+    {
+        return false;
+    }
+
+    apply(document, &commands[position], true);
+    position += 1;
+    return true;
+}
+
+void History::clear()
+{
+    commands.clear();
+    position = 0;
+    memory_usage = 0;
+}
+
+void History::push(Command command)
+{
+    // a new edit replaces whatever could be redone
+    while (commands.size() > position)
+    {
+        memory_usage -= commands.back().get_memory_usage();
+        commands.pop_back();
+    }
+
+    command.ids.shrink_to_fit();
+    command.rects_before.shrink_to_fit();
+    command.colors_before.shrink_to_fit();
+    memory_usage += command.get_memory_usage();
+    commands.push_back(std::move(command));
+    position = commands.size();
+
+    // the edit is already applied so it is kept even if it alone is over the budget
+    while (commands.size() > 1 && memory_usage > budget_bytes)
+    {
+        memory_usage -= commands.front().get_memory_usage();
+        commands.pop_front();
+        position -= 1;
+    }
+}
+
+void History::apply(Document* document, Command* command_to_apply, bool forward)
+{
+    auto& command = *command_to_apply;
+    memory_usage -= command.get_memory_usage();
+    switch (command.kind)
+    {
+    case CommandKind::add:
+        // the shapes are only kept while they are out of the document
+        if (forward)
+        {
+            document->restore_rectangles(get_shapes(command.ids, command.rects_after, command.colors_after));
+            document->restore_paths(command.paths);
+            document->restore_instances(command.instances);
+            free_vector(&command.rects_after);
+            free_vector(&command.colors_after);
+            free_vector(&command.paths);
+            free_vector(&command.instances);
+        }
+        else
+        {
+            command.ids = copy_shapes(*document, command.ids, &command.rects_after, &command.colors_after, &command.paths, &command.instances);
+            command.rects_after.shrink_to_fit();
+            command.colors_after.shrink_to_fit();
+            document->remove(command.ids);
+        }
+        break;
+    case CommandKind::remove:
+        if (forward) { document->remove(command.ids); }
+        else
+        {
+            document->restore_rectangles(get_shapes(command.ids, command.rects_before, command.colors_before));
+            document->restore_paths(command.paths);
+            document->restore_instances(command.instances);
+        }
+        break;
+    case CommandKind::move:
+        set_rects(document, command.ids, forward ? command.rects_after : command.rects_before);
+        break;
+    case CommandKind::restyle:
+        set_colors(document, command.ids, forward ? command.colors_after : command.colors_before);
+        if (forward == false)
+        {
+            // an instance that had the color of its symbol gets it back
+            auto& instances = document->shapes.instances;
+            for (const auto& instance : command.instances)
+            {
+                const auto ref = document->shapes.find(instance.id);
+                if (ref.kind == ShapeKind::instance) { instances.colors[ref.slot] = instance.color; }
+            }
+        }
+        break;
+    }
+    memory_usage += command.get_memory_usage();
+}
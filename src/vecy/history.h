@@ -0,0 +1,95 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <cstddef>
+
+#include "glm/vec2.hpp"
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/rgba.h"
+#include "vecy/shape_store.h"
+
+struct Document;
+
+enum class CommandKind
+{
+    add, remove, move, restyle
+};
+
+// What an edit did to the shapes, by id, with enough of the before and after state to apply it either way.
+// add only has the ids while it can be undone, the shapes are in the document until undo takes them
+// into the after state for a redo. remove only has the before state, move the bounds and restyle the colors.
+// An added or removed path or instance is kept whole, the rects and colors are for the rectangles that come first in the ids.
+// A restyle keeps the instances it recolored so undo can tell a recolored instance from one that wasn't.
+// Undo never has to replay older commands so it costs as much as the edit did.
+struct Command
+{
+    CommandKind kind = CommandKind::add;
+    std::vector<Id> ids;
+    std::vector<Rect> rects_before;
+    std::vector<Rect> rects_after;
+    std::vector<Rgba> colors_before;
+    std::vector<Rgba> colors_after;
+    std::vector<PathShape> paths;
+    std::vector<InstanceShape> instances;
+
+    [[nodiscard]] std::size_t get_memory_usage() const;
+};
+
+// The undo and redo stacks as one list of commands, commands before the position can be undone.
+// The oldest commands are dropped when the history uses more memory than the budget,
+// except the newest so the last edit can always be undone.
+struct History
+{
+    std::size_t budget_bytes = 64 * 1024 * 1024;
+
+    // adds the shapes to the document with new ids, written back to the shapes
+    void add(Document* document, std::vector<RectangleShape>* shapes);
+
+    // adds shapes that already have their ids, like an import that took them in the order of the file, as one step
+    void add(Document* document, std::vector<RectangleShape> rectangles, std::vector<PathShape> paths);
+
+    void remove(Document* document, const std::vector<Id>& ids);
+
+    // continue_previous: merge with the previous move of the same shapes, so a drag is undone as one step
+    void move(Document* document, const std::vector<Id>& ids, const glm::vec2& delta, bool continue_previous = false);
+
+    void set_color(Document* document, const std::vector<Id>& ids, const Rgba& color);
+
+    bool undo(Document* document);
+    bool redo(Document* document);
+
+    [[nodiscard]] bool can_undo() const
+    {
+        return position > 0;
+    }
+
+    [[nodiscard]] bool can_redo() const
+    {
+        return position < commands.size();
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return commands.size();
+    }
+
+    [[nodiscard]] std::size_t get_memory_usage() const
+    {
+        return memory_usage;
+    }
+
+    // call when the document is replaced, the ids in the commands mean nothing in the new one
+    void clear();
+
+private:
+    void push(Command command);
+    // an add moves its shapes between the document and the command so the memory usage is updated
+    void apply(Document* document, Command* command, bool forward);
+
+    std::deque<Command> commands;
+    std::size_t position = 0;
+    std::size_t memory_usage = 0;
+};
@@ -0,0 +1,93 @@
+#include "vecy/id_set.h"
+
+#include <algorithm>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace
+{
+    // the index of the lowest set bit, the word isn't 0
+    u64 get_lowest_bit(u64 word)
+    {
+    #if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return index;
+    #else
+        return static_cast<u64>(__builtin_ctzll(word));
+    #endif
+    }
+}
+
+bool IdSet::insert(Id id)
+{
+    const auto word = static_cast<std::size_t>(id.id / 64);
+    if (word >= bits.size())
+    {
+        bits.resize(word + 1, 0);
+    }
+
+    const auto bit = u64{1} << (id.id % 64);
+    if ((bits[word] & bit) != 0)
+    {
+        return false;
+    }
+    bits[word] |= bit;
+    ids.push_back(id);
+    return true;
+}
+
+bool IdSet::erase(Id id)
+{
+    if (contains(id) == false)
+    {
+        return false;
+    }
+    reset_bit(id);
+    ids.erase(std::find(ids.begin(), ids.end(), id));
+    return true;
+}
+
+void IdSet::clear()
+{
+    // a large set is faster to clear all at once than member by member
+    if (ids.size() > bits.size())
+    {
+        std::fill(bits.begin(), bits.end(), 0);
+    }
+    else
+    {
+        for (const auto id : ids)
+        {
+            reset_bit(id);
+        }
+    }
+    ids.clear();
+}
+
+void IdSet::sort()
+{
+    // when the set is dense the bits are already sorted
+    if (ids.size() > bits.size())
+    {
+        ids.clear();
+        for (std::size_t word = 0; word < bits.size(); word += 1)
+        {
+            for (u64 w = bits[word]; w != 0; w &= w - 1)
+            {
+                ids.push_back(Id{ word * 64 + get_lowest_bit(w) });
+            }
+        }
+    }
+    else
+    {
+        std::sort(ids.begin(), ids.end(), [](const Id& lhs, const Id& rhs) { return lhs.id < rhs.id; });
+    }
+}
+
+std::size_t IdSet::get_memory_usage() const
+{
+    return bits.capacity() * sizeof(u64) + ids.capacity() * sizeof(Id);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include "vecy/types.h"
+
+// A set of shape ids that stops allocating once it has seen the largest id and the largest size.
+// Membership is a bit per id, the ids are dense since the generator counts up, and the members
+// are also kept in a vector so iterating and clearing takes time in the size and not in the ids.
+// Slots would be denser but they move when shapes are removed or sorted, ids don't.
+struct IdSet
+{
+    using const_iterator = std::vector<Id>::const_iterator;
+
+    // returns false if the id was already in the set
+    bool insert(Id id);
+
+    // returns false if the id wasn't in the set
+    bool erase(Id id);
+
+    // removes every id the predicate is true for, in a single pass
+    template<typename F>
+    void erase_if(F&& predicate)
+    {
+        std::size_t kept = 0;
+        for (const auto id : ids)
+        {
+            if (predicate(id))
+            {
+                reset_bit(id);
+            }
+            else
+            {
+                ids[kept] = id;
+                kept += 1;
+            }
+        }
+        ids.resize(kept);
+    }
+
+    [[nodiscard]] bool contains(Id id) const
+    {
+        const auto word = id.id / 64;
+        return word < bits.size() && (bits[word] & (u64{1} << (id.id % 64))) != 0;
+    }
+
+    // keeps the memory for the next fill
+    void clear();
+
+    // the ids are iterated in insertion order until this sorts them in paint order
+    void sort();
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return ids.size();
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return ids.empty();
+    }
+
+    [[nodiscard]] const_iterator begin() const
+    {
+        return ids.begin();
+    }
+
+    [[nodiscard]] const_iterator end() const
+    {
+        return ids.end();
+    }
+
+    [[nodiscard]] std::size_t get_memory_usage() const;
+
+private:
+    void reset_bit(Id id)
+    {
+        bits[id.id / 64] &= ~(u64{1} << (id.id % 64));
+    }
+
+    std::vector<u64> bits;
+    std::vector<Id> ids;
+};
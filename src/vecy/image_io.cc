@@ -0,0 +1,193 @@
+#include "vecy/image_io.h"
+
+#include <cstdio>
+#include <vector>
+#include <cctype>
+#include <algorithm>
+
+namespace
+{
+    struct File
+    {
+        std::FILE* handle;
+
+        explicit File(const std::string& path)
+            : handle(std::fopen(path.c_str(), "wb"))
+        {
+        }
+
+        ~File()
+        {
+            if (handle != nullptr)
+            {
+                std::fclose(handle);
+            }
+        }
+
+        File(const File&) = delete;
+        void operator=(const File&) = delete;
+
+        bool write(const std::vector<u8>& data)
+        {
+            return std::fwrite(data.data(), 1, data.size(), handle) == data.size();
+        }
+    };
+
+    u32 crc32(const u8* data, std::size_t size, u32 crc = 0)
+    {
+        static const auto table = []()
+        {
+            std::vector<u32> t(256);
+            for (u32 n = 0; n < 256; n += 1)
+            {
+                u32 c = n;
+                for (int k = 0; k < 8; k += 1)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[n] = c;
+            }
+            return t;
+        }();
+
+        crc = ~crc;
+        for (std::size_t i = 0; i < size; i += 1)
+        {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    u32 adler32(const u8* data, std::size_t size)
+    {
+        u32 a = 1;
+        u32 b = 0;
+        for (std::size_t i = 0; i < size; i += 1)
+        {
+            a = (a + data[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    void push_u32(std::vector<u8>* out, u32 v)
+    {
+        out->push_back(static_cast<u8>(v >> 24));
+        out->push_back(static_cast<u8>(v >> 16));
+        out->push_back(static_cast<u8>(v >> 8));
+        out->push_back(static_cast<u8>(v));
+    }
+
+    void push_chunk(std::vector<u8>* out, const char* type, const std::vector<u8>& data)
+    {
+        push_u32(out, static_cast<u32>(data.size()));
+        const auto start = out->size();
+        out->insert(out->end(), type, type + 4);
+        out->insert(out->end(), data.begin(), data.end());
+        push_u32(out, crc32(out->data() + start, out->size() - start));
+    }
+
+    // a zlib stream made of uncompressed deflate blocks
+    std::vector<u8> zlib_store(const std::vector<u8>& data)
+    {
+        constexpr std::size_t max_block = 65535;
+
+        std::vector<u8> out;
+        out.reserve(data.size() + (data.size() / max_block + 1) * 5 + 6);
+        out.push_back(0x78);
+        out.push_back(0x01);
+
+        std::size_t offset = 0;
+        do
+        {
+            const auto size = std::min(max_block, data.size() - offset);
+            const bool is_last = offset + size == data.size();
+            out.push_back(is_last ? 1 : 0);
+            out.push_back(static_cast<u8>(size));
+            out.push_back(static_cast<u8>(size >> 8));
+            out.push_back(static_cast<u8>(~size));
+            out.push_back(static_cast<u8>(~size >> 8));
+            out.insert(out.end(), data.begin() + offset, data.begin() + offset + size);
+            offset += size;
+        } while (offset < data.size());
+
+        push_u32(&out, adler32(data.data(), data.size()));
+        return out;
+    }
+
+    bool ends_with(const std::string& str, const std::string& end)
+    {
+        return str.size() >= end.size() && std::equal(end.rbegin(), end.rend(), str.rbegin(), [](char lhs, char rhs)
+        {
+            return std::tolower(static_cast<unsigned char>(lhs)) == rhs;
+        });
+    }
+}
+
+bool write_png(const Image& image, const std::string& path)
+{
+    // every row starts with the filter type, 0 is none
+    std::vector<u8> raw;
+    raw.reserve(static_cast<std::size_t>(image.height) * (image.width * 4 + 1));
+    for (int y = 0; y < image.height; y += 1)
+    {
+        raw.push_back(0);
+        const auto* row = image.get_row(y);
+        for (int x = 0; x < image.width; x += 1)
+        {
+            const auto p = row[x];
+            raw.push_back(static_cast<u8>(p));
+            raw.push_back(static_cast<u8>(p >> 8));
+            raw.push_back(static_cast<u8>(p >> 16));
+            raw.push_back(static_cast<u8>(p >> 24));
+        }
+    }
+
+    std::vector<u8> header;
+    push_u32(&header, static_cast<u32>(image.width));
+    push_u32(&header, static_cast<u32>(image.height));
+    header.push_back(8); // bit depth
+    header.push_back(6); // rgba
+    header.push_back(0); // deflate
+    header.push_back(0); // adaptive filtering
+    header.push_back(0); // not interlaced
+
+    std::vector<u8> out = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    push_chunk(&out, "IHDR", header);
+    push_chunk(&out, "IDAT", zlib_store(raw));
+    push_chunk(&out, "IEND", {});
+
+    File file{ path };
+    return file.handle != nullptr && file.write(out);
+}
+
+bool write_ppm(const Image& image, const std::string& path)
+{
+    const auto header = "P6\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n255\n";
+
+    std::vector<u8> out(header.begin(), header.end());
+    out.reserve(out.size() + static_cast<std::size_t>(image.width) * image.height * 3);
+    for (int y = 0; y < image.height; y += 1)
+    {
+        const auto* row = image.get_row(y);
+        for (int x = 0; x < image.width; x += 1)
+        {
+            const auto p = row[x];
+            out.push_back(static_cast<u8>(p));
+            out.push_back(static_cast<u8>(p >> 8));
+            out.push_back(static_cast<u8>(p >> 16));
+        }
+    }
+
+    File file{ path };
+    return file.handle != nullptr && file.write(out);
+}
+
+bool save_image(const Image& image, const std::string& path)
+{
+    if (ends_with(path, ".ppm"))
+    {
+        return write_ppm(image, path);
+    }
+    return write_png(image, path);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+#include "vecy/raster.h"
+
+// writes an uncompressed 8 bit rgba png
+bool write_png(const Image& image, const std::string& path);
+
+// writes a binary rgb ppm, alpha is dropped
+bool write_ppm(const Image& image, const std::string& path);
+
+// picks the format from the extension, png unless the path ends with .ppm
+bool save_image(const Image& image, const std::string& path);
@@ -8,15 +8,39 @@
 #include <wx/graphics.h>
 
 #include <vector>
-#include <memory>
 #include <unordered_map>
-#include <unordered_set>
 #include <optional>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #include "open-color.h"
 
 #include "glm/vec2.hpp"
 
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/canvas_transform.h"
+#include "vecy/rgba.h"
+#include "vecy/style.h"
+#include "vecy/settings.h"
+#include "vecy/painter.h"
+#include "vecy/document.h"
+#include "vecy/document_file.h"
+#include "vecy/svg.h"
+#include "vecy/history.h"
+#include "vecy/profiler.h"
+#include "vecy/render.h"
+#include "vecy/raster.h"
+#include "vecy/image_io.h"
+#include "vecy/thread_pool.h"
+#include "vecy/tiled_raster.h"
+#include "vecy/tile_cache.h"
+
 
 class MyApp: public wxApp
 {
@@ -24,416 +48,555 @@ public:
     virtual bool OnInit();
 };
 
-using u8 = std::uint8_t;
-using u64 = std::uint64_t;
-
-struct Id
+wxColor to_wx(const Rgba& c)
 {
-    u64 id;
+    return wxColor{ c.r, c.g, c.b, c.a };
+}
 
-    bool operator==(const Id& rhs) const
+wxPenStyle to_wx(LineStyle style)
+{
+    switch (style)
     {
-        return id == rhs.id;
+        case LineStyle::solid: return wxPENSTYLE_SOLID;
+        case LineStyle::dot: return wxPENSTYLE_DOT;
+        case LineStyle::long_dash: return wxPENSTYLE_LONG_DASH;
+        case LineStyle::short_dash: return wxPENSTYLE_SHORT_DASH;
+        case LineStyle::dot_dash: return wxPENSTYLE_DOT_DASH;
+        default:
+            assert(false);
+            return wxPENSTYLE_SOLID;
     }
-};
-
-namespace std
-{
-	template<>
-	struct hash<Id>
-	{
-		std::size_t operator()(const Id& k) const
-		{
-            return hash<u64>{}(k.id);
-		}
-	};
 }
 
-struct IdGenerator
+wxBrushStyle to_wx(FillStyle style)
 {
-    u64 next = 0;
-
-    Id create()
+    switch(style)
     {
-        const u64 value = next;
-        next += 1;
-        return { value };
+        case FillStyle::solid: return wxBRUSHSTYLE_SOLID;
+        case FillStyle::bdiagonal_hatch: return wxBRUSHSTYLE_BDIAGONAL_HATCH;
+        case FillStyle::crossdiag_hatch: return wxBRUSHSTYLE_CROSSDIAG_HATCH;
+        case FillStyle::fdiagonal_hatch: return wxBRUSHSTYLE_FDIAGONAL_HATCH;
+        case FillStyle::cross_hatch: return wxBRUSHSTYLE_CROSS_HATCH;
+        case FillStyle::horizontal_hatch: return wxBRUSHSTYLE_HORIZONTAL_HATCH;
+        case FillStyle::vertical_hatch: return wxBRUSHSTYLE_VERTICAL_HATCH;
+        default:
+            assert(false);
+            return wxBRUSHSTYLE_SOLID;
     }
-};
+}
 
-struct Rgba
+wxPen to_wx(std::optional<Outline> o)
 {
-    u8 r;
-    u8 g;
-    u8 b;
-    u8 a;
-
-    Rgba(open_color::Hex h, u8 aa = 255)
-        : r((h >> 16) & 0xFF)
-        , g((h >> 8) & 0xFF)
-        , b((h) & 0xFF)
-        , a(aa)
+    if (o)
     {
+        return wxPen{to_wx(o->color), o->width, to_wx(o->style)};
     }
-
-    wxColor to_wx() const
+    else
     {
-        return wxColor{ r, g, b, a };
+        return *wxTRANSPARENT_PEN;
     }
-};
+}
 
-glm::vec2 from_to(const glm::vec2& f, const glm::vec2& t)
+wxBrush to_wx_brush(std::optional<Fill> o)
 {
-    return t - f;
+    if (o)
+    {
+        return wxBrush{ to_wx(o->color), to_wx(o->style) };
+    }
+    else
+    {
+        return *wxTRANSPARENT_BRUSH;
+    }
 }
 
-struct CanvasTransform
+// wx pens and brushes by state key, kept between frames so they are only created once
+struct StyleCache
 {
-    // canvas view
-    glm::vec2 scroll = glm::vec2{0.0f, 0.0f};
-    float scale = 1.0f;
+    // when a map grows past this it is cleared
+    std::size_t capacity = 256;
+
+    std::unordered_map<u64, wxPen> pens;
+    std::unordered_map<u64, wxBrush> brushes;
 
-    // "config"
-    float scale_range_min = 0.1f;
-    float scale_range_max = 15.0f;
+    int hits = 0;
+    int misses = 0;
+    int evictions = 0;
 
-    void zoom(const glm::vec2& mouse, float zoom)
+    const wxPen& get_pen(const std::optional<Outline>& outline)
     {
-        // todo(Gustav): change to use screen_to_world
-        const auto focus = from_screen_to_world(mouse);
+        return get(&pens, get_state_key(outline), [&]() { return to_wx(outline); });
+    }
 
-        const float scale_factor = 1 + 0.01f * abs(zoom);
+    const wxBrush& get_brush(const std::optional<Fill>& fill)
+    {
+        return get(&brushes, get_state_key(fill), [&]() { return to_wx_brush(fill); });
+    }
 
-        if (zoom < 0.0f)
+    template<typename T, typename F>
+    const T& get(std::unordered_map<u64, T>* cache, u64 key, F&& create)
+    {
+        auto found = cache->find(key);
+        if (found != cache->end())
         {
-            scale /= scale_factor;
+            hits += 1;
+            return found->second;
         }
 
-        if (zoom > 0.0f)
+        misses += 1;
+        if (cache->size() >= capacity)
         {
-            scale *= scale_factor;
+            evictions += static_cast<int>(cache->size());
+            cache->clear();
         }
-
-        scale = std::min(std::max(scale_range_min, scale), scale_range_max);
-
-        const auto new_focus = from_world_to_screen(focus);
-        scroll = scroll + from_to(new_focus, mouse);
-    }
-
-    [[nodiscard]] glm::vec2 from_screen_to_world(const glm::vec2& p) const
-    {
-        return (p - scroll) / scale;
+        return cache->emplace(key, create()).first->second;
     }
-
-    [[nodiscard]] glm::vec2 from_world_to_screen(const glm::vec2& p) const
-    {
-        return scroll + p * scale;
-    }
-};
-
-enum class LineStyle
-    { solid, dot, long_dash, short_dash, dot_dash };
-
-enum class FillStyle {
-    solid, bdiagonal_hatch, crossdiag_hatch, fdiagonal_hatch,
-    cross_hatch, horizontal_hatch, vertical_hatch
-};
-
-struct Outline
-{
-    Rgba color;
-    int width;
-    LineStyle style;
 };
 
-struct Fill
+// draws with a wx dc, translucent primitives go through the graphics context
+struct WxPainter : Painter
 {
-    Rgba color;
-    FillStyle style;
-};
-
-struct Settings
-{
-    Rgba background_color = open_color::gray_9;
-    Rgba grid_color = open_color::green_9;
-    Fill handle_color = { open_color::violet_9, FillStyle::solid };
-
+    WxPainter(wxDC* d, wxGraphicsContext* g, DrawCommandList* c, StyleCache* s)
+        : dc(d)
+        , graphics(g)
+        , commands(c)
+        , cache(s)
+    {
+    }
 
-    // posive: only fully enclosed are selected
-    // negative: also include intersecting
-    bool draw_selection_border = true;
-    Outline selection_border_positive = {open_color::gray_3, 1, LineStyle::solid};
-    Outline selection_border_negative = {open_color::gray_3, 1, LineStyle::long_dash};
+    wxDC* dc;
+    wxGraphicsContext* graphics;
 
-    bool draw_selection_fill = true;
-    Fill selection_fill_positive = Fill{ Rgba{open_color::blue_9}, FillStyle::bdiagonal_hatch};
-    Fill selection_fill_negative = Fill{ Rgba{open_color::green_9}, FillStyle::fdiagonal_hatch};
+    // when set primitives are recorded and drawn when flushed
+    DrawCommandList* commands = nullptr;
 
-    float handle_radius = 5.0f;
-};
+    // when set pens and brushes are reused from here
+    StyleCache* cache = nullptr;
 
-struct Painter;
+    // the state last set on the dc and the graphics context, ~0 is unknown
+    static constexpr u64 unknown_state = ~u64{0};
+    u64 dc_pen = unknown_state;
+    u64 dc_brush = unknown_state;
+    u64 graphics_pen = unknown_state;
+    u64 graphics_brush = unknown_state;
 
-struct Shape
-{
-    Id id;
-    explicit Shape(Id i) : id(std::move(i)) {}
-    virtual ~Shape() = default;
+    void clear(const Rgba& color) override
+    {
+        flush();
 
-    virtual void paint(Painter*, const CanvasTransform& transform, const Settings& settings) = 0;
-    virtual void paint_selected(Painter*, const CanvasTransform& transform, const Settings& settings) = 0;
+        dc->SetBackground(get_brush(Fill{ color, FillStyle::solid }));
+        dc->Clear();
+    }
 
-    virtual bool is_hit(const CanvasTransform& t, const glm::vec2& p, float extra) = 0;
-};
+    void draw_text(const std::string& str, const glm::vec2& p, const Rgba& color) override
+    {
+        flush();
 
-struct Rect
-{
-    glm::vec2 topleft;
-    glm::vec2 size;
+        dc->SetTextForeground(to_wx(color));
+        dc->DrawText(wxString::FromUTF8(str.c_str()), p.x, p.y);
+    }
 
-    Rect extend(float x) const
+    void draw_rectangle(const Rect& r, const std::optional<Fill>& color, const std::optional<Outline>& outline) override
     {
-        return
+        if (r.size.x > 0 && r.size.y > 0)
         {
-            {topleft.x - x, topleft.y - x},
-            {size.x + x * 2.0f, size.y + x * 2.0f}
-        };
+            draw({ DrawCommandType::rectangle, is_alpha(color, outline), r.topleft, r.size, color, outline });
+        }
     }
 
-    bool contains(const glm::vec2& p) const
+    void draw_circle(const glm::vec2& p, float radius, const std::optional<Fill>& color, const std::optional<Outline>& outline) override
     {
-        const bool outside
-            = p.x < topleft.x
-             || p.x > topleft.x + size.x
-             || p.y > topleft.y + size.y
-             || p.y < topleft.y
-            ;
-        return !outside;
+        draw({ DrawCommandType::circle, is_alpha(color, outline), p, {radius, radius}, color, outline });
     }
 
-    void include(const glm::vec2& p)
+    void draw_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline) override
     {
-        if (p.x < topleft.x)
-        {
-            size.x += topleft.x - p.x;
-            topleft.x = p.x;
-        }
-        else if (p.x > topleft.x + size.x)
+        draw({ DrawCommandType::line, is_alpha(outline.color), from, to, std::nullopt, outline });
+    }
+
+    void draw_path(const PathView& path, const std::optional<Fill>& fill, const std::optional<Outline>& outline) override
+    {
+        if (path.contour_count == 0)
         {
-            size.x = p.x - topleft.x;
+            return;
         }
 
-        if (p.y < topleft.y)
+        // recorded paths are copied since the caller reuses the points
+        if (commands != nullptr)
         {
-            size.y += topleft.y - p.y;
-            topleft.y = p.y;
+            commands->commands.push_back(commands->add_path(path, fill, outline));
         }
-        else if (p.y > topleft.y + size.y)
+        else
         {
-            size.y = p.y - topleft.y;
+            stats.primitives += 1;
+            set_state(true, { DrawCommandType::path, is_alpha(fill, outline), {0, 0}, {0, 0}, fill, outline });
+            draw_graphics_path(path, fill.has_value(), outline.has_value());
         }
     }
-};
 
-Rect from_world_to_screen(const CanvasTransform& t, const Rect& r)
-{
-    const glm::vec2 p = t.from_world_to_screen(r.topleft);
-    const glm::vec2 s = t.from_world_to_screen(r.topleft + r.size);
-    return {p, s - p};
-}
-
-wxPenStyle to_wx(LineStyle style)
-{
-    switch (style)
+    void set_clip(const Rect& r) override
     {
-        case LineStyle::solid: return wxPENSTYLE_SOLID;
-        case LineStyle::dot: return wxPENSTYLE_DOT;
-        case LineStyle::long_dash: return wxPENSTYLE_LONG_DASH;
-        case LineStyle::short_dash: return wxPENSTYLE_SHORT_DASH;
-        case LineStyle::dot_dash: return wxPENSTYLE_DOT_DASH;
-        default:
-            assert(false);
-            return wxPENSTYLE_SOLID;
+        flush();
+        const int left = static_cast<int>(std::floor(r.topleft.x));
+        const int top = static_cast<int>(std::floor(r.topleft.y));
+        const int right = static_cast<int>(std::ceil(r.topleft.x + r.size.x));
+        const int bottom = static_cast<int>(std::ceil(r.topleft.y + r.size.y));
+        const auto pixels = wxRect(left, top, right - left, bottom - top);
+        dc->SetClippingRegion(pixels);
+        graphics->Clip(pixels.x, pixels.y, pixels.width, pixels.height);
     }
-}
 
-wxBrushStyle to_wx(FillStyle style)
-{
-    switch(style)
+    void reset_clip() override
     {
-        case FillStyle::solid: return wxBRUSHSTYLE_SOLID;
-        case FillStyle::bdiagonal_hatch: return wxBRUSHSTYLE_BDIAGONAL_HATCH;
-        case FillStyle::crossdiag_hatch: return wxBRUSHSTYLE_CROSSDIAG_HATCH;
-        case FillStyle::fdiagonal_hatch: return wxBRUSHSTYLE_FDIAGONAL_HATCH;
-        case FillStyle::cross_hatch: return wxBRUSHSTYLE_CROSS_HATCH;
-        case FillStyle::horizontal_hatch: return wxBRUSHSTYLE_HORIZONTAL_HATCH;
-        case FillStyle::vertical_hatch: return wxBRUSHSTYLE_VERTICAL_HATCH;
-        default:
-            assert(false);
-            return wxBRUSHSTYLE_SOLID;
+        flush();
+        dc->DestroyClippingRegion();
+        graphics->ResetClip();
     }
-}
 
-wxPen to_wx(std::optional<Outline> o)
-{
-    if (o)
+    // every wx call costs far more than the pixels a small shape fills
+    bool wants_lod() const override
     {
-        return wxPen{o->color.to_wx(), o->width, to_wx(o->style)};
+        return true;
     }
-    else
+
+    void begin_batch(BatchOrder order) override
     {
-        return *wxTRANSPARENT_PEN;
+        if (commands == nullptr) { return; }
+        commands->batches.push_back({ commands->commands.size(), order });
     }
-}
 
-wxBrush to_wx_brush(std::optional<Fill> o)
-{
-    if (o)
+    void flush() override
     {
-        return wxBrush{ o->color.to_wx(), to_wx(o->style) };
+        if (commands == nullptr) { return; }
+
+        sort_batches(commands);
+        for (const auto& c : commands->commands)
+        {
+            execute(c);
+        }
+
+        commands->clear();
     }
-    else
+
+    void set_state(bool alpha, const DrawCommand& c)
     {
-        return *wxTRANSPARENT_BRUSH;
-    }
-}
+        const bool has_brush = c.type != DrawCommandType::line;
 
-bool is_alpha(const Rgba& color)
-{
-    return color.a < 255;
-}
+        stats.unbatched_state_changes += has_brush ? 2 : 1;
 
-bool is_alpha(std::optional<Fill> fill, std::optional<Outline> outline)
-{
-    if (fill && is_alpha(fill->color)) { return true; }
-    else if (outline && is_alpha(outline->color)) { return true; }
-    else { return false; }
-}
+        const auto pen = get_state_key(c.outline);
+        auto& current_pen = alpha ? graphics_pen : dc_pen;
+        if (pen != current_pen)
+        {
+            if (alpha) { graphics->SetPen(get_pen(c.outline)); }
+            else { dc->SetPen(get_pen(c.outline)); }
+            current_pen = pen;
+            stats.state_changes += 1;
+        }
 
-template<typename T>
-std::optional<T> get_or_not(T t, bool include)
-{
-    if (include)
-    {
-        return std::move(t);
+        if (has_brush == false) { return; }
+
+        const auto brush = get_state_key(c.fill);
+        auto& current_brush = alpha ? graphics_brush : dc_brush;
+        if (brush != current_brush)
+        {
+            if (alpha) { graphics->SetBrush(get_brush(c.fill)); }
+            else { dc->SetBrush(get_brush(c.fill)); }
+            current_brush = brush;
+            stats.state_changes += 1;
+        }
     }
-    else
+
+    wxPen get_pen(const std::optional<Outline>& outline)
     {
-        return std::nullopt;
+        if (cache) { return cache->get_pen(outline); }
+        return to_wx(outline);
     }
-}
 
-struct Painter
-{
-    wxDC* dc;
-    wxGraphicsContext* graphics;
-
-    void clear(const Rgba& color)
+    wxBrush get_brush(const std::optional<Fill>& fill)
     {
-        wxBrush brush{ color.to_wx(), wxBRUSHSTYLE_SOLID };
-        dc->SetBackground(brush);
-        dc->Clear();
+        if (cache) { return cache->get_brush(fill); }
+        return to_wx_brush(fill);
     }
 
-    void draw_text(const wxString& str, glm::vec2 p, Rgba color)
+    void draw(const DrawCommand& c)
     {
-        dc->SetTextForeground(color.to_wx());
-        dc->DrawText(str, p.x, p.y);
+        if (commands != nullptr)
+        {
+            commands->commands.push_back(c);
+        }
+        else
+        {
+            execute(c);
+        }
     }
 
-    void draw_rectangle(const Rect& r, std::optional<Fill> color, std::optional<Outline> outline)
+    void execute(const DrawCommand& c)
     {
-        if (r.size.x > 0 && r.size.y > 0)
+        stats.primitives += 1;
+        set_state(c.alpha || c.type == DrawCommandType::path, c);
+
+        switch (c.type)
         {
-            if (is_alpha(color, outline))
+        case DrawCommandType::rectangle:
+            if (c.alpha)
             {
-                graphics->SetBrush(to_wx_brush(color));
-                graphics->SetPen(to_wx(outline));
-                graphics->DrawRectangle(r.topleft.x, r.topleft.y, r.size.x, r.size.y);
+                graphics->DrawRectangle(c.a.x, c.a.y, c.b.x, c.b.y);
             }
             else
             {
-                dc->SetBrush(to_wx_brush(color));
-                dc->SetPen(to_wx(outline));
-                dc->DrawRectangle(wxRect(r.topleft.x, r.topleft.y, r.size.x, r.size.y));
+                dc->DrawRectangle(wxRect(c.a.x, c.a.y, c.b.x, c.b.y));
+            }
+            break;
+        case DrawCommandType::circle:
+        {
+            const auto radius = c.b.x;
+            if (c.alpha)
+            {
+                graphics->DrawEllipse(c.a.x - radius, c.a.y - radius, radius * 2, radius * 2);
             }
+            else
+            {
+                dc->DrawEllipse(c.a.x - radius, c.a.y - radius, radius * 2, radius * 2);
+
+                // dc->DrawCircle(static_cast<wxCoord>(p.x), static_cast<wxCoord>(p.y), static_cast<wxCoord>(radius));
+            }
+            break;
+        }
+        case DrawCommandType::line:
+            if (c.alpha)
+            {
+                wxPoint2DDouble points[2] =
+                {
+                    {c.a.x, c.a.y},
+                    {c.b.x, c.b.y}
+                };
+                graphics->DrawLines(2, points);
+            }
+            else
+            {
+                dc->DrawLine({ static_cast<int>(c.a.x), static_cast<int>(c.a.y) }, { static_cast<int>(c.b.x), static_cast<int>(c.b.y) });
+            }
+            break;
+        case DrawCommandType::path:
+            draw_graphics_path(commands->get_path(c), c.fill.has_value(), c.outline.has_value());
+            break;
+        case DrawCommandType::clear:
+            // only recorded by the recording painter
+            assert(false);
+            break;
         }
     }
 
-    void draw_circle(const glm::vec2& p, float radius, std::optional<Fill> color, std::optional<Outline> outline)
+    // the dc can't fill curves with the nonzero rule so paths always go through the graphics context
+    void draw_graphics_path(const PathView& path, bool filled, bool outlined)
     {
-        if(is_alpha(color, outline))
+        auto p = graphics->CreatePath();
+        for (std::size_t contour = 0; contour < path.contour_count; contour += 1)
         {
-            graphics->SetBrush(to_wx_brush(color));
-            graphics->SetPen(to_wx(outline));
-            graphics->DrawEllipse(p.x - radius, p.y - radius, radius * 2, radius * 2);
+            const auto first = path.get_start(contour);
+            const auto end = path.contours[contour].end;
+            p.MoveToPoint(path.points[first].x, path.points[first].y);
+            for (u32 i = first + 1; i < end; i += 1)
+            {
+                p.AddLineToPoint(path.points[i].x, path.points[i].y);
+            }
+            if (path.contours[contour].closed)
+            {
+                p.CloseSubpath();
+            }
         }
-        else
-        {
-            dc->SetBrush(to_wx_brush(color));
-            dc->SetPen(to_wx(outline));
-            dc->DrawEllipse(p.x - radius, p.y - radius, radius * 2, radius * 2);
 
-            // dc->DrawCircle(static_cast<wxCoord>(p.x), static_cast<wxCoord>(p.y), static_cast<wxCoord>(radius));
-        }
+        if (filled) { graphics->FillPath(p, wxWINDING_RULE); }
+        if (outlined) { graphics->StrokePath(p); }
     }
+};
 
-    void draw_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline)
+// the bitmap the canvas is rendered to before it is copied to the window
+struct BackBuffer
+{
+    glm::ivec2 size = { 0, 0 };
+    wxBitmap bitmap;
+    wxMemoryDC dc;
+    std::unique_ptr<wxGraphicsContext> graphics;
+
+    // recreates the bitmap and graphics context when the size has changed, returns false if there is nothing to draw to
+    bool ensure_size(const glm::ivec2& new_size)
     {
-        if(is_alpha(outline.color))
+        if (new_size.x <= 0 || new_size.y <= 0)
         {
-            wxPoint2DDouble points[2] =
-            {
-                {from.x, from.y},
-                {to.x, to.y}
-            };
-            graphics->SetPen(to_wx(outline));
-            graphics->DrawLines(2, points);
+            return false;
         }
-        else
+
+        if (graphics != nullptr && new_size == size)
         {
-            dc->SetPen(to_wx(outline));
-            dc->DrawLine({ static_cast<int>(from.x), static_cast<int>(from.y) }, { static_cast<int>(to.x), static_cast<int>(to.y) });
+            return true;
         }
+
+        graphics.reset();
+        dc.SelectObject(wxNullBitmap);
+
+        size = new_size;
+        bitmap = wxBitmap{ size.x, size.y };
+        dc.SelectObject(bitmap);
+        graphics.reset(wxGraphicsContext::Create(dc));
+        return true;
     }
 };
 
-struct RectangleShape : Shape
+// what the static layer was rendered with, when any of it changes the layer is redrawn
+struct StaticLayerState
 {
-    Rgba color;
-    Rect rect;
+    glm::vec2 scroll;
+    float scale;
+    glm::ivec2 size;
+    u64 document_version;
 
-    RectangleShape(Id i, Rgba cc, Rect r)
-        : Shape(std::move(i))
-        , color(std::move(cc))
-        , rect(std::move(r))
+    bool operator==(const StaticLayerState& rhs) const
+    {
+        return scroll == rhs.scroll && scale == rhs.scale && size == rhs.size && document_version == rhs.document_version;
+    }
+};
+
+// the screen areas covered by the overlay in a frame
+struct OverlayBounds
+{
+    std::optional<Rect> handles;
+    std::optional<Rect> selection_box;
+    std::optional<Rect> dragged;
+    std::optional<Rect> text;
+};
+
+void include(std::optional<Rect>* r, const Rect& more)
+{
+    if (*r)
     {
+        (*r)->include(more);
     }
+    else
+    {
+        *r = more;
+    }
+}
 
-    void paint(Painter* dc, const CanvasTransform& t, const Settings& settings) override
+// add the union of the old and new area of each overlay part, overlapping areas are merged
+void add_dirty_rects(std::vector<Rect>* rects, const OverlayBounds& old, const OverlayBounds& current)
+{
+    const auto add = [rects](const std::optional<Rect>& a, const std::optional<Rect>& b)
     {
-        dc->draw_rectangle(from_world_to_screen(t, rect), Fill{ color, FillStyle::solid }, std::nullopt);
+        std::optional<Rect> r;
+        if (a) { include(&r, *a); }
+        if (b) { include(&r, *b); }
+        if (!r) { return; }
+
+        for (auto& existing : *rects)
+        {
+            if (existing.intersects(*r))
+            {
+                existing.include(*r);
+                return;
+            }
+        }
+        rects->push_back(*r);
+    };
+
+    add(old.handles, current.handles);
+    add(old.selection_box, current.selection_box);
+    add(old.dragged, current.dragged);
+    add(old.text, current.text);
+}
+
+// the whole pixels that cover the rect, clamped to the screen
+wxRect to_wx_pixels(const Rect& r, const glm::ivec2& size)
+{
+    const int left = std::max(0, static_cast<int>(std::floor(r.topleft.x)));
+    const int top = std::max(0, static_cast<int>(std::floor(r.topleft.y)));
+    const int right = std::min(size.x, static_cast<int>(std::ceil(r.topleft.x + r.size.x)));
+    const int bottom = std::min(size.y, static_cast<int>(std::ceil(r.topleft.y + r.size.y)));
+    return wxRect(left, top, right - left, bottom - top);
+}
+
+struct FrameTiming
+{
+    // getting the back buffer and painter ready, rendering and copying to the window
+    double setup_ms = 0.0;
+    double render_ms = 0.0;
+    double present_ms = 0.0;
+};
+
+// merges repaint requests so at most one frame is rendered per refresh interval
+struct FrameScheduler
+{
+    using clock = std::chrono::steady_clock;
+
+    clock::duration interval = std::chrono::milliseconds{ 16 };
+
+    // a frame has been requested but not yet rendered
+    bool is_pending = false;
+    clock::time_point last_frame;
+
+    u64 events_received = 0;
+    u64 frames_rendered = 0;
+
+    // returns true if a new frame needs to be scheduled
+    bool request()
+    {
+        events_received += 1;
+        if (is_pending)
+        {
+            // the pending frame will render the latest state
+            return false;
+        }
+        is_pending = true;
+        return true;
     }
 
-    void paint_selected(Painter* dc, const CanvasTransform& t, const Settings& settings) override
+    // how long to wait before rendering the requested frame
+    int get_wait_ms(clock::time_point now) const
     {
-        const auto dx = glm::vec2{ rect.size.x, 0 };
-        const auto dy = glm::vec2{ 0, rect.size.y };
-        dc->draw_circle(t.from_world_to_screen(rect.topleft), settings.handle_radius, settings.handle_color, std::nullopt);
-        dc->draw_circle(t.from_world_to_screen(rect.topleft + dx), settings.handle_radius, settings.handle_color, std::nullopt);
-        dc->draw_circle(t.from_world_to_screen(rect.topleft + dy), settings.handle_radius, settings.handle_color, std::nullopt);
-        dc->draw_circle(t.from_world_to_screen(rect.topleft + dx + dy), settings.handle_radius, settings.handle_color, std::nullopt);
+        const auto next_frame = last_frame + interval;
+        if (next_frame <= now)
+        {
+            return 1;
+        }
+        const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_frame - now).count();
+        return std::max(1, static_cast<int>(wait));
     }
 
-    bool is_hit(const CanvasTransform& t, const glm::vec2& p, float extra) override
+    void on_frame(clock::time_point now)
     {
-        return from_world_to_screen(t, rect).extend(extra).contains(p);
+        is_pending = false;
+        last_frame = now;
+        frames_rendered += 1;
     }
 };
 
+struct RenderStats
+{
+    // shapes painted and skipped because they were outside of the view in the last frame
+    int drawn = 0;
+    int culled = 0;
+
+    // small shapes merged per pixel and the primitives they became, in the tiles drawn for the last frame
+    int lod_merged = 0;
+    int lod_primitives = 0;
+
+    PainterStats painter;
+    FrameTiming timing;
+
+    // how much of the canvas was redrawn, 1 is all of it
+    float redrawn_fraction = 0.0f;
+
+    // static layer tiles that weren't cached and had to be drawn in the last frame
+    int tiles_drawn = 0;
+
+    // the render scratch memory after the last frame, and the most any frame has used
+    ScratchStats scratch;
+    std::size_t scratch_peak_bytes = 0;
+};
+
 enum class MouseState
 {
-    none, left, middle, right
+    none, left, middle, right, drag
 };
 
 class CanvasWidget : public wxControl
@@ -441,22 +604,113 @@ class CanvasWidget : public wxControl
 public:
     CanvasWidget(wxWindow* parent, wxWindowID id)
 		: wxControl(parent, id, wxDefaultPosition, wxDefaultSize, wxBORDER_NONE)
+        , frame_timer(this)
+    {
+        add_example_shapes(&document);
+	}
+
+    void remove(const std::vector<Id>& ids)
+    {
+        history.remove(&document, ids);
+        forget_missing_shapes();
+        request_frame();
+    }
+
+    void remove_selection()
+    {
+        remove(std::vector<Id>(selection.begin(), selection.end()));
+    }
+
+#if defined(VECY_PROFILER)
+    void set_show_profiler(bool show)
+    {
+        show_profiler = show;
+        request_frame();
+    }
+#endif
+
+    void undo()
+    {
+        if (history.undo(&document))
+        {
+            forget_missing_shapes();
+            request_frame();
+        }
+    }
+
+    void redo()
     {
-        SetDoubleBuffered(true);
+        if (history.redo(&document))
+        {
+            forget_missing_shapes();
+            request_frame();
+        }
+    }
+
+    // undoing an add or redoing a remove takes shapes away that may be selected
+    void forget_missing_shapes()
+    {
+        const auto is_missing = [this](Id id) { return document.get_bounds(id).has_value() == false; };
+        selection.erase_if(is_missing);
+        hovers.erase_if(is_missing);
+    }
+
+    bool open(const std::string& path)
+    {
+        if (load_document(&document, path) == false)
+        {
+            return false;
+        }
+        history.clear();
+        hovers.clear();
+        selection.clear();
+        request_frame();
+        return true;
+    }
+
+    bool save(const std::string& path) const
+    {
+        return save_document(document, path);
+    }
 
-        add(std::make_shared<RectangleShape>(ids.create(), open_color::red_5 , Rect{{10, 10}, {10, 10}}));
-        add(std::make_shared<RectangleShape>(ids.create(), open_color::blue_5, Rect{{25, 10}, {10, 30}}));
-	}
+    // adds the shapes of the svg to the document
+    SvgImportStats import_svg_file(const std::string& path)
+    {
+        // one step in the history so the whole import can be undone, a file that failed to read adds nothing
+        SvgShapes shapes;
+        const auto stats = read_svg(&document.ids, path, &shapes);
+        if (stats.ok == false)
+        {
+            return stats;
+        }
+        history.add(&document, std::move(shapes.rectangles), std::move(shapes.paths));
+        request_frame();
+        return stats;
+    }
 
-    void add(std::shared_ptr<Shape> s)
+    bool export_svg_file(const std::string& path)
     {
-        shapes[s->id] = s;
+        return export_svg(&document, path);
     }
 
 	void OnPaint(wxPaintEvent& event);
 
     void paint_now();
-    void render(Painter& painter);
+
+    // render and copy the changed parts to the window, or all of it if redraw_window is set
+    void present(wxDC& dc, bool redraw_window);
+    OverlayBounds get_overlay_bounds(const CanvasTransform& trans, const std::string& text);
+    std::string get_overlay_text() const;
+
+    // schedule a repaint, input events call this instead of painting directly
+    void request_frame();
+    void on_frame_timer(wxTimerEvent& event);
+    // grid and shapes, copied from the tile cache and only the missing tiles are drawn
+    PainterStats render_static(const CanvasTransform& trans, const glm::ivec2& size);
+    PainterStats render_tile(wxBitmap* tile, const TileKey& key);
+
+    // selection handles, selection box, dragged shapes and text, the area is the part of the screen that is redrawn
+    void render_overlay(Painter* painter, const CanvasTransform& trans, const Rect& area, const std::string& text);
 
     CanvasTransform transform;
 
@@ -473,22 +727,94 @@ public:
         return trans;
     }
 
+    // the view snapped to the tiles, what the frame is drawn with and so what the mouse is tested against
+    CanvasTransform get_view_transform() const
+    {
+        return get_tiled_transform(get_current_transform());
+    }
+
     glm::ivec2 get_position(wxMouseEvent& e)
     {
         return { e.GetX(), e.GetY() };
     }
 
-    std::unordered_set<Id> get_hit(const CanvasTransform& t, const glm::vec2& p, float x)
+    Rect get_selection_rect() const
+    {
+        return Rect::from_points(mouse0, latest_mouse);
+    }
+
+    bool is_selection_positive() const
+    {
+        return mouse0.x < latest_mouse.x;
+    }
+
+    // a click without a drag picks the shape on top, a drag selects with the box
+    bool is_click() const
+    {
+        return mouse0 == latest_mouse;
+    }
+
+    // while dragging the shapes are drawn moved by the mouse, and only moved in the document on release
+    CanvasTransform get_drag_transform(const CanvasTransform& trans) const
+    {
+        auto moved = trans;
+        moved.scroll += glm::vec2{ latest_mouse - mouse0 };
+        return moved;
+    }
+
+    // the dragged shapes are hidden from the static layer and drawn in the overlay instead
+    void start_drag()
+    {
+        mouse = MouseState::drag;
+        dragged = selection;
+        dragged.sort();
+        drag_bounds.reset();
+        for (const auto id : dragged)
+        {
+            if (const auto bounds = document.get_bounds(id))
+            {
+                include(&drag_bounds, *bounds);
+            }
+        }
+        if (drag_bounds)
+        {
+            tile_cache.invalidate(*drag_bounds);
+        }
+        static_state.reset();
+        hovers.clear();
+    }
+
+    void end_drag()
     {
-        std::unordered_set<Id> ret;
-        for (auto& shape : shapes)
+        if (is_click())
         {
-            if (shape.second->is_hit(t, p, x))
+            // the shapes didn't move, they only need to be shown again
+            get_topmost_hit(mouse0, &selection);
+            if (drag_bounds)
             {
-                ret.insert(shape.first);
+                tile_cache.invalidate(*drag_bounds);
             }
+            static_state.reset();
+        }
+        else
+        {
+            // one move for the whole selection, the tiles are updated from the change log
+            const auto delta = glm::vec2{ latest_mouse - mouse0 } / get_view_transform().scale;
+            history.move(&document, std::vector<Id>(dragged.begin(), dragged.end()), delta);
+        }
+        mouse = MouseState::none;
+        dragged.clear();
+        drag_bounds.reset();
+    }
+
+    // replaces ids with the shape under the mouse that a click would pick
+    void get_topmost_hit(const glm::vec2& m, IdSet* ids) const
+    {
+        ids->clear();
+        if (const auto hit = document.get_topmost_hit(get_view_transform(), m, 10.0f))
+        {
+            ids->insert(*hit);
         }
-        return ret;
     }
 
     void mouseMoved(wxMouseEvent& event);
@@ -504,9 +830,36 @@ public:
 	DECLARE_EVENT_TABLE();
 
     Settings settings;
-    IdGenerator ids;
-    std::unordered_set<Id> hovers;
-    std::unordered_map<Id, std::shared_ptr<Shape>> shapes;
+    Document document;
+    // reused for every mouse move so updating them doesn't allocate
+    IdSet hovers;
+    IdSet selection;
+    History history;
+
+    // the selection when the drag started, in paint order
+    IdSet dragged;
+    std::optional<Rect> drag_bounds;
+
+#if defined(VECY_PROFILER)
+    // frame time percentiles and the cost of each zone, under the stats
+    bool show_profiler = false;
+#endif
+
+    RenderStats stats;
+
+    // reused between frames to avoid allocating
+    RenderCache render_cache;
+    DrawCommandList commands;
+    StyleCache style_cache;
+    BackBuffer back_buffer;
+    BackBuffer static_layer;
+    std::optional<StaticLayerState> static_state;
+    TileCache<wxBitmap> tile_cache;
+    OverlayBounds last_overlay;
+    std::vector<Rect> dirty_rects;
+
+    FrameScheduler scheduler;
+    wxTimer frame_timer;
 };
 
 BEGIN_EVENT_TABLE(CanvasWidget, wxControl)
@@ -527,6 +880,7 @@ BEGIN_EVENT_TABLE(CanvasWidget, wxControl)
     EVT_MOUSEWHEEL(CanvasWidget::mouseWheelMoved)
 
     EVT_ERASE_BACKGROUND(CanvasWidget::on_erase_background)
+    EVT_TIMER(wxID_ANY, CanvasWidget::on_frame_timer)
 END_EVENT_TABLE()
 
 void CanvasWidget::mouseMoved(wxMouseEvent& e)
@@ -536,18 +890,22 @@ void CanvasWidget::mouseMoved(wxMouseEvent& e)
     switch (mouse)
     {
     case MouseState::none:
-        hovers = get_hit(get_current_transform(), m, 10.0f);
+        get_topmost_hit(m, &hovers);
         break;
     case MouseState::middle:
         mouse_movement = m - mouse0;
         latest_mouse = m;
         break;
     case MouseState::left:
+        latest_mouse = m;
+        document.get_selection(get_view_transform(), get_selection_rect(), is_selection_positive(), &hovers);
+        break;
+    case MouseState::drag:
         latest_mouse = m;
         break;
     }
 
-    paint_now();
+    request_frame();
 }
 
 void CanvasWidget::mouseDown(wxMouseEvent& e)
@@ -564,13 +922,24 @@ void CanvasWidget::mouseDown(wxMouseEvent& e)
         mouse = MouseState::left;
         mouse0 = m;
         latest_mouse = m;
-        paint_now();
+
+        // pressing on a shape drags the selection, or only the shape if it isn't selected
+        if (const auto hit = document.get_topmost_hit(get_view_transform(), m, 10.0f))
+        {
+            if (selection.contains(*hit) == false)
+            {
+                selection.clear();
+                selection.insert(*hit);
+            }
+            start_drag();
+        }
+        request_frame();
     }
     else if (e.GetButton() == wxMOUSE_BTN_MIDDLE)
     {
         mouse = MouseState::middle;
         mouse0 = m;
-        paint_now();
+        request_frame();
     }
 }
 
@@ -578,7 +947,7 @@ void CanvasWidget::mouseWheelMoved(wxMouseEvent& e)
 {
     const auto p = get_position(e);
     transform.zoom(p, (e.GetWheelRotation() * e.GetWheelDelta()) / 240.f);
-    paint_now();
+    request_frame();
 }
 
 void CanvasWidget::mouseReleased(wxMouseEvent& e)
@@ -588,14 +957,28 @@ void CanvasWidget::mouseReleased(wxMouseEvent& e)
     case MouseState::left:
         if (e.GetButton() != wxMOUSE_BTN_LEFT) { return; }
         mouse = MouseState::none;
-        paint_now();
+        if (is_click())
+        {
+            get_topmost_hit(mouse0, &selection);
+        }
+        else
+        {
+            document.get_selection(get_view_transform(), get_selection_rect(), is_selection_positive(), &selection);
+        }
+        hovers.clear();
+        request_frame();
+        break;
+    case MouseState::drag:
+        if (e.GetButton() != wxMOUSE_BTN_LEFT) { return; }
+        end_drag();
+        request_frame();
         break;
     case MouseState::middle:
         if (e.GetButton() != wxMOUSE_BTN_MIDDLE) { return; }
         mouse = MouseState::none;
         transform.scroll += mouse_movement;
         mouse_movement = { 0,0 };
-        paint_now();
+        request_frame();
         break;
     }
 }
@@ -603,96 +986,279 @@ void CanvasWidget::mouseLeftWindow(wxMouseEvent&) {}
 void CanvasWidget::keyPressed(wxKeyEvent&) {}
 void CanvasWidget::keyReleased(wxKeyEvent&) {}
 
+void CanvasWidget::request_frame()
+{
+    if (scheduler.request())
+    {
+        frame_timer.StartOnce(scheduler.get_wait_ms(FrameScheduler::clock::now()));
+    }
+}
+
+void CanvasWidget::on_frame_timer(wxTimerEvent&)
+{
+    if (scheduler.is_pending)
+    {
+        paint_now();
+    }
+}
+
 void CanvasWidget::paint_now()
 {
+    VECY_PROFILE_SCOPE("paint_now");
     wxClientDC dc(this);
-    wxGraphicsContext* gc = wxGraphicsContext::Create(dc);
-    render(Painter{&dc, gc});
-    delete gc;
+    present(dc, false);
 }
 
 void CanvasWidget::OnPaint(wxPaintEvent&)
 {
+    VECY_PROFILE_SCOPE("OnPaint");
+
+    // the window may have been damaged anywhere so copy all of the back buffer
     wxPaintDC dc(this);
-    wxGraphicsContext* gc = wxGraphicsContext::Create(dc);
-    render(Painter{&dc, gc});
-    delete gc;
+    present(dc, true);
+}
+
+double get_ms_since(const std::chrono::steady_clock::time_point& start, const std::chrono::steady_clock::time_point& end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
 }
 
-void CanvasWidget::render(Painter& dc)
+void CanvasWidget::present(wxDC& dc, bool redraw_window)
 {
-    dc.clear(settings.background_color);
+    using clock = std::chrono::steady_clock;
+    VECY_PROFILE_SCOPE("frame");
 
-    const auto trans = get_current_transform();
+    const auto setup_start = clock::now();
+    scheduler.on_frame(setup_start);
+
+    wxCoord width = 0;
+    wxCoord height = 0;
+    GetClientSize(&width, &height);
+    const auto size = glm::ivec2{ width, height };
+    if (back_buffer.ensure_size(size) == false || static_layer.ensure_size(size) == false)
+    {
+        return;
+    }
 
-    // draw grid
-    const float grid_size = 25.0f;
+    // the whole frame uses the view snapped to the tiles so the overlay lines up with the shapes
+    const auto trans = get_view_transform();
+    const auto text = get_overlay_text();
+    const auto overlay = get_overlay_bounds(trans, text);
+
+    // the static layer is only redrawn when the view or the document has changed,
+    // otherwise only the parts of the overlay that changed are restored from it and redrawn
+    const auto state = StaticLayerState{ trans.scroll, trans.scale, size, document.version };
+    const bool redraw_static = !(static_state && *static_state == state);
+    dirty_rects.clear();
+    if (redraw_static)
     {
-        wxCoord width = 0;
-        wxCoord height = 0;
-        GetClientSize(&width, &height);
+        dirty_rects.push_back(Rect{ {0, 0}, size });
+    }
+    else
+    {
+        add_dirty_rects(&dirty_rects, last_overlay, overlay);
+    }
 
-        const auto size = glm::ivec2{ width, height };
+    PainterStats static_stats;
+    WxPainter painter{&back_buffer.dc, back_buffer.graphics.get(), &commands, &style_cache};
 
-        const float scaled_grid_size = grid_size * trans.scale;
+    const auto render_start = clock::now();
+    if (redraw_static)
+    {
+        VECY_PROFILE_SCOPE("static layer");
+        static_stats = render_static(trans, size);
+        static_state = state;
+    }
 
-        Outline grid_line = { settings.grid_color, 1, LineStyle::solid };
+    int redrawn_area = 0;
+    for (const auto& r : dirty_rects)
+    {
+        const auto pixels = to_wx_pixels(r, size);
+        if (pixels.width <= 0 || pixels.height <= 0) { continue; }
+        redrawn_area += pixels.width * pixels.height;
+
+        VECY_PROFILE_SCOPE("overlay");
+        back_buffer.dc.Blit(pixels.x, pixels.y, pixels.width, pixels.height, &static_layer.dc, pixels.x, pixels.y);
+        painter.set_clip(Rect{ {pixels.x, pixels.y}, {pixels.width, pixels.height} });
+        render_overlay(&painter, trans, Rect{ {pixels.x, pixels.y}, {pixels.width, pixels.height} }, text);
+        painter.reset_clip();
+    }
+    {
+        VECY_PROFILE_SCOPE("flush");
+        back_buffer.graphics->Flush();
+    }
+    last_overlay = overlay;
 
-        for (float x = fmodf(trans.scroll.x, scaled_grid_size); x < size.x; x += scaled_grid_size)
+    VECY_PROFILE_SCOPE("present");
+    const auto present_start = clock::now();
+    if (redraw_window)
+    {
+        dc.Blit(0, 0, width, height, &back_buffer.dc, 0, 0);
+    }
+    else
+    {
+        for (const auto& r : dirty_rects)
         {
-            dc.draw_line
-            (
-                glm::vec2(x, 0.0f),
-                glm::vec2(x, size.y),
-                grid_line
-            );
+            const auto pixels = to_wx_pixels(r, size);
+            if (pixels.width <= 0 || pixels.height <= 0) { continue; }
+            dc.Blit(pixels.x, pixels.y, pixels.width, pixels.height, &back_buffer.dc, pixels.x, pixels.y);
         }
+    }
+    const auto present_end = clock::now();
+
+    stats.painter = static_stats + painter.stats;
+    stats.redrawn_fraction = static_cast<float>(redrawn_area) / static_cast<float>(width * height);
+    stats.timing.setup_ms = get_ms_since(setup_start, render_start);
+    stats.timing.render_ms = get_ms_since(render_start, present_start);
+    stats.timing.present_ms = get_ms_since(present_start, present_end);
+    stats.scratch = render_cache.get_stats();
+    stats.scratch_peak_bytes = std::max(stats.scratch_peak_bytes, stats.scratch.live_bytes);
+}
 
-        for (float y = fmodf(trans.scroll.y, scaled_grid_size); y < size.y; y += scaled_grid_size)
+OverlayBounds CanvasWidget::get_overlay_bounds(const CanvasTransform& trans, const std::string& text)
+{
+    OverlayBounds bounds;
+
+    // a few extra pixels for anti aliasing and pen width
+    constexpr float margin = 2.0f;
+
+    const auto include_handles = [&](const Id& id)
+    {
+        const auto shape_bounds = document.get_bounds(id);
+        if (shape_bounds.has_value() == false) { return; }
+
+        const auto r = from_world_to_screen(trans, *shape_bounds).extend(settings.handle_radius + margin);
+        include(&bounds.handles, r);
+    };
+    if (mouse == MouseState::drag)
+    {
+        // the handles aren't drawn while dragging
+        if (drag_bounds)
+        {
+            bounds.dragged = from_world_to_screen(get_drag_transform(trans), *drag_bounds).extend(margin);
+        }
+    }
+    else
+    {
+        for (const auto& id : selection)
+        {
+            include_handles(id);
+        }
+        for (const auto& id : hovers)
         {
-            dc.draw_line
-            (
-                glm::vec2(0.0f, y),
-                glm::vec2(size.x, y),
-                grid_line
-            );
+            include_handles(id);
         }
     }
 
-    // draw all shapes
-    for (auto& shape : shapes)
+    if (mouse == MouseState::left)
+    {
+        bounds.selection_box = get_selection_rect().extend(margin);
+    }
+
+    wxCoord text_width = 0;
+    wxCoord text_height = 0;
+    back_buffer.dc.GetMultiLineTextExtent(wxString::FromUTF8(text.c_str()), &text_width, &text_height);
+    bounds.text = Rect{ {0, 0}, {text_width + margin, text_height + margin} };
+
+    return bounds;
+}
+
+std::string CanvasWidget::get_overlay_text() const
+{
+    const auto text = wxString::Format
+    (
+        "scale: %f drawn: %d culled: %d lod in drawn tiles: %d merged into %d state changes: %d (unbatched %d) style cache: %d hits %d misses tiles: %.1f%% hits %d drawn %zu KiB setup: %.3fms render: %.3fms present: %.3fms events: %llu frames: %llu redrawn: %.1f%% scratch: %zu KiB reserved %zu KiB live %zu KiB peak",
+        transform.scale, stats.drawn, stats.culled, stats.lod_merged, stats.lod_primitives,
+        stats.painter.state_changes, stats.painter.unbatched_state_changes,
+        style_cache.hits, style_cache.misses,
+        tile_cache.stats.get_hit_rate() * 100.0f, stats.tiles_drawn, tile_cache.get_resident_bytes() / 1024,
+        stats.timing.setup_ms, stats.timing.render_ms, stats.timing.present_ms,
+        static_cast<unsigned long long>(scheduler.events_received),
+        static_cast<unsigned long long>(scheduler.frames_rendered),
+        stats.redrawn_fraction * 100.0f,
+        stats.scratch.reserved_bytes / 1024, stats.scratch.live_bytes / 1024, stats.scratch_peak_bytes / 1024
+    );
+#if defined(VECY_PROFILER)
+    if (show_profiler)
     {
-        shape.second->paint(&dc, trans, settings);
+        // the last couple of seconds
+        return text.ToStdString() + "\n" + to_string(get_profile_report(120));
     }
+#endif
+    return text.ToStdString();
+}
 
-    // draw selection outline
-    for (const auto& id : hovers)
+PainterStats CanvasWidget::render_static(const CanvasTransform& trans, const glm::ivec2& size)
+{
+    tile_cache.sync(document);
+
+    // the counts are for the whole view, a shape over several tiles is still one shape
+    const auto* hidden = dragged.empty() ? nullptr : &dragged;
+    const auto shape_stats = count_shapes(document, trans, size, hidden);
+    stats.drawn = shape_stats.drawn;
+    stats.culled = shape_stats.culled;
+    stats.lod_merged = 0;
+    stats.lod_primitives = 0;
+    stats.tiles_drawn = 0;
+
+    PainterStats painter_stats;
+    for_each_visible_tile(trans, size, tile_cache.tile_size, [&](const TileKey& key, const glm::ivec2& p)
     {
-        auto found = shapes.find(id);
-        if (found == shapes.end()) { assert(false); continue; }
+        const auto& tile = tile_cache.get(key, [&](wxBitmap* bitmap, const TileKey& k)
+        {
+            painter_stats = painter_stats + render_tile(bitmap, k);
+        });
+        static_layer.dc.DrawBitmap(tile, p.x, p.y);
+    });
+    return painter_stats;
+}
 
-        found->second->paint_selected(&dc, trans, settings);
+PainterStats CanvasWidget::render_tile(wxBitmap* tile, const TileKey& key)
+{
+    const int tile_size = tile_cache.tile_size;
+    if (tile->IsOk() == false || tile->GetWidth() != tile_size || tile->GetHeight() != tile_size)
+    {
+        *tile = wxBitmap{ tile_size, tile_size };
     }
 
-    // draw selection box
-    if (mouse == MouseState::left)
+    VECY_PROFILE_SCOPE("tile");
+    wxMemoryDC dc{ *tile };
+    PainterStats painter_stats;
+    {
+        std::unique_ptr<wxGraphicsContext> graphics{ wxGraphicsContext::Create(dc) };
+        WxPainter painter{ &dc, graphics.get(), &commands, &style_cache };
+        const auto* hidden = dragged.empty() ? nullptr : &dragged;
+        const auto shape_stats = render_scene(&painter, &document, settings, get_tile_transform(key, tile_size), { tile_size, tile_size }, &render_cache, hidden);
+        painter.flush();
+        graphics->Flush();
+
+        painter_stats = painter.stats;
+        stats.lod_merged += shape_stats.lod_merged;
+        stats.lod_primitives += shape_stats.lod_primitives;
+        stats.tiles_drawn += 1;
+    }
+    dc.SelectObject(wxNullBitmap);
+    return painter_stats;
+}
+
+void CanvasWidget::render_overlay(Painter* dc, const CanvasTransform& trans, const Rect& area, const std::string& text)
+{
+    if (mouse == MouseState::drag)
+    {
+        // the shapes aren't moved until the drag ends, only the transform they are drawn with
+        render_shape_set(dc, document, settings, get_drag_transform(trans), back_buffer.size, area, dragged, &render_cache);
+    }
+    else
     {
-        auto r = Rect{ mouse0, {0, 0} };
-        r.include(latest_mouse);
+        render_handles(dc, document, settings, trans, back_buffer.size, selection, hovers, &render_cache);
+    }
 
-        const bool is_positive = mouse0.x < latest_mouse.x;
-        const auto selection_fill = is_positive ? settings.selection_fill_positive : settings.selection_fill_negative;
-        const auto selection_border = is_positive ? settings.selection_border_positive : settings.selection_border_negative;
-        dc.draw_rectangle
-        (
-            r,
-            get_or_not(selection_fill, settings.draw_selection_fill),
-            get_or_not(selection_border, settings.draw_selection_border)
-        );
+    if (mouse == MouseState::left)
+    {
+        render_selection_box(dc, settings, get_selection_rect(), is_selection_positive());
     }
 
-    const auto str = wxString::Format("scale: %f", transform.scale);
-    dc.draw_text(str, {0, 0}, open_color::white);
+    dc->draw_text(text, {0, 0}, open_color::white);
 }
 
 class MyFrame: public wxFrame
@@ -701,26 +1267,188 @@ public:
     MyFrame(const wxString& title, const wxPoint& pos, const wxSize& size);
 private:
     void OnHello(wxCommandEvent& event);
+    void OnOpen(wxCommandEvent& event);
+    void OnSave(wxCommandEvent& event);
+    void OnUndo(wxCommandEvent& event);
+    void OnRedo(wxCommandEvent& event);
+    void OnDelete(wxCommandEvent& event);
+#if defined(VECY_PROFILER)
+    void OnShowProfiler(wxCommandEvent& event);
+    void OnSaveTrace(wxCommandEvent& event);
+#endif
+    void OnImportSvg(wxCommandEvent& event);
+    void OnExportSvg(wxCommandEvent& event);
     void OnExit(wxCommandEvent& event);
     void OnAbout(wxCommandEvent& event);
     wxDECLARE_EVENT_TABLE();
+
+    CanvasWidget* canvas = nullptr;
 };
 
 
 enum
 {
-    ID_Hello = 1
+    ID_Hello = 1,
+    ID_ImportSvg,
+    ID_ExportSvg,
+    ID_ShowProfiler,
+    ID_SaveTrace
 };
 
 
 wxBEGIN_EVENT_TABLE(MyFrame, wxFrame)
     EVT_MENU(ID_Hello,   MyFrame::OnHello)
+    EVT_MENU(wxID_OPEN,  MyFrame::OnOpen)
+    EVT_MENU(wxID_SAVE,  MyFrame::OnSave)
+    EVT_MENU(wxID_UNDO,  MyFrame::OnUndo)
+    EVT_MENU(wxID_REDO,  MyFrame::OnRedo)
+    EVT_MENU(wxID_DELETE, MyFrame::OnDelete)
+#if defined(VECY_PROFILER)
+    EVT_MENU(ID_ShowProfiler, MyFrame::OnShowProfiler)
+    EVT_MENU(ID_SaveTrace, MyFrame::OnSaveTrace)
+#endif
+    EVT_MENU(ID_ImportSvg, MyFrame::OnImportSvg)
+    EVT_MENU(ID_ExportSvg, MyFrame::OnExportSvg)
     EVT_MENU(wxID_EXIT,  MyFrame::OnExit)
     EVT_MENU(wxID_ABOUT, MyFrame::OnAbout)
 wxEND_EVENT_TABLE()
 
 
-wxIMPLEMENT_APP(MyApp);
+wxIMPLEMENT_APP_NO_MAIN(MyApp);
+
+
+// rendering the document to an image file without opening a window
+struct HeadlessOptions
+{
+    std::string output;
+
+    // the example shapes are drawn if there is no document
+    std::string document;
+    int width = 800;
+    int height = 600;
+    float scale = 1.0f;
+
+    // 0 uses all hardware threads
+    int threads = 0;
+
+    // where to write the profiler zones as a chrome trace, needs VECY_PROFILER
+    std::string trace;
+};
+
+// returns nothing if the app should start as usual
+std::optional<HeadlessOptions> parse_headless_options(int argc, char** argv)
+{
+    std::optional<HeadlessOptions> options;
+    HeadlessOptions parsed;
+    for (int i = 1; i + 1 < argc; i += 1)
+    {
+        const char* name = argv[i];
+        const char* value = argv[i + 1];
+        if (std::strcmp(name, "--render") == 0) { parsed.output = value; options = parsed; }
+        else if (std::strcmp(name, "--width") == 0) { parsed.width = std::atoi(value); }
+        else if (std::strcmp(name, "--height") == 0) { parsed.height = std::atoi(value); }
+        else if (std::strcmp(name, "--scale") == 0) { parsed.scale = static_cast<float>(std::atof(value)); }
+        else if (std::strcmp(name, "--threads") == 0) { parsed.threads = std::atoi(value); }
+        else if (std::strcmp(name, "--document") == 0) { parsed.document = value; }
+        else if (std::strcmp(name, "--trace") == 0) { parsed.trace = value; }
+        else { continue; }
+        i += 1;
+    }
+
+    if (options)
+    {
+        options->width = parsed.width;
+        options->height = parsed.height;
+        options->scale = parsed.scale;
+        options->threads = parsed.threads;
+        options->document = parsed.document;
+        options->trace = parsed.trace;
+    }
+    return options;
+}
+
+int render_headless(const HeadlessOptions& options)
+{
+    using clock = std::chrono::steady_clock;
+
+    if (options.width <= 0 || options.height <= 0 || options.scale <= 0.0f)
+    {
+        std::fprintf(stderr, "invalid size or scale\n");
+        return 1;
+    }
+
+    Document document;
+    if (options.document.empty())
+    {
+        add_example_shapes(&document);
+    }
+    else if (load_document(&document, options.document) == false)
+    {
+        std::fprintf(stderr, "failed to open %s\n", options.document.c_str());
+        return 1;
+    }
+
+    Settings settings;
+    CanvasTransform trans;
+    trans.scale = options.scale;
+    const auto size = glm::ivec2{ options.width, options.height };
+
+    Image image{ size.x, size.y };
+    RenderCache cache;
+    DrawCommandList commands;
+    RecordingPainter recorder{ &commands };
+    ThreadPool pool{ options.threads > 0 ? options.threads : get_hardware_thread_count() };
+    TiledRasterizer rasterizer;
+
+    // record the frame and rasterize it on all threads
+    const auto render_start = clock::now();
+    const auto shape_stats = [&]()
+    {
+        VECY_PROFILE_SCOPE("frame");
+        const auto recorded = render_scene(&recorder, &document, settings, trans, size, &cache);
+        rasterizer.render(commands, &image, &pool);
+        return recorded;
+    }();
+    const auto render_end = clock::now();
+
+    if (save_image(image, options.output) == false)
+    {
+        std::fprintf(stderr, "failed to write %s\n", options.output.c_str());
+        return 1;
+    }
+
+    std::printf
+    (
+        "%s: %dx%d drawn: %d culled: %d lod: %d merged into %d primitives: %d threads: %d render: %.3fms\n",
+        options.output.c_str(), size.x, size.y, shape_stats.drawn, shape_stats.culled, shape_stats.lod_merged, shape_stats.lod_primitives, recorder.stats.primitives, pool.get_thread_count(),
+        std::chrono::duration<double, std::milli>(render_end - render_start).count()
+    );
+
+    if (options.trace.empty() == false)
+    {
+#if defined(VECY_PROFILER)
+        if (write_chrome_trace(options.trace) == false)
+        {
+            std::fprintf(stderr, "failed to write %s\n", options.trace.c_str());
+            return 1;
+        }
+#else
+        std::fprintf(stderr, "--trace needs a build with VECY_PROFILER\n");
+#endif
+    }
+    return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+    if (const auto options = parse_headless_options(argc, argv))
+    {
+        return render_headless(*options);
+    }
+
+    return wxEntry(argc, argv);
+}
 
 
 bool MyApp::OnInit()
@@ -737,19 +1465,37 @@ MyFrame::MyFrame(const wxString& title, const wxPoint& pos, const wxSize& size)
     wxMenu *menuFile = new wxMenu;
     menuFile->Append(ID_Hello, "&Hello...\tCtrl-H",
                      "Help string shown in status bar for this menu item");
+    menuFile->Append(wxID_OPEN);
+    menuFile->Append(wxID_SAVE);
+    menuFile->Append(ID_ImportSvg, "&Import SVG...");
+    menuFile->Append(ID_ExportSvg, "&Export SVG...");
     menuFile->AppendSeparator();
     menuFile->Append(wxID_EXIT);
+    wxMenu *menuEdit = new wxMenu;
+    menuEdit->Append(wxID_UNDO);
+    menuEdit->Append(wxID_REDO);
+    menuEdit->AppendSeparator();
+    menuEdit->Append(wxID_DELETE);
+#if defined(VECY_PROFILER)
+    wxMenu *menuView = new wxMenu;
+    menuView->AppendCheckItem(ID_ShowProfiler, "&Profiler overlay\tF3");
+    menuView->Append(ID_SaveTrace, "Save profiler &trace...");
+#endif
     wxMenu *menuHelp = new wxMenu;
     menuHelp->Append(wxID_ABOUT);
     wxMenuBar *menuBar = new wxMenuBar;
     menuBar->Append( menuFile, "&File" );
+    menuBar->Append( menuEdit, "&Edit" );
+#if defined(VECY_PROFILER)
+    menuBar->Append( menuView, "&View" );
+#endif
     menuBar->Append( menuHelp, "&Help" );
     SetMenuBar( menuBar );
     // CreateStatusBar();
     // SetStatusText( "Welcome to wxWidgets!" );
 
     wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
-    CanvasWidget* canvas = new CanvasWidget(this, wxID_ANY);
+    canvas = new CanvasWidget(this, wxID_ANY);
     sizer->Add(canvas, 1, wxEXPAND);
     SetSizer(sizer);
     SetAutoLayout(true);
@@ -773,3 +1519,111 @@ void MyFrame::OnHello(wxCommandEvent& event)
 {
     wxLogMessage("Hello world from wxWidgets!");
 }
+
+
+void MyFrame::OnOpen(wxCommandEvent& event)
+{
+    wxFileDialog dialog(this, "Open document", "", "", "vecy documents (*.vecy)|*.vecy", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+    if (dialog.ShowModal() == wxID_CANCEL)
+    {
+        return;
+    }
+
+    if (canvas->open(dialog.GetPath().ToStdString()) == false)
+    {
+        wxLogError("Failed to open %s", dialog.GetPath());
+    }
+}
+
+
+void MyFrame::OnSave(wxCommandEvent& event)
+{
+    wxFileDialog dialog(this, "Save document", "", "", "vecy documents (*.vecy)|*.vecy", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (dialog.ShowModal() == wxID_CANCEL)
+    {
+        return;
+    }
+
+    if (canvas->save(dialog.GetPath().ToStdString()) == false)
+    {
+        wxLogError("Failed to save %s", dialog.GetPath());
+    }
+}
+
+
+void MyFrame::OnUndo(wxCommandEvent& event)
+{
+    canvas->undo();
+}
+
+
+void MyFrame::OnRedo(wxCommandEvent& event)
+{
+    canvas->redo();
+}
+
+
+void MyFrame::OnDelete(wxCommandEvent& event)
+{
+    canvas->remove_selection();
+}
+
+
+#if defined(VECY_PROFILER)
+void MyFrame::OnShowProfiler(wxCommandEvent& event)
+{
+    canvas->set_show_profiler(event.IsChecked());
+}
+
+
+void MyFrame::OnSaveTrace(wxCommandEvent& event)
+{
+    wxFileDialog dialog(this, "Save profiler trace", "", "vecy_trace.json", "Chrome trace (*.json)|*.json", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (dialog.ShowModal() == wxID_CANCEL)
+    {
+        return;
+    }
+
+    if (write_chrome_trace(dialog.GetPath().ToStdString()) == false)
+    {
+        wxLogError("Failed to save %s", dialog.GetPath());
+    }
+}
+#endif
+
+
+void MyFrame::OnImportSvg(wxCommandEvent& event)
+{
+    wxFileDialog dialog(this, "Import SVG", "", "", "SVG files (*.svg)|*.svg", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+    if (dialog.ShowModal() == wxID_CANCEL)
+    {
+        return;
+    }
+
+    const auto stats = canvas->import_svg_file(dialog.GetPath().ToStdString());
+    if (stats.ok == false)
+    {
+        wxLogError("Failed to import %s", dialog.GetPath());
+    }
+    else if (stats.skipped > 0 || stats.strokes_dropped > 0)
+    {
+        wxLogMessage("Imported %llu rectangles and %llu paths, skipped %llu shapes and dropped %llu strokes",
+            static_cast<unsigned long long>(stats.rectangles), static_cast<unsigned long long>(stats.paths),
+            static_cast<unsigned long long>(stats.skipped), static_cast<unsigned long long>(stats.strokes_dropped));
+    }
+}
+
+
+void MyFrame::OnExportSvg(wxCommandEvent& event)
+{
+    wxFileDialog dialog(this, "Export SVG", "", "", "SVG files (*.svg)|*.svg", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (dialog.ShowModal() == wxID_CANCEL)
+    {
+        return;
+    }
+
+    if (canvas->export_svg_file(dialog.GetPath().ToStdString()) == false)
+    {
+        wxLogError("Failed to export %s", dialog.GetPath());
+    }
+}
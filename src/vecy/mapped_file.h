@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#include "vecy/types.h"
+
+// A whole file mapped read only into memory, the pages are loaded by the os when touched.
+struct MappedFile
+{
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    void operator=(const MappedFile&) = delete;
+
+    // returns false if the file couldn't be opened or is empty
+    bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] const u8* get_data() const
+    {
+        return data;
+    }
+
+    [[nodiscard]] std::size_t get_size() const
+    {
+        return size;
+    }
+
+private:
+    const u8* data = nullptr;
+    std::size_t size = 0;
+
+#if defined(_WIN32)
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
@@ -0,0 +1,190 @@
+#include "vecy/painter.h"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+void sort_batches(DrawCommandList* list)
+{
+    auto& commands = list->commands;
+    const auto& batches = list->batches;
+
+    for (std::size_t batch_index = 0; batch_index < batches.size(); batch_index += 1)
+    {
+        const auto& batch = batches[batch_index];
+        if (batch.order != BatchOrder::any)
+        {
+            continue;
+        }
+
+        const auto end = batch_index + 1 < batches.size() ? batches[batch_index + 1].first : commands.size();
+        std::stable_sort(commands.begin() + batch.first, commands.begin() + end, [](const DrawCommand& lhs, const DrawCommand& rhs)
+        {
+            const auto lhs_pen = get_state_key(lhs.outline);
+            const auto rhs_pen = get_state_key(rhs.outline);
+            if (lhs.alpha != rhs.alpha) { return lhs.alpha < rhs.alpha; }
+            if (lhs_pen != rhs_pen) { return lhs_pen < rhs_pen; }
+            return get_state_key(lhs.fill) < get_state_key(rhs.fill);
+        });
+    }
+}
+
+DrawCommand DrawCommandList::add_path(const PathView& path, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    const auto first_point = static_cast<u32>(path_points.size());
+    const auto point_count = path.contour_count > 0 ? path.contours[path.contour_count - 1].end : 0;
+    path_points.insert(path_points.end(), path.points, path.points + point_count);
+    path_contours.insert(path_contours.end(), path.contours, path.contours + path.contour_count);
+
+    auto bounds = Rect{ point_count > 0 ? path.points[0] : glm::vec2{0, 0}, {0, 0} };
+    for (u32 i = 0; i < point_count; i += 1)
+    {
+        bounds.include(path.points[i]);
+    }
+
+    const auto index = static_cast<u32>(paths.size());
+    paths.push_back({ first_point, static_cast<u32>(path_contours.size() - path.contour_count), static_cast<u32>(path.contour_count) });
+    return { DrawCommandType::path, is_alpha(fill, outline), bounds.topleft, bounds.size, fill, outline, index };
+}
+
+RecordingPainter::RecordingPainter(DrawCommandList* c)
+    : commands(c)
+{
+}
+
+void RecordingPainter::clear(const Rgba& color)
+{
+    commands->commands.push_back({ DrawCommandType::clear, false, {0, 0}, {0, 0}, Fill{ color, FillStyle::solid }, std::nullopt });
+}
+
+void RecordingPainter::draw_text(const std::string&, const glm::vec2&, const Rgba&)
+{
+}
+
+void RecordingPainter::draw_rectangle(const Rect& r, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    if (r.size.x > 0 && r.size.y > 0)
+    {
+        stats.primitives += 1;
+        commands->commands.push_back({ DrawCommandType::rectangle, is_alpha(fill, outline), r.topleft, r.size, fill, outline });
+    }
+}
+
+void RecordingPainter::draw_circle(const glm::vec2& p, float radius, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    stats.primitives += 1;
+    commands->commands.push_back({ DrawCommandType::circle, is_alpha(fill, outline), p, {radius, radius}, fill, outline });
+}
+
+void RecordingPainter::draw_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline)
+{
+    stats.primitives += 1;
+    commands->commands.push_back({ DrawCommandType::line, is_alpha(outline.color), from, to, std::nullopt, outline });
+}
+
+void RecordingPainter::draw_path(const PathView& path, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    stats.primitives += 1;
+    commands->commands.push_back(commands->add_path(path, fill, outline));
+}
+
+void RecordingPainter::set_clip(const Rect&)
+{
+    // the commands would need to remember the clip to replay it
+    assert(false && "clipping is not recorded");
+}
+
+void RecordingPainter::reset_clip()
+{
+}
+
+void RecordingPainter::begin_batch(BatchOrder order)
+{
+    commands->batches.push_back({ commands->commands.size(), order });
+}
+
+void replay(Painter* painter, const DrawCommandList& list, const DrawCommand& c)
+{
+    switch (c.type)
+    {
+    case DrawCommandType::rectangle:
+        painter->draw_rectangle(Rect{ c.a, c.b }, c.fill, c.outline);
+        break;
+    case DrawCommandType::circle:
+        painter->draw_circle(c.a, c.b.x, c.fill, c.outline);
+        break;
+    case DrawCommandType::line:
+        painter->draw_line(c.a, c.b, *c.outline);
+        break;
+    case DrawCommandType::path:
+        painter->draw_path(list.get_path(c), c.fill, c.outline);
+        break;
+    case DrawCommandType::clear:
+        painter->clear(c.fill->color);
+        break;
+    }
+}
+
+void replay(Painter* painter, const DrawCommandList& list, const DrawCommand& c, const ReplayTransform& t, std::vector<glm::vec2>* points)
+{
+    auto fill = c.fill;
+    auto outline = c.outline;
+    if (t.color)
+    {
+        if (fill) { fill->color = *t.color; }
+        if (outline) { outline->color = *t.color; }
+    }
+    if (outline)
+    {
+        // a recorded outline was at least a pixel wide and stays that way
+        outline->width = std::max(1, static_cast<int>(std::lround(static_cast<float>(outline->width) * t.scale)));
+    }
+
+    switch (c.type)
+    {
+    case DrawCommandType::rectangle:
+        painter->draw_rectangle(Rect{ t.offset + c.a * t.scale, c.b * t.scale }, fill, outline);
+        break;
+    case DrawCommandType::circle:
+        painter->draw_circle(t.offset + c.a * t.scale, c.b.x * t.scale, fill, outline);
+        break;
+    case DrawCommandType::line:
+        painter->draw_line(t.offset + c.a * t.scale, t.offset + c.b * t.scale, *outline);
+        break;
+    case DrawCommandType::path:
+    {
+        const auto path = list.get_path(c);
+        const auto point_count = path.contour_count > 0 ? path.contours[path.contour_count - 1].end : 0;
+        points->resize(point_count);
+        for (u32 i = 0; i < point_count; i += 1)
+        {
+            (*points)[i] = t.offset + path.points[i] * t.scale;
+        }
+        painter->draw_path(PathView{ points->data(), path.contours, path.contour_count }, fill, outline);
+        break;
+    }
+    case DrawCommandType::clear:
+        painter->clear(fill->color);
+        break;
+    }
+}
+
+std::optional<Rect> get_bounds(const DrawCommand& c)
+{
+    // wide outlines and rounding may reach a bit outside of the geometry
+    const float margin = c.outline ? static_cast<float>(c.outline->width) + 1.0f : 1.0f;
+
+    switch (c.type)
+    {
+    case DrawCommandType::rectangle:
+    case DrawCommandType::path:
+        return Rect{ c.a, c.b }.extend(margin);
+    case DrawCommandType::circle:
+        return Rect{ c.a, {0, 0} }.extend(c.b.x + margin);
+    case DrawCommandType::line:
+        return Rect::from_points(c.a, c.b).extend(margin);
+    case DrawCommandType::clear:
+    default:
+        return std::nullopt;
+    }
+}
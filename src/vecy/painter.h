@@ -0,0 +1,187 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+
+#include "glm/vec2.hpp"
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/rgba.h"
+#include "vecy/style.h"
+#include "vecy/path.h"
+
+enum class DrawCommandType : u8
+{
+    rectangle, circle, line, path,
+
+    // fill everything with the fill color, only recorded by the recording painter
+    clear
+};
+
+struct DrawCommand
+{
+    DrawCommandType type;
+
+    // drawn with blending, the wx painter uses the graphics context for these
+    bool alpha;
+
+    // rectangle: topleft and size, circle: center and radius, line: from and to,
+    // path: topleft and size of the bounds
+    glm::vec2 a;
+    glm::vec2 b;
+
+    std::optional<Fill> fill;
+    std::optional<Outline> outline;
+
+    // path: the index in the paths of the list
+    u32 path = 0;
+};
+
+// where the points and contours of a recorded path are in the list
+struct RecordedPath
+{
+    u32 first_point;
+    u32 first_contour;
+    u32 contour_count;
+};
+
+// how the commands in a batch may be reordered when flushed
+enum class BatchOrder
+{
+    // the paint order matters, only commands next to each other share state
+    keep,
+
+    // the paint order doesn't matter, group the commands on backend and state
+    any
+};
+
+struct DrawCommandList
+{
+    struct Batch
+    {
+        std::size_t first;
+        BatchOrder order;
+    };
+
+    std::vector<DrawCommand> commands;
+    std::vector<Batch> batches;
+
+    // the paths are copied here since the commands are moved around when sorted
+    std::vector<RecordedPath> paths;
+    std::vector<glm::vec2> path_points;
+    std::vector<PathContour> path_contours;
+
+    void clear()
+    {
+        commands.clear();
+        batches.clear();
+        paths.clear();
+        path_points.clear();
+        path_contours.clear();
+    }
+
+    // copies the path and returns the command that draws it
+    DrawCommand add_path(const PathView& path, const std::optional<Fill>& fill, const std::optional<Outline>& outline);
+
+    [[nodiscard]] PathView get_path(const DrawCommand& c) const
+    {
+        const auto& p = paths[c.path];
+        return { path_points.data() + p.first_point, path_contours.data() + p.first_contour, p.contour_count };
+    }
+};
+
+// sort the commands of the batches that may be reordered on backend and state
+void sort_batches(DrawCommandList* list);
+
+struct PainterStats
+{
+    int primitives = 0;
+
+    // pen and brush changes made and how many there would be with one change per primitive
+    int state_changes = 0;
+    int unbatched_state_changes = 0;
+
+    PainterStats operator+(const PainterStats& rhs) const
+    {
+        return
+        {
+            primitives + rhs.primitives,
+            state_changes + rhs.state_changes,
+            unbatched_state_changes + rhs.unbatched_state_changes
+        };
+    }
+};
+
+// what the canvas renders through, implemented by the wx painter and the software rasterizer
+struct Painter
+{
+    PainterStats stats;
+
+    virtual ~Painter() = default;
+
+    virtual void clear(const Rgba& color) = 0;
+    virtual void draw_text(const std::string& str, const glm::vec2& p, const Rgba& color) = 0;
+    virtual void draw_rectangle(const Rect& r, const std::optional<Fill>& fill, const std::optional<Outline>& outline) = 0;
+    virtual void draw_circle(const glm::vec2& p, float radius, const std::optional<Fill>& fill, const std::optional<Outline>& outline) = 0;
+    virtual void draw_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline) = 0;
+
+    // the path is in screen space and the outline width in pixels
+    virtual void draw_path(const PathView& path, const std::optional<Fill>& fill, const std::optional<Outline>& outline) = 0;
+
+    // limit drawing to the whole pixels of the rect
+    virtual void set_clip(const Rect& r) = 0;
+    virtual void reset_clip() = 0;
+
+    // if the shapes smaller than a pixel should be merged per pixel before they are drawn, worth it when
+    // every primitive has a cost of its own. the rasterizer skips a shape that misses every pixel center
+    // faster than it can be merged
+    [[nodiscard]] virtual bool wants_lod() const { return false; }
+
+    // start a new batch, commands are only reordered within a batch
+    // painters that draw directly can ignore batches
+    virtual void begin_batch(BatchOrder) {}
+
+    // draw everything that has been recorded
+    virtual void flush() {}
+};
+
+// records the primitives so they can be drawn later by another painter, or split up and drawn on many threads.
+// Text and clipping are not recorded.
+struct RecordingPainter : Painter
+{
+    explicit RecordingPainter(DrawCommandList* commands);
+
+    void clear(const Rgba& color) override;
+    void draw_text(const std::string& str, const glm::vec2& p, const Rgba& color) override;
+    void draw_rectangle(const Rect& r, const std::optional<Fill>& fill, const std::optional<Outline>& outline) override;
+    void draw_circle(const glm::vec2& p, float radius, const std::optional<Fill>& fill, const std::optional<Outline>& outline) override;
+    void draw_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline) override;
+    void draw_path(const PathView& path, const std::optional<Fill>& fill, const std::optional<Outline>& outline) override;
+
+    void set_clip(const Rect& r) override;
+    void reset_clip() override;
+
+    void begin_batch(BatchOrder order) override;
+
+    DrawCommandList* commands;
+};
+
+// draw a recorded command from the list
+void replay(Painter* painter, const DrawCommandList& list, const DrawCommand& c);
+
+// where a recorded list is drawn again, a recorded point p is drawn at offset + p * scale.
+// the color replaces the colors of the fills and outlines when set
+struct ReplayTransform
+{
+    glm::vec2 offset;
+    float scale;
+    std::optional<Rgba> color;
+};
+
+// draw a recorded command moved and scaled, the points are scratch memory for paths
+void replay(Painter* painter, const DrawCommandList& list, const DrawCommand& c, const ReplayTransform& t, std::vector<glm::vec2>* points);
+
+// the screen area a command may touch, a clear touches everything and returns nothing
+std::optional<Rect> get_bounds(const DrawCommand& c);
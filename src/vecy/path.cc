@@ -0,0 +1,272 @@
+#include "vecy/path.h"
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+namespace
+{
+    // enough that a huge curve at a deep zoom doesn't take forever
+    constexpr int max_curve_segments = 1024;
+
+    float get_length(const glm::vec2& v)
+    {
+        return std::sqrt(v.x * v.x + v.y * v.y);
+    }
+
+    // the flattening error of n even steps is at most the largest second derivative over 8n^2
+    int get_segment_count(float max_second_derivative, float tolerance)
+    {
+        const float n = std::ceil(std::sqrt(max_second_derivative / (8.0f * tolerance)));
+        return std::clamp(static_cast<int>(n), 1, max_curve_segments);
+    }
+
+    struct Flattener
+    {
+        FlattenedPath* flattened;
+        float tolerance;
+
+        glm::vec2 current = { 0, 0 };
+        glm::vec2 start = { 0, 0 };
+        bool is_open = false;
+
+        void end_contour(bool closed)
+        {
+            if (is_open == false)
+            {
+                return;
+            }
+            is_open = false;
+
+            auto& points = flattened->points;
+            const u32 first = flattened->contours.empty() ? 0 : flattened->contours.back().end;
+            if (points.size() - first < 2)
+            {
+                // a lone move doesn't draw anything
+                points.resize(first);
+                return;
+            }
+            flattened->contours.push_back({ static_cast<u32>(points.size()), closed });
+        }
+
+        // a segment after a close without a move starts where the closed contour started
+        void ensure_open()
+        {
+            if (is_open == false)
+            {
+                flattened->points.push_back(start);
+                current = start;
+                is_open = true;
+            }
+        }
+
+        void move(const glm::vec2& p)
+        {
+            end_contour(false);
+            start = p;
+            current = p;
+            flattened->points.push_back(p);
+            is_open = true;
+        }
+
+        void line(const glm::vec2& p)
+        {
+            ensure_open();
+            flattened->points.push_back(p);
+            current = p;
+        }
+
+        void quad(const glm::vec2& c, const glm::vec2& p)
+        {
+            ensure_open();
+            const auto p0 = current;
+            const int n = get_segment_count(2.0f * get_length(p0 - 2.0f * c + p), tolerance);
+            for (int i = 1; i < n; i += 1)
+            {
+                const float t = static_cast<float>(i) / static_cast<float>(n);
+                const float u = 1.0f - t;
+                flattened->points.push_back(u * u * p0 + 2.0f * u * t * c + t * t * p);
+            }
+            flattened->points.push_back(p);
+            current = p;
+        }
+
+        void cubic(const glm::vec2& c1, const glm::vec2& c2, const glm::vec2& p)
+        {
+            ensure_open();
+            const auto p0 = current;
+            const float second = 6.0f * std::max(get_length(p0 - 2.0f * c1 + c2), get_length(c1 - 2.0f * c2 + p));
+            const int n = get_segment_count(second, tolerance);
+            for (int i = 1; i < n; i += 1)
+            {
+                const float t = static_cast<float>(i) / static_cast<float>(n);
+                const float u = 1.0f - t;
+                flattened->points.push_back(u * u * u * p0 + 3.0f * u * u * t * c1 + 3.0f * u * t * t * c2 + t * t * t * p);
+            }
+            flattened->points.push_back(p);
+            current = p;
+        }
+
+        void close()
+        {
+            end_contour(true);
+            current = start;
+        }
+    };
+
+    float get_distance_squared(const glm::vec2& a, const glm::vec2& b, const glm::vec2& p)
+    {
+        const auto ab = b - a;
+        const auto ap = p - a;
+        const float length_squared = ab.x * ab.x + ab.y * ab.y;
+        const float t = length_squared > 0.0f ? std::clamp((ap.x * ab.x + ap.y * ab.y) / length_squared, 0.0f, 1.0f) : 0.0f;
+        const auto d = ap - ab * t;
+        return d.x * d.x + d.y * d.y;
+    }
+}
+
+void PathGeometry::move_to(const glm::vec2& p)
+{
+    verbs.push_back(PathVerb::move);
+    points.push_back(p);
+}
+
+void PathGeometry::line_to(const glm::vec2& p)
+{
+    assert(verbs.empty() == false && "a path starts with a move");
+    verbs.push_back(PathVerb::line);
+    points.push_back(p);
+}
+
+void PathGeometry::quad_to(const glm::vec2& control, const glm::vec2& p)
+{
+    assert(verbs.empty() == false && "a path starts with a move");
+    verbs.push_back(PathVerb::quad);
+    points.push_back(control);
+    points.push_back(p);
+}
+
+void PathGeometry::cubic_to(const glm::vec2& control1, const glm::vec2& control2, const glm::vec2& p)
+{
+    assert(verbs.empty() == false && "a path starts with a move");
+    verbs.push_back(PathVerb::cubic);
+    points.push_back(control1);
+    points.push_back(control2);
+    points.push_back(p);
+}
+
+void PathGeometry::close()
+{
+    verbs.push_back(PathVerb::close);
+}
+
+void PathGeometry::translate(const glm::vec2& delta)
+{
+    for (auto& p : points)
+    {
+        p += delta;
+    }
+}
+
+Rect PathGeometry::get_bounds() const
+{
+    if (points.empty())
+    {
+        return { {0, 0}, {0, 0} };
+    }
+
+    auto r = Rect::from_points(points[0], points[0]);
+    for (const auto& p : points)
+    {
+        r.include(p);
+    }
+    return r;
+}
+
+void FlattenedPath::translate(const glm::vec2& delta)
+{
+    for (auto& p : points)
+    {
+        p += delta;
+    }
+}
+
+int get_flatten_level(float scale)
+{
+    assert(scale > 0.0f);
+    return static_cast<int>(std::ceil(std::log2(scale)));
+}
+
+float get_flatten_tolerance(int level)
+{
+    // the largest scale in the level moves the world the most on the screen
+    return flatten_pixel_tolerance / std::ldexp(1.0f, level);
+}
+
+void flatten_path(const PathGeometry& path, float tolerance, FlattenedPath* flattened)
+{
+    flattened->points.clear();
+    flattened->contours.clear();
+
+    Flattener f{ flattened, tolerance };
+    std::size_t next = 0;
+    for (const auto verb : path.verbs)
+    {
+        const auto* p = path.points.data() + next;
+        switch (verb)
+        {
+        case PathVerb::move: f.move(p[0]); next += 1; break;
+        case PathVerb::line: f.line(p[0]); next += 1; break;
+        case PathVerb::quad: f.quad(p[0], p[1]); next += 2; break;
+        case PathVerb::cubic: f.cubic(p[0], p[1], p[2]); next += 3; break;
+        case PathVerb::close: f.close(); break;
+        }
+    }
+    f.end_contour(false);
+}
+
+bool is_inside_path(const PathView& path, const glm::vec2& p)
+{
+    int winding = 0;
+    for (std::size_t contour = 0; contour < path.contour_count; contour += 1)
+    {
+        const auto first = path.get_start(contour);
+        const auto end = path.contours[contour].end;
+        for (u32 i = first; i < end; i += 1)
+        {
+            // the fill goes back to the start of the contour
+            const auto& a = path.points[i];
+            const auto& b = path.points[i + 1 < end ? i + 1 : first];
+            const float side = (b.x - a.x) * (p.y - a.y) - (p.x - a.x) * (b.y - a.y);
+            if (a.y <= p.y)
+            {
+                if (b.y > p.y && side > 0.0f) { winding += 1; }
+            }
+            else if (b.y <= p.y && side < 0.0f)
+            {
+                winding -= 1;
+            }
+        }
+    }
+    return winding != 0;
+}
+
+bool is_near_path_outline(const PathView& path, const glm::vec2& p, float distance)
+{
+    const float limit = distance * distance;
+    for (std::size_t contour = 0; contour < path.contour_count; contour += 1)
+    {
+        const auto first = path.get_start(contour);
+        const auto end = path.contours[contour].end;
+        const auto last = path.contours[contour].closed ? end : end - 1;
+        for (u32 i = first; i < last; i += 1)
+        {
+            const auto& b = path.points[i + 1 < end ? i + 1 : first];
+            if (get_distance_squared(path.points[i], b, p) <= limit)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
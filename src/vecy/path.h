@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+
+#include "glm/vec2.hpp"
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+
+enum class PathVerb : u8
+{
+    move, line, quad, cubic, close
+};
+
+// The segments of a path in world space. Each verb takes the next points in order,
+// move and line take one, quad two and cubic three, close takes none.
+// Every contour starts with a move.
+struct PathGeometry
+{
+    std::vector<PathVerb> verbs;
+    std::vector<glm::vec2> points;
+
+    void move_to(const glm::vec2& p);
+    void line_to(const glm::vec2& p);
+    void quad_to(const glm::vec2& control, const glm::vec2& p);
+    void cubic_to(const glm::vec2& control1, const glm::vec2& control2, const glm::vec2& p);
+    void close();
+
+    void translate(const glm::vec2& delta);
+
+    // a curve is inside the hull of its control points so this contains all of the path
+    [[nodiscard]] Rect get_bounds() const;
+
+    [[nodiscard]] bool empty() const
+    {
+        return verbs.empty();
+    }
+};
+
+// where a contour ends in the points of a flattened path, it starts where the previous ended.
+// a fill always closes the contour but only a closed contour is outlined back to its start
+struct PathContour
+{
+    u32 end;
+    bool closed;
+};
+
+// flattened contours that are drawn or hit tested together
+struct PathView
+{
+    const glm::vec2* points;
+    const PathContour* contours;
+    std::size_t contour_count;
+
+    [[nodiscard]] u32 get_start(std::size_t contour) const
+    {
+        return contour == 0 ? 0 : contours[contour - 1].end;
+    }
+};
+
+// the line segments that approximate a path
+struct FlattenedPath
+{
+    std::vector<glm::vec2> points;
+    std::vector<PathContour> contours;
+
+    [[nodiscard]] PathView get_view() const
+    {
+        return { points.data(), contours.data(), contours.size() };
+    }
+
+    void translate(const glm::vec2& delta);
+};
+
+// how far a flattened path may be from the curves on the screen, in pixels
+constexpr float flatten_pixel_tolerance = 0.25f;
+
+// a path flattened at a level is fine enough for every zoom up to a power of two,
+// so a zoom within the level reuses it and crossing into another level flattens again
+constexpr int no_flatten_level = std::numeric_limits<int>::min();
+[[nodiscard]] int get_flatten_level(float scale);
+
+// the tolerance in world units for the zoom level
+[[nodiscard]] float get_flatten_tolerance(int level);
+
+// replaces the flattened path with line segments within the tolerance of the curves
+void flatten_path(const PathGeometry& path, float tolerance, FlattenedPath* flattened);
+
+// the fill of the path covers the point, with the nonzero winding rule
+[[nodiscard]] bool is_inside_path(const PathView& path, const glm::vec2& p);
+
+// the point is within the distance of a segment of the outline
+[[nodiscard]] bool is_near_path_outline(const PathView& path, const glm::vec2& p, float distance);
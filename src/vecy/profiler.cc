@@ -0,0 +1,225 @@
+#include "vecy/profiler.h"
+
+#if defined(VECY_PROFILER)
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+    // a zone and the index it was written for. the fields are atomics so a reader racing a writer
+    // reads a mix of old and new values instead of undefined behaviour, the sequence tells them apart
+    struct Slot
+    {
+        std::atomic<u64> sequence{ 0 };
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<u64> start_ns{ 0 };
+        std::atomic<u64> end_ns{ 0 };
+        std::atomic<u32> thread{ 0 };
+    };
+
+    struct ProfileRing
+    {
+        std::array<Slot, profile_ring_size> slots;
+        std::atomic<u64> next{ 0 };
+        std::atomic<u32> next_thread{ 0 };
+    };
+
+    ProfileRing& get_ring()
+    {
+        static ProfileRing ring;
+        return ring;
+    }
+
+    u32 get_thread_index()
+    {
+        thread_local const u32 index = get_ring().next_thread.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    double to_ms(u64 ns)
+    {
+        return static_cast<double>(ns) / 1000000.0;
+    }
+
+    double get_percentile(const std::vector<u64>& sorted, double p)
+    {
+        if (sorted.empty())
+        {
+            return 0.0;
+        }
+        const auto index = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return to_ms(sorted[std::min(index, sorted.size() - 1)]);
+    }
+
+    void write_json_string(std::FILE* file, const char* text)
+    {
+        std::fputc('"', file);
+        for (const char* c = text; *c != 0; c += 1)
+        {
+            if (*c == '"' || *c == '\\') { std::fputc('\\', file); }
+            std::fputc(*c, file);
+        }
+        std::fputc('"', file);
+    }
+}
+
+u64 get_profile_time_ns()
+{
+    using clock = std::chrono::steady_clock;
+    static const auto start = clock::now();
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+}
+
+void record_profile_zone(const char* name, u64 start_ns, u64 end_ns)
+{
+    auto& ring = get_ring();
+    const u64 index = ring.next.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = ring.slots[index % profile_ring_size];
+
+    // 0 marks the slot as being written
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.end_ns.store(end_ns, std::memory_order_relaxed);
+    slot.thread.store(get_thread_index(), std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+std::vector<ProfileZone> get_profile_zones()
+{
+    auto& ring = get_ring();
+    const u64 end = ring.next.load(std::memory_order_acquire);
+    const u64 begin = end > profile_ring_size ? end - profile_ring_size : 0;
+
+    std::vector<ProfileZone> zones;
+    zones.reserve(static_cast<std::size_t>(end - begin));
+    for (u64 index = begin; index < end; index += 1)
+    {
+        const auto& slot = ring.slots[index % profile_ring_size];
+        if (slot.sequence.load(std::memory_order_acquire) != index + 1)
+        {
+            continue;
+        }
+
+        const auto zone = ProfileZone
+        {
+            slot.name.load(std::memory_order_relaxed),
+            slot.start_ns.load(std::memory_order_relaxed),
+            slot.end_ns.load(std::memory_order_relaxed),
+            slot.thread.load(std::memory_order_relaxed)
+        };
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == index + 1 && zone.name != nullptr)
+        {
+            zones.push_back(zone);
+        }
+    }
+    return zones;
+}
+
+ProfileReport get_profile_report(int frame_count)
+{
+    const auto zones = get_profile_zones();
+
+    // zones are recorded when they end so a frame comes after the zones inside it,
+    // walk back to the start of the oldest frame that is asked for
+    std::vector<u64> frame_times;
+    u64 window_start = 0;
+    for (auto it = zones.rbegin(); it != zones.rend() && static_cast<int>(frame_times.size()) < frame_count; ++it)
+    {
+        if (std::strcmp(it->name, "frame") == 0)
+        {
+            frame_times.push_back(it->end_ns - it->start_ns);
+            window_start = it->start_ns;
+        }
+    }
+
+    ProfileReport report;
+    report.frames = static_cast<int>(frame_times.size());
+    if (frame_times.empty())
+    {
+        return report;
+    }
+
+    std::sort(frame_times.begin(), frame_times.end());
+    report.frame_p50_ms = get_percentile(frame_times, 0.5);
+    report.frame_p90_ms = get_percentile(frame_times, 0.9);
+    report.frame_p99_ms = get_percentile(frame_times, 0.99);
+    report.frame_max_ms = to_ms(frame_times.back());
+
+    for (const auto& zone : zones)
+    {
+        if (zone.start_ns < window_start || std::strcmp(zone.name, "frame") == 0)
+        {
+            continue;
+        }
+
+        auto phase = std::find_if(report.phases.begin(), report.phases.end(), [&](const ProfilePhase& p) { return p.name == zone.name; });
+        if (phase == report.phases.end())
+        {
+            report.phases.push_back({ zone.name });
+            phase = std::prev(report.phases.end());
+        }
+        const double ms = to_ms(zone.end_ns - zone.start_ns);
+        phase->average_ms += ms;
+        phase->max_ms = std::max(phase->max_ms, ms);
+    }
+    for (auto& phase : report.phases)
+    {
+        phase.average_ms /= report.frames;
+    }
+
+    return report;
+}
+
+std::string to_string(const ProfileReport& report)
+{
+    char line[256];
+    std::snprintf
+    (
+        line, sizeof(line), "frame over %d: p50 %.3fms p90 %.3fms p99 %.3fms max %.3fms",
+        report.frames, report.frame_p50_ms, report.frame_p90_ms, report.frame_p99_ms, report.frame_max_ms
+    );
+    std::string ret = line;
+    for (const auto& phase : report.phases)
+    {
+        std::snprintf(line, sizeof(line), "\n  %s: %.3fms per frame, max %.3fms", phase.name.c_str(), phase.average_ms, phase.max_ms);
+        ret += line;
+    }
+    return ret;
+}
+
+bool write_chrome_trace(const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    // complete events, the times are in microseconds
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& zone : get_profile_zones())
+    {
+        std::fprintf(file, first ? "{\"name\":" : ",\n{\"name\":");
+        write_json_string(file, zone.name);
+        std::fprintf
+        (
+            file, ",\"cat\":\"vecy\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+            static_cast<double>(zone.start_ns) / 1000.0, static_cast<double>(zone.end_ns - zone.start_ns) / 1000.0, zone.thread
+        );
+        first = false;
+    }
+    std::fprintf(file, "\n]}\n");
+
+    return std::fclose(file) == 0;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+
+// Scoped timing zones for finding where a frame goes. Only compiled with VECY_PROFILER defined,
+// otherwise the macros expand to nothing and none of this exists.
+//
+//   VECY_PROFILE_SCOPE("shapes");   times the rest of the enclosing scope
+//
+// Zones are written to a fixed ring buffer that any thread can write to without locking,
+// the oldest zones are overwritten.
+
+#if defined(VECY_PROFILER)
+
+#include <string>
+#include <vector>
+
+#include "vecy/types.h"
+
+struct ProfileZone
+{
+    // a string literal, zones are grouped on the text
+    const char* name;
+    u64 start_ns;
+    u64 end_ns;
+    u32 thread;
+};
+
+constexpr std::size_t profile_ring_size = 64 * 1024;
+
+// nanoseconds since the first call
+[[nodiscard]] u64 get_profile_time_ns();
+
+void record_profile_zone(const char* name, u64 start_ns, u64 end_ns);
+
+struct ProfileScope
+{
+    const char* name;
+    u64 start_ns;
+
+    explicit ProfileScope(const char* n)
+        : name(n)
+        , start_ns(get_profile_time_ns())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        record_profile_zone(name, start_ns, get_profile_time_ns());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    void operator=(const ProfileScope&) = delete;
+};
+
+// the zones still in the ring, oldest first. zones that are overwritten while copying are skipped
+[[nodiscard]] std::vector<ProfileZone> get_profile_zones();
+
+struct ProfilePhase
+{
+    std::string name;
+    double average_ms = 0.0;
+    double max_ms = 0.0;
+};
+
+// the frames are the zones named "frame"
+struct ProfileReport
+{
+    int frames = 0;
+    double frame_p50_ms = 0.0;
+    double frame_p90_ms = 0.0;
+    double frame_p99_ms = 0.0;
+    double frame_max_ms = 0.0;
+
+    // time per frame spent in each zone, in the order they were first seen
+    std::vector<ProfilePhase> phases;
+};
+
+// the last frame_count frames in the ring
+[[nodiscard]] ProfileReport get_profile_report(int frame_count);
+[[nodiscard]] std::string to_string(const ProfileReport& report);
+
+// the ring as chrome trace events, open it in chrome://tracing or perfetto
+bool write_chrome_trace(const std::string& path);
+
+#define VECY_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VECY_PROFILE_CONCAT(a, b) VECY_PROFILE_CONCAT_IMPL(a, b)
+#define VECY_PROFILE_SCOPE(name) const ProfileScope VECY_PROFILE_CONCAT(profile_scope_, __LINE__){ name }
+
+#else
+
+#define VECY_PROFILE_SCOPE(name)
+
+#endif
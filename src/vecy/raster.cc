@@ -0,0 +1,467 @@
+#include "vecy/raster.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+    // far outside of any image, a coordinate clamped to it still draws nothing there and fits an int
+    constexpr float pixel_limit = static_cast<float>(1 << 30);
+
+    int to_pixel_index(float pixel)
+    {
+        return static_cast<int>(std::min(std::max(-pixel_limit, pixel), pixel_limit));
+    }
+
+    // pixels that have their center inside [start, end)
+    int first_pixel(float start)
+    {
+        return to_pixel_index(std::ceil(start - 0.5f));
+    }
+
+    constexpr float pi = 3.14159265358979323846f;
+
+    // liang-barsky: narrows [t0, t1] to the part of from + delta * t inside the rect, false if none of it is
+    bool clip_line(const glm::vec2& from, const glm::vec2& delta, const glm::dvec2& min, const glm::dvec2& max, double* t0, double* t1)
+    {
+        const double p[4] = { -delta.x, delta.x, -delta.y, delta.y };
+        const double q[4] = { from.x - min.x, max.x - from.x, from.y - min.y, max.y - from.y };
+        for (int edge = 0; edge < 4; edge += 1)
+        {
+            if (p[edge] == 0.0)
+            {
+                if (q[edge] < 0.0) { return false; }
+                continue;
+            }
+            const double t = q[edge] / p[edge];
+            if (p[edge] < 0.0) { *t0 = std::max(*t0, t); }
+            else { *t1 = std::min(*t1, t); }
+        }
+        return *t0 <= *t1;
+    }
+}
+
+Image::Image(int w, int h)
+    : width(w)
+    , height(h)
+    , pixels(static_cast<std::size_t>(w) * h, 0)
+{
+}
+
+void blit(Image* dst, const Image& src, int x, int y)
+{
+    const int left = std::max(0, -x);
+    const int top = std::max(0, -y);
+    const int right = std::min(src.width, dst->width - x);
+    const int bottom = std::min(src.height, dst->height - y);
+    if (left >= right)
+    {
+        return;
+    }
+
+    for (int row = top; row < bottom; row += 1)
+    {
+        const auto* from = src.get_row(row) + left;
+        std::copy(from, from + (right - left), dst->get_row(y + row) + x + left);
+    }
+}
+
+bool is_dash_on(LineStyle style, int width, float distance)
+{
+    const auto pattern = get_dash_pattern(style);
+    if (pattern.count == 0)
+    {
+        return true;
+    }
+
+    const int scale = std::max(1, width);
+    int total = 0;
+    for (int i = 0; i < pattern.count; i += 1)
+    {
+        total += pattern.lengths[i] * scale;
+    }
+
+    float d = std::fmod(distance, static_cast<float>(total));
+    if (d < 0.0f)
+    {
+        d += static_cast<float>(total);
+    }
+
+    for (int i = 0; i < pattern.count; i += 1)
+    {
+        const float length = static_cast<float>(pattern.lengths[i] * scale);
+        if (d < length)
+        {
+            return i % 2 == 0;
+        }
+        d -= length;
+    }
+    return false;
+}
+
+RasterPainter::RasterPainter(Image* i)
+    : image(i)
+{
+    reset_clip();
+}
+
+void RasterPainter::clear(const Rgba& color)
+{
+    const auto pixel = to_pixel(color);
+    for (int y = clip_top; y < clip_bottom; y += 1)
+    {
+        kernels->fill(image->get_row(y) + clip_left, clip_right - clip_left, pixel);
+    }
+}
+
+void RasterPainter::draw_text(const std::string&, const glm::vec2&, const Rgba&)
+{
+}
+
+void RasterPainter::draw_rectangle(const Rect& r, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    if (r.size.x <= 0 || r.size.y <= 0)
+    {
+        return;
+    }
+
+    stats.primitives += 1;
+
+    const int x0 = first_pixel(r.topleft.x);
+    const int x1 = first_pixel(r.topleft.x + r.size.x);
+    const int y0 = first_pixel(r.topleft.y);
+    const int y1 = first_pixel(r.topleft.y + r.size.y);
+
+    if (fill)
+    {
+        for (int y = std::max(y0, clip_top); y < std::min(y1, clip_bottom); y += 1)
+        {
+            fill_span(y, x0, x1, *fill);
+        }
+    }
+
+    if (outline)
+    {
+        // the border is drawn on the inside of the rect, clockwise so the dashes are continuous
+        const int w = std::max(1, outline->width);
+        const auto fx0 = static_cast<float>(x0);
+        const auto fx1 = static_cast<float>(x1);
+        const auto fy0 = static_cast<float>(y0);
+        const auto fy1 = static_cast<float>(y1);
+        float distance = 0.0f;
+        distance = stroke_axis_line(true, y0, fx0, fx1, *outline, distance);
+        distance = stroke_axis_line(false, x1 - w, fy0 + w, fy1, *outline, distance);
+        distance = stroke_axis_line(true, y1 - w, fx0, fx1 - w, *outline, distance);
+        stroke_axis_line(false, x0, fy0 + w, fy1 - w, *outline, distance);
+    }
+}
+
+void RasterPainter::draw_circle(const glm::vec2& p, float radius, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    stats.primitives += 1;
+
+    if (fill)
+    {
+        const int y0 = std::max(clip_top, first_pixel(p.y - radius));
+        const int y1 = std::min(clip_bottom, first_pixel(p.y + radius));
+        for (int y = y0; y < y1; y += 1)
+        {
+            const float dy = static_cast<float>(y) + 0.5f - p.y;
+            const float h2 = radius * radius - dy * dy;
+            if (h2 < 0.0f)
+            {
+                continue;
+            }
+            const float half = std::sqrt(h2);
+            fill_span(y, first_pixel(p.x - half), first_pixel(p.x + half), *fill);
+        }
+    }
+
+    if (outline)
+    {
+        const float half_width = static_cast<float>(std::max(1, outline->width)) * 0.5f;
+        const float inner = radius - half_width;
+        const float outer = radius + half_width;
+
+        const int y0 = std::max(clip_top, first_pixel(p.y - outer));
+        const int y1 = std::min(clip_bottom, first_pixel(p.y + outer));
+        const int x0 = std::max(clip_left, first_pixel(p.x - outer));
+        const int x1 = std::min(clip_right, first_pixel(p.x + outer));
+        for (int y = y0; y < y1; y += 1)
+        {
+            for (int x = x0; x < x1; x += 1)
+            {
+                const float dx = static_cast<float>(x) + 0.5f - p.x;
+                const float dy = static_cast<float>(y) + 0.5f - p.y;
+                const float d = std::sqrt(dx * dx + dy * dy);
+                if (d < inner || d >= outer)
+                {
+                    continue;
+                }
+
+                const float along = (std::atan2(dy, dx) + pi) * radius;
+                if (is_dash_on(outline->style, outline->width, along))
+                {
+                    plot(x, y, outline->color);
+                }
+            }
+        }
+    }
+}
+
+void RasterPainter::draw_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline)
+{
+    stats.primitives += 1;
+    stroke_line(from, to, outline, 0.0f);
+}
+
+void RasterPainter::draw_path(const PathView& path, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    if (path.contour_count == 0)
+    {
+        return;
+    }
+
+    stats.primitives += 1;
+
+    if (fill)
+    {
+        const auto point_count = path.contours[path.contour_count - 1].end;
+        float top = path.points[0].y;
+        float bottom = top;
+        for (u32 i = 0; i < point_count; i += 1)
+        {
+            top = std::min(top, path.points[i].y);
+            bottom = std::max(bottom, path.points[i].y);
+        }
+
+        // nonzero winding at the pixel centers, the same rule as is_inside_path
+        const int y0 = std::max(clip_top, first_pixel(top));
+        const int y1 = std::min(clip_bottom, first_pixel(bottom));
+        for (int y = y0; y < y1; y += 1)
+        {
+            const float center = static_cast<float>(y) + 0.5f;
+            crossings.clear();
+            for (std::size_t contour = 0; contour < path.contour_count; contour += 1)
+            {
+                const auto first = path.get_start(contour);
+                const auto end = path.contours[contour].end;
+                for (u32 i = first; i < end; i += 1)
+                {
+                    const auto& a = path.points[i];
+                    const auto& b = path.points[i + 1 < end ? i + 1 : first];
+                    const bool down = a.y <= center && b.y > center;
+                    const bool up = b.y <= center && a.y > center;
+                    if (down || up)
+                    {
+                        const float t = (center - a.y) / (b.y - a.y);
+                        crossings.push_back({ a.x + (b.x - a.x) * t, down ? 1 : -1 });
+                    }
+                }
+            }
+            std::sort(crossings.begin(), crossings.end(), [](const Crossing& lhs, const Crossing& rhs) { return lhs.x < rhs.x; });
+
+            int winding = 0;
+            float start = 0.0f;
+            for (const auto& c : crossings)
+            {
+                const int before = winding;
+                winding += c.winding;
+                if (before == 0)
+                {
+                    start = c.x;
+                }
+                else if (winding == 0)
+                {
+                    fill_span(y, first_pixel(start), first_pixel(c.x), *fill);
+                }
+            }
+        }
+    }
+
+    if (outline)
+    {
+        for (std::size_t contour = 0; contour < path.contour_count; contour += 1)
+        {
+            const auto first = path.get_start(contour);
+            const auto end = path.contours[contour].end;
+            const auto last = path.contours[contour].closed ? end : end - 1;
+            float distance = 0.0f;
+            for (u32 i = first; i < last; i += 1)
+            {
+                distance = stroke_line(path.points[i], path.points[i + 1 < end ? i + 1 : first], *outline, distance);
+            }
+        }
+    }
+}
+
+void RasterPainter::set_clip(const Rect& r)
+{
+    clip_left = std::max(0, to_pixel_index(std::floor(r.topleft.x)));
+    clip_top = std::max(0, to_pixel_index(std::floor(r.topleft.y)));
+    clip_right = std::min(image->width, to_pixel_index(std::ceil(r.topleft.x + r.size.x)));
+    clip_bottom = std::min(image->height, to_pixel_index(std::ceil(r.topleft.y + r.size.y)));
+}
+
+void RasterPainter::reset_clip()
+{
+    clip_left = 0;
+    clip_top = 0;
+    clip_right = image->width;
+    clip_bottom = image->height;
+}
+
+void RasterPainter::fill_span(int y, int x0, int x1, const Fill& fill)
+{
+    if (y < clip_top || y >= clip_bottom || fill.color.a == 0)
+    {
+        return;
+    }
+
+    const int left = std::max(x0, clip_left);
+    const int right = std::min(x1, clip_right);
+    if (left >= right)
+    {
+        return;
+    }
+
+    Pixel* row = image->get_row(y);
+    const auto color = to_pixel(fill.color);
+    const bool opaque = fill.color.a == 255;
+
+    if (fill.style == FillStyle::solid)
+    {
+        if (opaque)
+        {
+            kernels->fill(row + left, right - left, color);
+        }
+        else
+        {
+            kernels->blend(row + left, right - left, color);
+        }
+        return;
+    }
+
+    const auto hatch = get_hatch_row(fill.style, y);
+    if (opaque)
+    {
+        kernels->hatch_fill(row + left, left, right - left, hatch, color);
+    }
+    else
+    {
+        kernels->hatch_blend(row + left, left, right - left, hatch, color);
+    }
+}
+
+void RasterPainter::plot(int x, int y, const Rgba& color)
+{
+    if (x < clip_left || x >= clip_right || y < clip_top || y >= clip_bottom || color.a == 0)
+    {
+        return;
+    }
+
+    Pixel& p = image->get_row(y)[x];
+    p = color.a == 255 ? to_pixel(color) : blend_pixel(p, to_pixel(color));
+}
+
+float RasterPainter::stroke_axis_line(bool horizontal, int across, float start, float end, const Outline& outline, float distance)
+{
+    const float low = std::min(start, end);
+    const float high = std::max(start, end);
+    const int p0 = first_pixel(low);
+    const int p1 = first_pixel(high);
+    const int w = std::max(1, outline.width);
+
+    if (outline.style == LineStyle::solid && horizontal)
+    {
+        const auto fill = Fill{ outline.color, FillStyle::solid };
+        for (int i = 0; i < w; i += 1)
+        {
+            fill_span(across + i, p0, p1, fill);
+        }
+        return distance + (high - low);
+    }
+
+    // the dashes only depend on p so the pixels outside of the clip can be skipped
+    const int first = std::max(p0, horizontal ? clip_left : clip_top);
+    const int last = std::min(p1, horizontal ? clip_right : clip_bottom);
+    const bool is_solid = outline.style == LineStyle::solid;
+    for (int p = first; p < last; p += 1)
+    {
+        if (is_solid == false && is_dash_on(outline.style, w, distance + static_cast<float>(p) + 0.5f - low) == false)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < w; i += 1)
+        {
+            if (horizontal)
+            {
+                plot(p, across + i, outline.color);
+            }
+            else
+            {
+                plot(across + i, p, outline.color);
+            }
+        }
+    }
+
+    return distance + (high - low);
+}
+
+float RasterPainter::stroke_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline, float distance)
+{
+    const int w = std::max(1, outline.width);
+    const int offset = (w - 1) / 2;
+
+    if (from.y == to.y)
+    {
+        return stroke_axis_line(true, to_pixel_index(std::floor(from.y)) - offset, from.x, to.x, outline, distance);
+    }
+
+    if (from.x == to.x)
+    {
+        return stroke_axis_line(false, to_pixel_index(std::floor(from.x)) - offset, from.y, to.y, outline, distance);
+    }
+
+    // step a pixel at a time along the major axis and stamp the line width.
+    // only the steps that can stamp inside the clip are taken, the rest of a long line would plot nothing
+    const auto delta = to - from;
+    const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+    const double steps = std::ceil(std::max(std::abs(delta.x), std::abs(delta.y)));
+    const double margin = w + 1;
+    double t0 = 0.0;
+    double t1 = 1.0;
+    const bool visible
+        =  std::isfinite(steps)
+        && clip_line(from, delta, { clip_left - margin, clip_top - margin }, { clip_right + margin, clip_bottom + margin }, &t0, &t1)
+        ;
+    if (visible == false)
+    {
+        return distance + length;
+    }
+
+    // a step more on both sides so rounding in the clip can't drop a stamp
+    const auto first_step = static_cast<u64>(std::max(0.0, std::floor(t0 * steps) - 1.0));
+    const auto last_step = static_cast<u64>(std::min(steps, std::ceil(t1 * steps) + 1.0));
+    for (u64 i = first_step; i < last_step; i += 1)
+    {
+        const float t = static_cast<float>(i) / static_cast<float>(steps);
+        if (is_dash_on(outline.style, w, distance + length * t) == false)
+        {
+            continue;
+        }
+
+        const int px = static_cast<int>(std::floor(from.x + delta.x * t)) - offset;
+        const int py = static_cast<int>(std::floor(from.y + delta.y * t)) - offset;
+        for (int y = 0; y < w; y += 1)
+        {
+            for (int x = 0; x < w; x += 1)
+            {
+                plot(px + x, py + y, outline.color);
+            }
+        }
+    }
+
+    return distance + length;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include "vecy/types.h"
+#include "vecy/rgba.h"
+#include "vecy/style.h"
+#include "vecy/painter.h"
+#include "vecy/span_kernels.h"
+
+inline Pixel to_pixel(const Rgba& c)
+{
+    return Pixel{c.r} | (Pixel{c.g} << 8) | (Pixel{c.b} << 16) | (Pixel{c.a} << 24);
+}
+
+struct Image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<Pixel> pixels;
+
+    Image() = default;
+    Image(int w, int h);
+
+    Pixel* get_row(int y)
+    {
+        return pixels.data() + static_cast<std::size_t>(y) * width;
+    }
+
+    const Pixel* get_row(int y) const
+    {
+        return pixels.data() + static_cast<std::size_t>(y) * width;
+    }
+};
+
+// copy the source image to the position in the destination, clipped to the destination
+void blit(Image* dst, const Image& src, int x, int y);
+
+// is the dash pattern on at the distance along a line, solid is always on
+bool is_dash_on(LineStyle style, int width, float distance);
+
+// A software rasterizer that draws into an image, with the same primitives and styles as the wx painter.
+// Pixel coverage is decided by pixel centers and translucent colors are blended src-over.
+// There is no font, so text is not drawn.
+struct RasterPainter : Painter
+{
+    explicit RasterPainter(Image* image);
+
+    void clear(const Rgba& color) override;
+    void draw_text(const std::string& str, const glm::vec2& p, const Rgba& color) override;
+    void draw_rectangle(const Rect& r, const std::optional<Fill>& fill, const std::optional<Outline>& outline) override;
+    void draw_circle(const glm::vec2& p, float radius, const std::optional<Fill>& fill, const std::optional<Outline>& outline) override;
+    void draw_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline) override;
+    void draw_path(const PathView& path, const std::optional<Fill>& fill, const std::optional<Outline>& outline) override;
+
+    void set_clip(const Rect& r) override;
+    void reset_clip() override;
+
+    Image* image;
+
+    // what spans are filled with, the fastest the cpu supports unless changed
+    const SpanKernels* kernels = &get_span_kernels();
+
+    // the clipped area in pixels, right and bottom are exclusive
+    int clip_left = 0;
+    int clip_top = 0;
+    int clip_right = 0;
+    int clip_bottom = 0;
+
+private:
+    // where the edges of a path cross a row and which way they go, kept to not allocate per path
+    struct Crossing
+    {
+        float x;
+        int winding;
+    };
+    std::vector<Crossing> crossings;
+
+    // fill the pixels [x0, x1) on a row
+    void fill_span(int y, int x0, int x1, const Fill& fill);
+
+    // set a single pixel with the outline color if it's inside the clip
+    void plot(int x, int y, const Rgba& color);
+
+    // stroke a horizontal or vertical line, across is the first pixel row or column of the line
+    // returns the dash distance at the end of the line
+    float stroke_axis_line(bool horizontal, int across, float start, float end, const Outline& outline, float distance);
+
+    // stroke a line in any direction, returns the dash distance at the end of the line
+    float stroke_line(const glm::vec2& from, const glm::vec2& to, const Outline& outline, float distance);
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+
+#include "glm/vec2.hpp"
+
+struct Rect
+{
+    glm::vec2 topleft;
+    glm::vec2 size;
+
+    static Rect from_points(const glm::vec2& a, const glm::vec2& b)
+    {
+        auto r = Rect{ a, {0, 0} };
+        r.include(b);
+        return r;
+    }
+
+    glm::vec2 get_bottomright() const
+    {
+        return topleft + size;
+    }
+
+    float get_perimeter() const
+    {
+        return 2.0f * (size.x + size.y);
+    }
+
+    Rect extend(float x) const
+    {
+        return
+        {
+            {topleft.x - x, topleft.y - x},
+            {size.x + x * 2.0f, size.y + x * 2.0f}
+        };
+    }
+
+    bool contains(const glm::vec2& p) const
+    {
+        const bool outside
+            = p.x < topleft.x
+             || p.x > topleft.x + size.x
+             || p.y > topleft.y + size.y
+             || p.y < topleft.y
+            ;
+        return !outside;
+    }
+
+    bool contains(const Rect& r) const
+    {
+        return
+               r.topleft.x >= topleft.x
+            && r.topleft.y >= topleft.y
+            && r.topleft.x + r.size.x <= topleft.x + size.x
+            && r.topleft.y + r.size.y <= topleft.y + size.y
+            ;
+    }
+
+    bool intersects(const Rect& r) const
+    {
+        const bool outside
+            = r.topleft.x > topleft.x + size.x
+             || r.topleft.x + r.size.x < topleft.x
+             || r.topleft.y > topleft.y + size.y
+             || r.topleft.y + r.size.y < topleft.y
+            ;
+        return !outside;
+    }
+
+    void include(const glm::vec2& p)
+    {
+        if (p.x < topleft.x)
+        {
+            size.x += topleft.x - p.x;
+            topleft.x = p.x;
+        }
+        else if (p.x > topleft.x + size.x)
+        {
+            size.x = p.x - topleft.x;
+        }
+
+        if (p.y < topleft.y)
+        {
+            size.y += topleft.y - p.y;
+            topleft.y = p.y;
+        }
+        else if (p.y > topleft.y + size.y)
+        {
+            size.y = p.y - topleft.y;
+        }
+    }
+
+    void include(const Rect& r)
+    {
+        include(r.topleft);
+        include(r.get_bottomright());
+    }
+};
@@ -0,0 +1,907 @@
+#include "vecy/render.h"
+
+#include <cmath>
+#include <cassert>
+#include <limits>
+#include <algorithm>
+
+#include "vecy/profiler.h"
+#include "vecy/transform_kernels.h"
+
+void paint_rectangle(Painter* dc, const CanvasTransform& t, const Rect& rect, const Rgba& color)
+{
+    dc->draw_rectangle(from_world_to_screen(t, rect), Fill{ color, FillStyle::solid }, std::nullopt);
+}
+
+void paint_path(Painter* dc, const CanvasTransform& t, const PathArray& paths, u32 slot, std::vector<glm::vec2>* points)
+{
+    const auto& flattened = paths.get_flattened(slot, t.scale);
+    points->resize(flattened.points.size());
+    from_world_to_screen(t, flattened.points.data(), points->data(), points->size());
+
+    // the width is in world units but a visible outline is at least a pixel wide
+    auto outline = paths.outlines[slot];
+    if (outline)
+    {
+        outline->width = std::max(1, static_cast<int>(std::lround(static_cast<float>(outline->width) * t.scale)));
+    }
+    dc->draw_path(PathView{ points->data(), flattened.contours.data(), flattened.contours.size() }, paths.fills[slot], outline);
+}
+
+namespace
+{
+    // enough for a symbol drawn both zoomed in and out, a level far from the one drawn now is replaced
+    constexpr std::size_t max_symbol_levels = 3;
+
+    // the shapes in the order they were added to the symbol
+    void record_symbol(const Symbol& symbol, int level, DrawCommandList* commands, std::vector<glm::vec2>* points)
+    {
+        commands->clear();
+        RecordingPainter recorder{ commands };
+        CanvasTransform t;
+        t.scale = std::ldexp(1.0f, level);
+
+        const auto& rectangles = symbol.rectangles;
+        const auto& paths = symbol.paths;
+        u32 next_path = 0;
+        for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+        {
+            for (; next_path < paths.size() && paths.ids[next_path].id < rectangles.ids[slot].id; next_path += 1)
+            {
+                paint_path(&recorder, t, paths, next_path, points);
+            }
+            paint_rectangle(&recorder, t, rectangles.rects[slot], rectangles.colors[slot]);
+        }
+        for (; next_path < paths.size(); next_path += 1)
+        {
+            paint_path(&recorder, t, paths, next_path, points);
+        }
+    }
+
+    const SymbolRecording& get_symbol_recording(RenderCache* cache, const ShapeStore& store, u32 symbol_index, int level)
+    {
+        const auto& symbol = store.symbols[symbol_index];
+        if (cache->symbol_recordings.size() < store.symbols.size())
+        {
+            cache->symbol_recordings.resize(store.symbols.size());
+        }
+
+        auto& recordings = cache->symbol_recordings[symbol_index];
+        SymbolRecording* replaced = nullptr;
+        for (auto& recording : recordings)
+        {
+            if (recording.symbol_key != symbol.key)
+            {
+                // the document was replaced and this is another symbol
+                recording.level = no_flatten_level;
+            }
+            else if (recording.level == level)
+            {
+                return recording;
+            }
+
+            const auto distance = [level](const SymbolRecording& r) { return r.level == no_flatten_level ? std::numeric_limits<int>::max() : std::abs(r.level - level); };
+            if (replaced == nullptr || distance(recording) > distance(*replaced))
+            {
+                replaced = &recording;
+            }
+        }
+        if (recordings.size() < max_symbol_levels)
+        {
+            replaced = &recordings.emplace_back();
+        }
+
+        record_symbol(symbol, level, &replaced->commands, &cache->path_points);
+        replaced->symbol_key = symbol.key;
+        replaced->level = level;
+        cache->symbol_record_count += 1;
+        return *replaced;
+    }
+}
+
+void paint_instance(Painter* dc, const CanvasTransform& t, const ShapeStore& store, u32 slot, RenderCache* cache)
+{
+    // the recording of the level is as large or larger than the instance, so it's only ever shrunk a bit
+    const auto local = get_instance_transform(t, store.instances, slot);
+    const auto level = get_flatten_level(local.scale);
+    const auto& recording = get_symbol_recording(cache, store, store.instances.symbols[slot], level);
+
+    const auto replay_transform = ReplayTransform{ local.scroll, local.scale / std::ldexp(1.0f, level), store.instances.colors[slot] };
+    const auto& commands = recording.commands;
+    for (const auto& c : commands.commands)
+    {
+        replay(dc, commands, c, replay_transform, &cache->path_points);
+    }
+}
+
+void paint_handles(Painter* dc, const Settings& settings, const Rect& screen_rect)
+{
+    const auto dx = glm::vec2{ screen_rect.size.x, 0 };
+    const auto dy = glm::vec2{ 0, screen_rect.size.y };
+    dc->draw_circle(screen_rect.topleft, settings.handle_radius, settings.handle_color, std::nullopt);
+    dc->draw_circle(screen_rect.topleft + dx, settings.handle_radius, settings.handle_color, std::nullopt);
+    dc->draw_circle(screen_rect.topleft + dy, settings.handle_radius, settings.handle_color, std::nullopt);
+    dc->draw_circle(screen_rect.topleft + dx + dy, settings.handle_radius, settings.handle_color, std::nullopt);
+}
+
+void paint_rectangle_selected(Painter* dc, const CanvasTransform& t, const Settings& settings, const Rect& rect)
+{
+    paint_handles(dc, settings, from_world_to_screen(t, rect));
+}
+
+void paint_selected(Painter* dc, const CanvasTransform& t, const Settings& settings, const ShapeStore& store, const ShapeRef& ref)
+{
+    switch (ref.kind)
+    {
+    case ShapeKind::rectangle:
+        paint_rectangle_selected(dc, t, settings, store.rectangles.rects[ref.slot]);
+        break;
+    case ShapeKind::path:
+        paint_rectangle_selected(dc, t, settings, store.paths.bounds[ref.slot]);
+        break;
+    case ShapeKind::instance:
+        paint_rectangle_selected(dc, t, settings, store.instances.bounds[ref.slot]);
+        break;
+    case ShapeKind::none:
+        assert(false);
+        break;
+    }
+}
+
+void render_grid(Painter* dc, const Settings& settings, const CanvasTransform& trans, const glm::ivec2& size)
+{
+    const float grid_size = 25.0f;
+    const float scaled_grid_size = grid_size * trans.scale;
+
+    Outline grid_line = { settings.grid_color, 1, LineStyle::solid };
+
+    dc->begin_batch(BatchOrder::any);
+    for (float x = std::fmod(trans.scroll.x, scaled_grid_size); x < size.x; x += scaled_grid_size)
+    {
+        dc->draw_line
+        (
+            glm::vec2(x, 0.0f),
+            glm::vec2(x, size.y),
+            grid_line
+        );
+    }
+
+    for (float y = std::fmod(trans.scroll.y, scaled_grid_size); y < size.y; y += scaled_grid_size)
+    {
+        dc->draw_line
+        (
+            glm::vec2(0.0f, y),
+            glm::vec2(size.x, y),
+            grid_line
+        );
+    }
+}
+
+void LodAccumulator::reset(const glm::ivec2& new_size)
+{
+    // flush leaves the cells cleared so they only need to be allocated when the size changes
+    if (new_size != size)
+    {
+        size = new_size;
+        cells.assign(static_cast<std::size_t>(std::max(0, size.x)) * std::max(0, size.y), Cell{});
+        touched.clear();
+        words_per_row = (std::max(0, size.x) + 63) / 64;
+        coverage_bits.assign(static_cast<std::size_t>(words_per_row) * std::max(0, size.y), 0);
+    }
+}
+
+void LodAccumulator::add(const Rect& screen_rect, const Rgba& color)
+{
+    const auto center = screen_rect.topleft + screen_rect.size * 0.5f;
+    const int x = static_cast<int>(std::floor(center.x));
+    const int y = static_cast<int>(std::floor(center.y));
+    if (x < 0 || y < 0 || x >= size.x || y >= size.y)
+    {
+        return;
+    }
+
+    // the area of the shape is how much of the pixel it covers
+    const float coverage = std::min(1.0f, std::abs(screen_rect.size.x * screen_rect.size.y));
+    const float a = coverage * (static_cast<float>(color.a) / 255.0f);
+    if (a <= 0.0f)
+    {
+        return;
+    }
+
+    const auto index = static_cast<u32>(y * size.x + x);
+    auto& cell = cells[index];
+    if (cell.a <= 0.0f)
+    {
+        if (touched.empty())
+        {
+            touched_min = { x, y };
+            touched_max = { x + 1, y + 1 };
+        }
+        else
+        {
+            touched_min = { std::min(touched_min.x, x), std::min(touched_min.y, y) };
+            touched_max = { std::max(touched_max.x, x + 1), std::max(touched_max.y, y + 1) };
+        }
+        touched.push_back(index);
+        coverage_bits[static_cast<std::size_t>(y) * words_per_row + x / 64] |= u64{ 1 } << (x % 64);
+    }
+
+    // src-over in premultiplied space
+    cell.r = static_cast<float>(color.r) * a + cell.r * (1.0f - a);
+    cell.g = static_cast<float>(color.g) * a + cell.g * (1.0f - a);
+    cell.b = static_cast<float>(color.b) * a + cell.b * (1.0f - a);
+    cell.a = a + cell.a * (1.0f - a);
+}
+
+namespace
+{
+    Rgba to_rgba(const LodAccumulator::Cell& cell)
+    {
+        const auto channel = [&](float c) { return static_cast<u32>(std::lround(std::min(255.0f, c / cell.a))); };
+        const auto hex = (channel(cell.r) << 16) | (channel(cell.g) << 8) | channel(cell.b);
+        return Rgba{ hex, static_cast<u8>(std::lround(std::min(255.0f, cell.a * 255.0f))) };
+    }
+
+    bool is_same(const Rgba& lhs, const Rgba& rhs)
+    {
+        return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+    }
+
+    // pixels given in row order become a rectangle for each run of the same color on a row
+    struct PixelRuns
+    {
+        PixelRuns(Painter* painter, int image_width)
+            : dc(painter)
+            , width(image_width)
+        {
+        }
+
+        Painter* dc;
+        int width;
+        int primitives = 0;
+
+        // the run is empty when start == end
+        Rgba color = Rgba{ 0x000000 };
+        u32 start = 0;
+        u32 end = 0;
+
+        void add(u32 index, const Rgba& pixel)
+        {
+            const bool continues_run = start != end && index == end && index % width != 0 && is_same(color, pixel);
+            if (continues_run == false)
+            {
+                finish();
+                color = pixel;
+                start = index;
+            }
+            end = index + 1;
+        }
+
+        void finish()
+        {
+            if (start != end)
+            {
+                const int x = static_cast<int>(start) % width;
+                const int y = static_cast<int>(start) / width;
+                dc->draw_rectangle(Rect{ {x, y}, {end - start, 1} }, Fill{ color, FillStyle::solid }, std::nullopt);
+                primitives += 1;
+                start = end;
+            }
+        }
+    };
+}
+
+int LodAccumulator::flush_below(Painter* dc, const Rect& screen_rect, bool is_opaque_rect)
+{
+    if (touched.empty())
+    {
+        return 0;
+    }
+
+    // a pixel past the rect, for anti aliasing and the outline. clamped to the screen before it's made an int
+    const auto a = screen_rect.topleft;
+    const auto b = screen_rect.get_bottomright();
+    const auto to_x = [&](float x) { return static_cast<int>(std::min(std::max(x, -2.0f), static_cast<float>(size.x + 2))); };
+    const auto to_y = [&](float y) { return static_cast<int>(std::min(std::max(y, -2.0f), static_cast<float>(size.y + 2))); };
+    const int min_x = std::max(touched_min.x, to_x(std::floor(std::min(a.x, b.x))) - 1);
+    const int min_y = std::max(touched_min.y, to_y(std::floor(std::min(a.y, b.y))) - 1);
+    const int max_x = std::min(touched_max.x, to_x(std::ceil(std::max(a.x, b.x))) + 1);
+    const int max_y = std::min(touched_max.y, to_y(std::ceil(std::max(a.y, b.y))) + 1);
+    if (min_x >= max_x || min_y >= max_y)
+    {
+        return 0;
+    }
+
+    // the pixels entirely inside an opaque rect won't be seen
+    const int hidden_min_x = to_x(std::ceil(std::min(a.x, b.x)));
+    const int hidden_min_y = to_y(std::ceil(std::min(a.y, b.y)));
+    const int hidden_max_x = to_x(std::floor(std::max(a.x, b.x)));
+    const int hidden_max_y = to_y(std::floor(std::max(a.y, b.y)));
+
+    PixelRuns runs{ dc, size.x };
+    for (int y = min_y; y < max_y; y += 1)
+    {
+        const bool hidden_row = is_opaque_rect && y >= hidden_min_y && y < hidden_max_y;
+        auto* bits = coverage_bits.data() + static_cast<std::size_t>(y) * words_per_row;
+        for (int x = min_x; x < max_x; x += 1)
+        {
+            auto& word = bits[x / 64];
+            if (word == 0)
+            {
+                // skip the rest of the word
+                x |= 63;
+                continue;
+            }
+            const auto bit = u64{ 1 } << (x % 64);
+            if ((word & bit) == 0)
+            {
+                continue;
+            }
+            word &= ~bit;
+
+            const auto index = static_cast<u32>(y * size.x + x);
+            auto& cell = cells[index];
+            if (hidden_row == false || x < hidden_min_x || x >= hidden_max_x)
+            {
+                runs.add(index, to_rgba(cell));
+            }
+            cell = Cell{};
+        }
+        runs.finish();
+    }
+    return runs.primitives;
+}
+
+int LodAccumulator::flush(Painter* dc)
+{
+    if (touched.empty())
+    {
+        return 0;
+    }
+
+    // walk in row order so neighbouring pixels of the same color become a single rectangle,
+    // when most of the screen is touched reading every cell is faster than sorting
+    const bool scan_all = touched.size() * 8 > cells.size();
+    if (scan_all == false)
+    {
+        std::sort(touched.begin(), touched.end());
+    }
+
+    // cells drawn early by flush_below are empty and can be in touched more than once
+    PixelRuns runs{ dc, size.x };
+    const auto add_pixel = [&](u32 index)
+    {
+        auto& cell = cells[index];
+        if (cell.a > 0.0f)
+        {
+            runs.add(index, to_rgba(cell));
+            cell = Cell{};
+        }
+    };
+
+    if (scan_all)
+    {
+        for (u32 index = 0; index < cells.size(); index += 1)
+        {
+            add_pixel(index);
+        }
+    }
+    else
+    {
+        for (const auto index : touched)
+        {
+            add_pixel(index);
+        }
+    }
+    runs.finish();
+
+    for (const auto index : touched)
+    {
+        coverage_bits[static_cast<std::size_t>(index / size.x) * words_per_row + index % size.x / 64] = 0;
+    }
+    touched.clear();
+    return runs.primitives;
+}
+
+namespace
+{
+    template<typename T>
+    void add_stats(ScratchStats* stats, const std::vector<T>& v)
+    {
+        stats->reserved_bytes += v.capacity() * sizeof(T);
+        stats->live_bytes += v.size() * sizeof(T);
+    }
+}
+
+ScratchStats RenderCache::get_stats() const
+{
+    ScratchStats stats;
+    add_stats(&stats, visible_rectangles);
+    add_stats(&stats, visible_paths);
+    add_stats(&stats, visible_base);
+    add_stats(&stats, path_points);
+    add_stats(&stats, lod.cells);
+    add_stats(&stats, lod.touched);
+    add_stats(&stats, lod.coverage_bits);
+    add_stats(&stats, batch_rects);
+    add_stats(&stats, batch_colors);
+    add_stats(&stats, handle_rects);
+    add_stats(&stats, visible_instances);
+    add_stats(&stats, symbol_recordings);
+    for (const auto& recordings : symbol_recordings)
+    {
+        add_stats(&stats, recordings);
+        for (const auto& recording : recordings)
+        {
+            add_stats(&stats, recording.commands.commands);
+            add_stats(&stats, recording.commands.batches);
+            add_stats(&stats, recording.commands.paths);
+            add_stats(&stats, recording.commands.path_points);
+            add_stats(&stats, recording.commands.path_contours);
+        }
+    }
+    return stats;
+}
+
+namespace
+{
+    // Draws shapes given in paint order. They are moved to screen space in batches small enough
+    // to stay in the cache between the transform and the drawing.
+    // The small shapes are merged per pixel and drawn when a large shape would cover one of the
+    // merged pixels, or at the end, so every shape keeps its place in the paint order
+    struct ShapeBatch
+    {
+        static constexpr std::size_t batch_size = 256;
+
+        Painter* dc;
+        const CanvasTransform& trans;
+        const ShapeStore& shapes;
+        RenderCache* cache;
+        ShapeRenderStats* stats;
+        float threshold;
+
+        ShapeBatch(Painter* painter, const Settings& settings, const CanvasTransform& t, const glm::ivec2& size, const ShapeStore& store, RenderCache* render_cache, ShapeRenderStats* render_stats)
+            : dc(painter)
+            , trans(t)
+            , shapes(store)
+            , cache(render_cache)
+            , stats(render_stats)
+            , threshold(painter->wants_lod() ? settings.lod_pixel_threshold : 0.0f)
+        {
+            dc->begin_batch(BatchOrder::keep);
+            cache->lod.reset(size);
+            cache->batch_rects.clear();
+            cache->batch_colors.clear();
+        }
+
+        void add(const Rect& world, const Rgba& color)
+        {
+            cache->batch_rects.push_back(world);
+            cache->batch_colors.push_back(color);
+            if (cache->batch_rects.size() == batch_size)
+            {
+                flush();
+            }
+        }
+
+        // a path is only flattened when it's large enough to be drawn on its own
+        void add_path(u32 slot)
+        {
+            const auto r = from_world_to_screen(trans, shapes.paths.bounds[slot]);
+            if (r.size.x < threshold && r.size.y < threshold)
+            {
+                cache->lod.add(r, shapes.get_color({ ShapeKind::path, slot }));
+                stats->lod_merged += 1;
+                return;
+            }
+
+            // the rectangles before the path are drawn before it
+            flush();
+            flush_lod_below(r, false);
+            paint_path(dc, trans, shapes.paths, slot, &cache->path_points);
+        }
+
+        // a small instance is merged as a single shape with the color of its symbol
+        void add_instance(u32 slot)
+        {
+            const auto r = from_world_to_screen(trans, shapes.instances.bounds[slot]);
+            if (r.size.x < threshold && r.size.y < threshold)
+            {
+                cache->lod.add(r, shapes.get_color({ ShapeKind::instance, slot }));
+                stats->lod_merged += 1;
+                return;
+            }
+
+            flush();
+            flush_lod_below(r, false);
+            paint_instance(dc, trans, shapes, slot, cache);
+        }
+
+        // the merged pixels a large shape is drawn over are drawn first
+        void flush_lod_below(const Rect& screen_rect, bool is_opaque_rect)
+        {
+            stats->lod_primitives += cache->lod.flush_below(dc, screen_rect, is_opaque_rect);
+        }
+
+        void flush()
+        {
+            auto& rects = cache->batch_rects;
+            from_world_to_screen(trans, rects.data(), rects.data(), rects.size());
+            for (std::size_t i = 0; i < rects.size(); i += 1)
+            {
+                const auto& r = rects[i];
+                const auto& color = cache->batch_colors[i];
+                if (r.size.x < threshold && r.size.y < threshold)
+                {
+                    cache->lod.add(r, color);
+                    stats->lod_merged += 1;
+                }
+                else
+                {
+                    flush_lod_below(r, color.a == 255);
+                    dc->draw_rectangle(r, Fill{ color, FillStyle::solid }, std::nullopt);
+                }
+            }
+            rects.clear();
+            cache->batch_colors.clear();
+        }
+
+        void finish()
+        {
+            flush();
+            stats->lod_primitives += cache->lod.flush(dc);
+        }
+    };
+}
+
+ShapeRenderStats render_shapes(Painter* dc, Document* document, const Settings& settings, const CanvasTransform& trans, const glm::ivec2& size, RenderCache* cache, const IdSet* hidden)
+{
+    ShapeRenderStats stats;
+
+    // the slots are sorted so this paints in creation order
+    document->shapes.ensure_z_order();
+    const auto& shapes = document->shapes;
+    const auto& rectangles = shapes.rectangles;
+    const auto& paths = shapes.paths;
+    const auto& instances = shapes.instances;
+    const auto is_hidden = [hidden](Id id) { return hidden != nullptr && hidden->contains(id); };
+    ShapeBatch batch{ dc, settings, trans, size, shapes, cache, &stats };
+
+    // the shapes still in the loaded file are interleaved with the edited shapes on id
+    const auto view = from_screen_to_world(trans, Rect{ {0, 0}, size });
+    const DocumentFile* base = document->base.get();
+    auto& visible_base = cache->visible_base;
+    visible_base.clear();
+    if (base != nullptr)
+    {
+        if (view.contains(base->get_bounds()))
+        {
+            for (u32 index = 0; index < base->size(); index += 1)
+            {
+                if (document->is_base_hidden(index) == false)
+                {
+                    visible_base.push_back(index);
+                }
+            }
+        }
+        else
+        {
+            base->query_intersecting(view, [&](u32 index)
+            {
+                if (document->is_base_hidden(index) == false)
+                {
+                    visible_base.push_back(index);
+                }
+            });
+            std::sort(visible_base.begin(), visible_base.end());
+        }
+    }
+
+    std::size_t next_base = 0;
+    const auto paint_base_before = [&](u64 id)
+    {
+        for (; next_base < visible_base.size() && base->get_id(visible_base[next_base]).id < id; next_base += 1)
+        {
+            const auto index = visible_base[next_base];
+            if (is_hidden(base->get_id(index)) == false)
+            {
+                batch.add(base->get_rect(index), base->get_color(index));
+                stats.drawn += 1;
+            }
+        }
+    };
+
+    // the paths are interleaved the same way, each one after the file shapes below it
+    auto& visible_paths = cache->visible_paths;
+    std::size_t next_path = 0;
+    const auto paint_paths_before = [&](u64 id)
+    {
+        for (; next_path < visible_paths.size() && paths.ids[visible_paths[next_path]].id < id; next_path += 1)
+        {
+            const auto slot = visible_paths[next_path];
+            paint_base_before(paths.ids[slot].id);
+            if (is_hidden(paths.ids[slot]) == false)
+            {
+                batch.add_path(slot);
+                stats.drawn += 1;
+            }
+        }
+    };
+    // and the instances, each one after the paths and file shapes below it
+    auto& visible_instances = cache->visible_instances;
+    std::size_t next_instance = 0;
+    const auto paint_instances_before = [&](u64 id)
+    {
+        for (; next_instance < visible_instances.size() && instances.ids[visible_instances[next_instance]].id < id; next_instance += 1)
+        {
+            const auto slot = visible_instances[next_instance];
+            paint_paths_before(instances.ids[slot].id);
+            paint_base_before(instances.ids[slot].id);
+            if (is_hidden(instances.ids[slot]) == false)
+            {
+                batch.add_instance(slot);
+                stats.drawn += 1;
+            }
+        }
+    };
+    const auto paint_slot = [&](u32 slot)
+    {
+        paint_instances_before(rectangles.ids[slot].id);
+        paint_paths_before(rectangles.ids[slot].id);
+        paint_base_before(rectangles.ids[slot].id);
+        if (is_hidden(rectangles.ids[slot]) == false)
+        {
+            batch.add(rectangles.rects[slot], rectangles.colors[slot]);
+            stats.drawn += 1;
+        }
+    };
+
+    // the hidden shapes are in the view but neither drawn nor culled
+    std::size_t in_view = 0;
+    visible_paths.clear();
+    visible_instances.clear();
+    if (view.contains(document->index.get_bounds()))
+    {
+        for (u32 slot = 0; slot < paths.size(); slot += 1)
+        {
+            visible_paths.push_back(slot);
+        }
+        for (u32 slot = 0; slot < instances.size(); slot += 1)
+        {
+            visible_instances.push_back(slot);
+        }
+        for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+        {
+            paint_slot(slot);
+        }
+        in_view = rectangles.size();
+    }
+    else
+    {
+        auto& visible_rectangles = cache->visible_rectangles;
+        visible_rectangles.clear();
+        document->index.query_intersecting(view, [&](Id id, const Rect&)
+        {
+            const auto ref = shapes.find(id);
+            if (ref.kind == ShapeKind::rectangle)
+            {
+                visible_rectangles.push_back(ref.slot);
+            }
+            else if (ref.kind == ShapeKind::path)
+            {
+                visible_paths.push_back(ref.slot);
+            }
+            else if (ref.kind == ShapeKind::instance)
+            {
+                visible_instances.push_back(ref.slot);
+            }
+        });
+        std::sort(visible_rectangles.begin(), visible_rectangles.end());
+        std::sort(visible_paths.begin(), visible_paths.end());
+        std::sort(visible_instances.begin(), visible_instances.end());
+
+        for (const auto slot : visible_rectangles)
+        {
+            paint_slot(slot);
+        }
+        in_view = visible_rectangles.size();
+    }
+    paint_instances_before(std::numeric_limits<u64>::max());
+    paint_paths_before(std::numeric_limits<u64>::max());
+    paint_base_before(std::numeric_limits<u64>::max());
+    in_view += visible_paths.size() + visible_instances.size() + visible_base.size();
+    stats.culled = static_cast<int>(document->size() - in_view);
+
+    batch.finish();
+    return stats;
+}
+
+ShapeRenderStats count_shapes(const Document& document, const CanvasTransform& trans, const glm::ivec2& size, const IdSet* hidden)
+{
+    ShapeRenderStats stats;
+    const auto is_hidden = [hidden](Id id) { return hidden != nullptr && hidden->contains(id); };
+    const auto view = from_screen_to_world(trans, Rect{ {0, 0}, size });
+
+    std::size_t in_view = 0;
+    document.index.query_intersecting(view, [&](Id id, const Rect&)
+    {
+        in_view += 1;
+        if (is_hidden(id) == false)
+        {
+            stats.drawn += 1;
+        }
+    });
+    if (const DocumentFile* base = document.base.get())
+    {
+        base->query_intersecting(view, [&](u32 index)
+        {
+            if (document.is_base_hidden(index) == false)
+            {
+                in_view += 1;
+                if (is_hidden(base->get_id(index)) == false)
+                {
+                    stats.drawn += 1;
+                }
+            }
+        });
+    }
+    stats.culled = static_cast<int>(document.size() - in_view);
+    return stats;
+}
+
+ShapeRenderStats render_shape_set(Painter* dc, const Document& document, const Settings& settings, const CanvasTransform& trans, const glm::ivec2& size, const Rect& area, const IdSet& ids, RenderCache* cache)
+{
+    ShapeRenderStats stats;
+    ShapeBatch batch{ dc, settings, trans, size, document.shapes, cache, &stats };
+
+    const auto view = from_screen_to_world(trans, area);
+    for (const auto id : ids)
+    {
+        const auto ref = document.shapes.find(id);
+        switch (ref.kind)
+        {
+        case ShapeKind::rectangle:
+            if (view.intersects(document.shapes.rectangles.rects[ref.slot]))
+            {
+                batch.add(document.shapes.rectangles.rects[ref.slot], document.shapes.rectangles.colors[ref.slot]);
+                stats.drawn += 1;
+            }
+            break;
+        case ShapeKind::path:
+            if (view.intersects(document.shapes.paths.bounds[ref.slot]))
+            {
+                batch.add_path(ref.slot);
+                stats.drawn += 1;
+            }
+            break;
+        case ShapeKind::instance:
+            if (view.intersects(document.shapes.instances.bounds[ref.slot]))
+            {
+                batch.add_instance(ref.slot);
+                stats.drawn += 1;
+            }
+            break;
+        case ShapeKind::none:
+            // not edited since it was loaded, the file only has rectangles
+            if (const auto found = document.find_base(id))
+            {
+                if (view.intersects(document.base->get_rect(*found)))
+                {
+                    batch.add(document.base->get_rect(*found), document.base->get_color(*found));
+                    stats.drawn += 1;
+                }
+            }
+            break;
+        }
+    }
+    stats.culled = static_cast<int>(ids.size()) - stats.drawn;
+
+    batch.finish();
+    return stats;
+}
+
+ShapeRenderStats render_scene(Painter* dc, Document* document, const Settings& settings, const CanvasTransform& t, const glm::ivec2& size, RenderCache* cache, const IdSet* hidden)
+{
+    {
+        VECY_PROFILE_SCOPE("clear");
+        dc->clear(settings.background_color);
+    }
+    {
+        VECY_PROFILE_SCOPE("grid");
+        render_grid(dc, settings, t, size);
+    }
+    VECY_PROFILE_SCOPE("shapes");
+    return render_shapes(dc, document, settings, t, size, cache, hidden);
+}
+
+void render_handles
+(
+    Painter* dc, const Document& document, const Settings& settings, const CanvasTransform& trans, const glm::ivec2& size,
+    const IdSet& selection, const IdSet& hovers, RenderCache* cache
+)
+{
+    VECY_PROFILE_SCOPE("handles");
+
+    // the handles reach a bit outside of the shape
+    dc->begin_batch(BatchOrder::any);
+    const auto view = from_screen_to_world(trans, Rect{ {0, 0}, size });
+    const auto handle_view = view.extend(settings.handle_radius / trans.scale);
+
+    // collect the visible rects and move them to screen space together
+    auto& rects = cache->handle_rects;
+    rects.clear();
+    const auto add_handles = [&](const Id& id)
+    {
+        const auto ref = document.shapes.find(id);
+        if (ref.kind == ShapeKind::none)
+        {
+            // not edited since it was loaded, the file only has rectangles
+            const auto found = document.find_base(id);
+            if (found.has_value() == false) { assert(false); return; }
+
+            const auto rect = document.base->get_rect(*found);
+            if (handle_view.intersects(rect))
+            {
+                rects.push_back(rect);
+            }
+            return;
+        }
+
+        switch (ref.kind)
+        {
+        case ShapeKind::rectangle:
+            if (handle_view.intersects(document.shapes.rectangles.rects[ref.slot]))
+            {
+                rects.push_back(document.shapes.rectangles.rects[ref.slot]);
+            }
+            break;
+        case ShapeKind::path:
+            if (handle_view.intersects(document.shapes.paths.bounds[ref.slot]))
+            {
+                rects.push_back(document.shapes.paths.bounds[ref.slot]);
+            }
+            break;
+        case ShapeKind::instance:
+            if (handle_view.intersects(document.shapes.instances.bounds[ref.slot]))
+            {
+                rects.push_back(document.shapes.instances.bounds[ref.slot]);
+            }
+            break;
+        case ShapeKind::none:
+            assert(false);
+            break;
+        }
+    };
+    for (const auto& id : selection)
+    {
+        add_handles(id);
+    }
+    for (const auto& id : hovers)
+    {
+        if (selection.contains(id) == false)
+        {
+            add_handles(id);
+        }
+    }
+
+    from_world_to_screen(trans, rects.data(), rects.data(), rects.size());
+    for (const auto& r : rects)
+    {
+        paint_handles(dc, settings, r);
+    }
+}
+
+void render_selection_box(Painter* dc, const Settings& settings, const Rect& r, bool is_positive)
+{
+    VECY_PROFILE_SCOPE("selection box");
+    dc->begin_batch(BatchOrder::keep);
+
+    const auto selection_fill = is_positive ? settings.selection_fill_positive : settings.selection_fill_negative;
+    const auto selection_border = is_positive ? settings.selection_border_positive : settings.selection_border_negative;
+    dc->draw_rectangle
+    (
+        r,
+        get_or_not(selection_fill, settings.draw_selection_fill),
+        get_or_not(selection_border, settings.draw_selection_border)
+    );
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/vec2.hpp"
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/canvas_transform.h"
+#include "vecy/settings.h"
+#include "vecy/painter.h"
+#include "vecy/document.h"
+#include "vecy/id_set.h"
+
+struct ShapeRenderStats
+{
+    // shapes painted and skipped because they were outside of the view, hidden shapes are neither
+    int drawn = 0;
+    int culled = 0;
+
+    // of the drawn shapes, the ones too small to draw on their own and the primitives they were merged into
+    int lod_merged = 0;
+    int lod_primitives = 0;
+};
+
+// Shapes that cover less than a pixel blended together per screen pixel, in the order they are added.
+// Each touched pixel becomes a single primitive, runs of equal pixels on a row are merged further.
+struct LodAccumulator
+{
+    // premultiplied color and coverage
+    struct Cell
+    {
+        float r = 0.0f;
+        float g = 0.0f;
+        float b = 0.0f;
+        float a = 0.0f;
+    };
+
+    glm::ivec2 size = { 0, 0 };
+    std::vector<Cell> cells;
+    std::vector<u32> touched;
+
+    // a bit for each cell with coverage, so flush_below only reads the cells it has to draw
+    int words_per_row = 0;
+    std::vector<u64> coverage_bits;
+
+    // the touched pixels are inside [touched_min, touched_max)
+    glm::ivec2 touched_min = { 0, 0 };
+    glm::ivec2 touched_max = { 0, 0 };
+
+    void reset(const glm::ivec2& new_size);
+
+    // blend a small shape into the pixel under its center
+    void add(const Rect& screen_rect, const Rgba& color);
+
+    // draw the touched pixels a shape in the rect is drawn over, so they stay below it, and start over on them.
+    // the pixels entirely inside an opaque rect are dropped instead. returns the number of primitives
+    int flush_below(Painter* dc, const Rect& screen_rect, bool is_opaque_rect);
+
+    // draw the touched pixels and start over, returns the number of primitives
+    int flush(Painter* dc);
+};
+
+// the shapes of a symbol drawn at the scale of a zoom level with the origin of the symbol at 0,
+// every instance within the level draws it moved and scaled a bit instead of drawing the shapes again
+struct SymbolRecording
+{
+    u64 symbol_key = 0;
+    int level = no_flatten_level;
+    DrawCommandList commands;
+};
+
+// how much memory the scratch buffers hold on to
+struct ScratchStats
+{
+    // allocated, whether it's used or not
+    std::size_t reserved_bytes = 0;
+    // what the last render used
+    std::size_t live_bytes = 0;
+};
+
+// scratch memory reused between frames to avoid allocating
+struct RenderCache
+{
+    std::vector<u32> visible_rectangles;
+    std::vector<u32> visible_paths;
+    std::vector<u32> visible_instances;
+    std::vector<u32> visible_base;
+    LodAccumulator lod;
+
+    // the flattened path being drawn, in screen space
+    std::vector<glm::vec2> path_points;
+
+    // visible shapes in paint order, moved to screen space a batch at a time
+    std::vector<Rect> batch_rects;
+    std::vector<Rgba> batch_colors;
+
+    // the selected and hovered shapes that get handles, in screen space
+    std::vector<Rect> handle_rects;
+
+    // by symbol index, the few zoom levels each symbol was last drawn at
+    std::vector<std::vector<SymbolRecording>> symbol_recordings;
+
+    // how many times a symbol has been recorded, to see how well the recordings are reused
+    std::size_t symbol_record_count = 0;
+
+    [[nodiscard]] ScratchStats get_stats() const;
+};
+
+void paint_rectangle(Painter* dc, const CanvasTransform& t, const Rect& rect, const Rgba& color);
+
+// the flattening cached for the zoom level is moved to screen space in the points
+void paint_path(Painter* dc, const CanvasTransform& t, const PathArray& paths, u32 slot, std::vector<glm::vec2>* points);
+// the symbol recorded for the zoom level is replayed where the instance is
+void paint_instance(Painter* dc, const CanvasTransform& t, const ShapeStore& store, u32 slot, RenderCache* cache);
+void paint_rectangle_selected(Painter* dc, const CanvasTransform& t, const Settings& settings, const Rect& rect);
+
+// the handles on the corners of a rect that is already in screen space
+void paint_handles(Painter* dc, const Settings& settings, const Rect& screen_rect);
+void paint_selected(Painter* dc, const CanvasTransform& t, const Settings& settings, const ShapeStore& store, const ShapeRef& ref);
+
+void render_grid(Painter* dc, const Settings& settings, const CanvasTransform& t, const glm::ivec2& size);
+
+// paint the shapes inside the view in creation order, except the hidden ones
+ShapeRenderStats render_shapes(Painter* dc, Document* document, const Settings& settings, const CanvasTransform& t, const glm::ivec2& size, RenderCache* cache, const IdSet* hidden = nullptr);
+
+// the drawn and culled counts render_shapes would give for the view, without drawing anything.
+// a view drawn in several parts, like tiles, gets its counts from this instead of adding up the parts
+ShapeRenderStats count_shapes(const Document& document, const CanvasTransform& t, const glm::ivec2& size, const IdSet* hidden = nullptr);
+
+// clears to the background and draws the grid and the shapes, everything below the selection
+ShapeRenderStats render_scene(Painter* dc, Document* document, const Settings& settings, const CanvasTransform& t, const glm::ivec2& size, RenderCache* cache, const IdSet* hidden = nullptr);
+
+// paint only the shapes in the set that are inside the screen area, in the order of the set.
+// sort the set first to paint in creation order
+ShapeRenderStats render_shape_set(Painter* dc, const Document& document, const Settings& settings, const CanvasTransform& t, const glm::ivec2& size, const Rect& area, const IdSet& ids, RenderCache* cache);
+
+void render_handles
+(
+    Painter* dc, const Document& document, const Settings& settings, const CanvasTransform& t, const glm::ivec2& size,
+    const IdSet& selection, const IdSet& hovers, RenderCache* cache
+);
+
+void render_selection_box(Painter* dc, const Settings& settings, const Rect& r, bool is_positive);
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "open-color.h"
+
+#include "vecy/types.h"
+
+struct Rgba
+{
+    u8 r;
+    u8 g;
+    u8 b;
+    u8 a;
+
+    Rgba(open_color::Hex h, u8 aa = 255)
+        : r((h >> 16) & 0xFF)
+        , g((h >> 8) & 0xFF)
+        , b((h) & 0xFF)
+        , a(aa)
+    {
+    }
+};
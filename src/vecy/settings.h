@@ -0,0 +1,31 @@
+#pragma once
+
+#include "open-color.h"
+
+#include "vecy/rgba.h"
+#include "vecy/style.h"
+
+struct Settings
+{
+    Rgba background_color = open_color::gray_9;
+    Rgba grid_color = open_color::green_9;
+    Fill handle_color = { open_color::violet_9, FillStyle::solid };
+
+
+    // posive: only fully enclosed are selected
+    // negative: also include intersecting
+    bool draw_selection_border = true;
+    Outline selection_border_positive = {open_color::gray_3, 1, LineStyle::solid};
+    Outline selection_border_negative = {open_color::gray_3, 1, LineStyle::long_dash};
+
+    bool draw_selection_fill = true;
+    Fill selection_fill_positive = Fill{ Rgba{open_color::blue_9}, FillStyle::bdiagonal_hatch};
+    Fill selection_fill_negative = Fill{ Rgba{open_color::green_9}, FillStyle::fdiagonal_hatch};
+
+    float handle_radius = 5.0f;
+
+    // shapes smaller than this many pixels on screen are merged per pixel instead of drawn one by one, 0 draws everything.
+    // only for painters that want it, see Painter::wants_lod. off until it's measured to pay off on the wx painter,
+    // on the rasterizer merging was slower than drawing at every zoom in the lod benchmark
+    float lod_pixel_threshold = 0.0f;
+};
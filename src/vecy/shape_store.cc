@@ -0,0 +1,534 @@
+#include "vecy/shape_store.h"
+
+#include <cmath>
+#include <cassert>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+namespace
+{
+    template<typename T>
+    void permute_vector(std::vector<T>* v, const std::vector<u32>& order)
+    {
+        std::vector<T> r;
+        r.reserve(v->size());
+        for (const auto i : order)
+        {
+            r.push_back(std::move((*v)[i]));
+        }
+        *v = std::move(r);
+    }
+
+    template<typename T>
+    std::size_t get_capacity_bytes(const std::vector<T>& v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+
+    template<typename T>
+    void swap_remove_vector(std::vector<T>* v, u32 slot)
+    {
+        if (slot + 1 != v->size())
+        {
+            (*v)[slot] = std::move(v->back());
+        }
+        v->pop_back();
+    }
+
+    // the order that sorts the slots of an array on id
+    std::vector<u32> get_id_order(const std::vector<Id>& ids)
+    {
+        std::vector<u32> order(ids.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&ids](u32 lhs, u32 rhs)
+        {
+            return ids[lhs].id < ids[rhs].id;
+        });
+        return order;
+    }
+
+    // only increases, see Symbol::key
+    u64 next_symbol_key = 1;
+}
+
+void RectangleArray::reserve(std::size_t count)
+{
+    ids.reserve(count);
+    rects.reserve(count);
+    colors.reserve(count);
+}
+
+u32 RectangleArray::push_back(const RectangleShape& shape)
+{
+    const auto slot = static_cast<u32>(ids.size());
+    ids.push_back(shape.id);
+    rects.push_back(shape.rect);
+    colors.push_back(shape.color);
+    return slot;
+}
+
+bool RectangleArray::swap_remove(u32 slot)
+{
+    const auto last = static_cast<u32>(ids.size() - 1);
+    if (slot != last)
+    {
+        ids[slot] = ids[last];
+        rects[slot] = rects[last];
+        colors[slot] = colors[last];
+    }
+    ids.pop_back();
+    rects.pop_back();
+    colors.pop_back();
+    return slot != last;
+}
+
+void RectangleArray::permute(const std::vector<u32>& order)
+{
+    assert(order.size() == ids.size());
+    permute_vector(&ids, order);
+    permute_vector(&rects, order);
+    permute_vector(&colors, order);
+}
+
+Rect get_path_bounds(const PathShape& shape)
+{
+    const auto bounds = shape.geometry.get_bounds();
+    return shape.outline ? bounds.extend(static_cast<float>(shape.outline->width) * 0.5f) : bounds;
+}
+
+const FlattenedPath& PathArray::get_flattened(u32 slot, float scale) const
+{
+    auto& cached = flattenings[slot];
+    const auto level = get_flatten_level(scale);
+    if (cached.level != level)
+    {
+        flatten_path(geometries[slot], get_flatten_tolerance(level), &cached.flattened);
+        cached.level = level;
+        flatten_count += 1;
+    }
+    return cached.flattened;
+}
+
+void PathArray::reserve(std::size_t count)
+{
+    ids.reserve(count);
+    geometries.reserve(count);
+    fills.reserve(count);
+    outlines.reserve(count);
+    bounds.reserve(count);
+    flattenings.reserve(count);
+}
+
+u32 PathArray::push_back(const PathShape& shape)
+{
+    const auto slot = static_cast<u32>(ids.size());
+    ids.push_back(shape.id);
+    geometries.push_back(shape.geometry);
+    fills.push_back(shape.fill);
+    outlines.push_back(shape.outline);
+    bounds.push_back(get_path_bounds(shape));
+    flattenings.emplace_back();
+    return slot;
+}
+
+void PathArray::set(u32 slot, const PathShape& shape)
+{
+    geometries[slot] = shape.geometry;
+    fills[slot] = shape.fill;
+    outlines[slot] = shape.outline;
+    bounds[slot] = get_path_bounds(shape);
+    flattenings[slot].level = no_flatten_level;
+}
+
+void PathArray::translate(u32 slot, const glm::vec2& delta)
+{
+    geometries[slot].translate(delta);
+    bounds[slot].topleft += delta;
+
+    // moving doesn't change how fine the flattening needs to be
+    flattenings[slot].flattened.translate(delta);
+}
+
+bool PathArray::swap_remove(u32 slot)
+{
+    const auto last = static_cast<u32>(ids.size() - 1);
+    swap_remove_vector(&ids, slot);
+    swap_remove_vector(&geometries, slot);
+    swap_remove_vector(&fills, slot);
+    swap_remove_vector(&outlines, slot);
+    swap_remove_vector(&bounds, slot);
+    swap_remove_vector(&flattenings, slot);
+    return slot != last;
+}
+
+void PathArray::permute(const std::vector<u32>& order)
+{
+    assert(order.size() == ids.size());
+    permute_vector(&ids, order);
+    permute_vector(&geometries, order);
+    permute_vector(&fills, order);
+    permute_vector(&outlines, order);
+    permute_vector(&bounds, order);
+    permute_vector(&flattenings, order);
+}
+
+std::size_t PathArray::get_memory_usage() const
+{
+    std::size_t bytes
+        = get_capacity_bytes(ids)
+        + get_capacity_bytes(geometries)
+        + get_capacity_bytes(fills)
+        + get_capacity_bytes(outlines)
+        + get_capacity_bytes(bounds)
+        + get_capacity_bytes(flattenings)
+        ;
+    for (std::size_t slot = 0; slot < ids.size(); slot += 1)
+    {
+        bytes += get_capacity_bytes(geometries[slot].verbs) + get_capacity_bytes(geometries[slot].points);
+        bytes += get_capacity_bytes(flattenings[slot].flattened.points) + get_capacity_bytes(flattenings[slot].flattened.contours);
+    }
+    return bytes;
+}
+
+void Symbol::add_rectangle(const Rgba& c, const Rect& rect)
+{
+    rectangles.push_back({ Id{ size() }, c, rect });
+    include(rect, c);
+}
+
+void Symbol::add_path(PathGeometry geometry, const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    const auto slot = paths.push_back({ Id{ size() }, std::move(geometry), fill, outline });
+    include(paths.bounds[slot], fill ? fill->color : outline ? outline->color : Rgba{ open_color::black, 0 });
+}
+
+void Symbol::include(const Rect& shape_bounds, const Rgba& shape_color)
+{
+    if (size() == 1) { bounds = shape_bounds; }
+    else { bounds.include(shape_bounds); }
+
+    const float area = std::abs(shape_bounds.size.x * shape_bounds.size.y);
+    if (area > color_area)
+    {
+        color = shape_color;
+        color_area = area;
+    }
+}
+
+std::size_t Symbol::get_memory_usage() const
+{
+    return sizeof(Symbol)
+        + get_capacity_bytes(rectangles.ids)
+        + get_capacity_bytes(rectangles.rects)
+        + get_capacity_bytes(rectangles.colors)
+        + paths.get_memory_usage()
+        ;
+}
+
+Rect get_instance_bounds(const Symbol& symbol, const glm::vec2& offset, float scale)
+{
+    return { offset + symbol.bounds.topleft * scale, symbol.bounds.size * scale };
+}
+
+void InstanceArray::reserve(std::size_t count)
+{
+    ids.reserve(count);
+    symbols.reserve(count);
+    offsets.reserve(count);
+    scales.reserve(count);
+    colors.reserve(count);
+    bounds.reserve(count);
+}
+
+u32 InstanceArray::push_back(const InstanceShape& shape, const Rect& world_bounds)
+{
+    const auto slot = static_cast<u32>(ids.size());
+    ids.push_back(shape.id);
+    symbols.push_back(shape.symbol);
+    offsets.push_back(shape.offset);
+    scales.push_back(shape.scale);
+    colors.push_back(shape.color);
+    bounds.push_back(world_bounds);
+    return slot;
+}
+
+bool InstanceArray::swap_remove(u32 slot)
+{
+    const auto last = static_cast<u32>(ids.size() - 1);
+    swap_remove_vector(&ids, slot);
+    swap_remove_vector(&symbols, slot);
+    swap_remove_vector(&offsets, slot);
+    swap_remove_vector(&scales, slot);
+    swap_remove_vector(&colors, slot);
+    swap_remove_vector(&bounds, slot);
+    return slot != last;
+}
+
+void InstanceArray::permute(const std::vector<u32>& order)
+{
+    assert(order.size() == ids.size());
+    permute_vector(&ids, order);
+    permute_vector(&symbols, order);
+    permute_vector(&offsets, order);
+    permute_vector(&scales, order);
+    permute_vector(&colors, order);
+    permute_vector(&bounds, order);
+}
+
+u32 ShapeStore::add_symbol(Symbol symbol)
+{
+    symbol.key = next_symbol_key;
+    next_symbol_key += 1;
+    symbols.push_back(std::move(symbol));
+    return static_cast<u32>(symbols.size() - 1);
+}
+
+void ShapeStore::add(const RectangleShape& shape)
+{
+    const auto ref = find(shape.id);
+    if (ref.kind == ShapeKind::rectangle)
+    {
+        rectangles.rects[ref.slot] = shape.rect;
+        rectangles.colors[ref.slot] = shape.color;
+        return;
+    }
+    assert(ref.kind == ShapeKind::none);
+
+    const auto slot = rectangles.push_back(shape);
+    if (slot > 0 && rectangles.ids[slot - 1].id > shape.id.id)
+    {
+        z_ordered = false;
+    }
+    set_ref(shape.id, { ShapeKind::rectangle, slot });
+}
+
+void ShapeStore::add(const PathShape& shape)
+{
+    const auto ref = find(shape.id);
+    if (ref.kind == ShapeKind::path)
+    {
+        paths.set(ref.slot, shape);
+        return;
+    }
+    assert(ref.kind == ShapeKind::none);
+
+    const auto slot = paths.push_back(shape);
+    if (slot > 0 && paths.ids[slot - 1].id > shape.id.id)
+    {
+        z_ordered = false;
+    }
+    set_ref(shape.id, { ShapeKind::path, slot });
+}
+
+void ShapeStore::add(const InstanceShape& shape)
+{
+    assert(shape.symbol < symbols.size() && shape.scale > 0.0f);
+    const auto bounds = get_instance_bounds(symbols[shape.symbol], shape.offset, shape.scale);
+    const auto ref = find(shape.id);
+    if (ref.kind == ShapeKind::instance)
+    {
+        instances.symbols[ref.slot] = shape.symbol;
+        instances.offsets[ref.slot] = shape.offset;
+        instances.scales[ref.slot] = shape.scale;
+        instances.colors[ref.slot] = shape.color;
+        instances.bounds[ref.slot] = bounds;
+        return;
+    }
+    assert(ref.kind == ShapeKind::none);
+
+    const auto slot = instances.push_back(shape, bounds);
+    if (slot > 0 && instances.ids[slot - 1].id > shape.id.id)
+    {
+        z_ordered = false;
+    }
+    set_ref(shape.id, { ShapeKind::instance, slot });
+}
+
+bool ShapeStore::remove(Id id)
+{
+    const auto ref = find(id);
+    switch (ref.kind)
+    {
+    case ShapeKind::none:
+        return false;
+    case ShapeKind::rectangle:
+        if (rectangles.swap_remove(ref.slot))
+        {
+            sparse[rectangles.ids[ref.slot].id].slot = ref.slot;
+            z_ordered = false;
+        }
+        break;
+    case ShapeKind::path:
+        if (paths.swap_remove(ref.slot))
+        {
+            sparse[paths.ids[ref.slot].id].slot = ref.slot;
+            z_ordered = false;
+        }
+        break;
+    case ShapeKind::instance:
+        if (instances.swap_remove(ref.slot))
+        {
+            sparse[instances.ids[ref.slot].id].slot = ref.slot;
+            z_ordered = false;
+        }
+        break;
+    }
+
+    sparse[id.id] = {};
+    return true;
+}
+
+void ShapeStore::clear()
+{
+    rectangles = {};
+    paths = {};
+    instances = {};
+    symbols.clear();
+    sparse.clear();
+    z_ordered = true;
+}
+
+Rect ShapeStore::get_bounds(const ShapeRef& ref) const
+{
+    switch (ref.kind)
+    {
+    case ShapeKind::rectangle:
+        return rectangles.rects[ref.slot];
+    case ShapeKind::path:
+        return paths.bounds[ref.slot];
+    case ShapeKind::instance:
+        return instances.bounds[ref.slot];
+    case ShapeKind::none:
+    default:
+        assert(false);
+        return { {0, 0}, {0, 0} };
+    }
+}
+
+Rgba ShapeStore::get_color(const ShapeRef& ref) const
+{
+    switch (ref.kind)
+    {
+    case ShapeKind::rectangle:
+        return rectangles.colors[ref.slot];
+    case ShapeKind::path:
+        if (const auto& fill = paths.fills[ref.slot]) { return fill->color; }
+        if (const auto& outline = paths.outlines[ref.slot]) { return outline->color; }
+        return { open_color::black, 0 };
+    case ShapeKind::instance:
+        return instances.colors[ref.slot].value_or(symbols[instances.symbols[ref.slot]].color);
+    case ShapeKind::none:
+    default:
+        assert(false);
+        return { open_color::black, 0 };
+    }
+}
+
+void ShapeStore::set_color(const ShapeRef& ref, const Rgba& color)
+{
+    switch (ref.kind)
+    {
+    case ShapeKind::rectangle:
+        rectangles.colors[ref.slot] = color;
+        break;
+    case ShapeKind::path:
+        // the fill is what the color shows, an outline only path is recolored instead
+        if (auto& fill = paths.fills[ref.slot]) { fill->color = color; }
+        else if (auto& outline = paths.outlines[ref.slot]) { outline->color = color; }
+        break;
+    case ShapeKind::instance:
+        instances.colors[ref.slot] = color;
+        break;
+    case ShapeKind::none:
+        assert(false);
+        break;
+    }
+}
+
+void ShapeStore::set_bounds(const ShapeRef& ref, const Rect& bounds)
+{
+    switch (ref.kind)
+    {
+    case ShapeKind::rectangle:
+        rectangles.rects[ref.slot] = bounds;
+        break;
+    case ShapeKind::path:
+        paths.translate(ref.slot, bounds.topleft - paths.bounds[ref.slot].topleft);
+        break;
+    case ShapeKind::instance:
+    {
+        const auto delta = bounds.topleft - instances.bounds[ref.slot].topleft;
+        instances.offsets[ref.slot] += delta;
+        instances.bounds[ref.slot].topleft += delta;
+        break;
+    }
+    case ShapeKind::none:
+        assert(false);
+        break;
+    }
+}
+
+void ShapeStore::ensure_z_order()
+{
+    if (z_ordered)
+    {
+        return;
+    }
+
+    rectangles.permute(get_id_order(rectangles.ids));
+    for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+    {
+        sparse[rectangles.ids[slot].id].slot = slot;
+    }
+
+    paths.permute(get_id_order(paths.ids));
+    for (u32 slot = 0; slot < paths.size(); slot += 1)
+    {
+        sparse[paths.ids[slot].id].slot = slot;
+    }
+
+    instances.permute(get_id_order(instances.ids));
+    for (u32 slot = 0; slot < instances.size(); slot += 1)
+    {
+        sparse[instances.ids[slot].id].slot = slot;
+    }
+
+    z_ordered = true;
+}
+
+std::size_t ShapeStore::get_memory_usage() const
+{
+    return get_capacity_bytes(rectangles.ids)
+        + get_capacity_bytes(rectangles.rects)
+        + get_capacity_bytes(rectangles.colors)
+        + paths.get_memory_usage()
+        + get_capacity_bytes(instances.ids)
+        + get_capacity_bytes(instances.symbols)
+        + get_capacity_bytes(instances.offsets)
+        + get_capacity_bytes(instances.scales)
+        + get_capacity_bytes(instances.colors)
+        + get_capacity_bytes(instances.bounds)
+        + get_capacity_bytes(sparse)
+        + get_symbol_memory_usage()
+        ;
+}
+
+std::size_t ShapeStore::get_symbol_memory_usage() const
+{
+    std::size_t bytes = get_capacity_bytes(symbols) - symbols.size() * sizeof(Symbol);
+    for (const auto& symbol : symbols)
+    {
+        bytes += symbol.get_memory_usage();
+    }
+    return bytes;
+}
+
+void ShapeStore::set_ref(Id id, const ShapeRef& ref)
+{
+    if (id.id >= sparse.size())
+    {
+        sparse.resize(id.id + 1);
+    }
+    sparse[id.id] = ref;
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/rgba.h"
+#include "vecy/style.h"
+#include "vecy/path.h"
+
+enum class ShapeKind : u8
+{
+    none, rectangle, path, instance
+};
+
+// where a shape lives in the store
+struct ShapeRef
+{
+    ShapeKind kind = ShapeKind::none;
+    u32 slot = 0;
+};
+
+struct RectangleShape
+{
+    Id id;
+    Rgba color;
+    Rect rect;
+};
+
+// all rectangles, as parallel arrays indexed by slot
+struct RectangleArray
+{
+    std::vector<Id> ids;
+    std::vector<Rect> rects;
+    std::vector<Rgba> colors;
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return ids.size();
+    }
+
+    [[nodiscard]] RectangleShape get(u32 slot) const
+    {
+        return { ids[slot], colors[slot], rects[slot] };
+    }
+
+    void reserve(std::size_t count);
+    u32 push_back(const RectangleShape& shape);
+
+    // move the last rectangle into the slot, returns false if the last one was removed
+    bool swap_remove(u32 slot);
+
+    // reorder the arrays, new slot i gets the rectangle from old slot order[i]
+    void permute(const std::vector<u32>& order);
+};
+
+// the outline width is in world units so it scales with the zoom like the path does
+struct PathShape
+{
+    Id id;
+    PathGeometry geometry;
+    std::optional<Fill> fill;
+    std::optional<Outline> outline;
+};
+
+// the flattened path for a zoom level, no_flatten_level until it is drawn or hit
+struct PathFlattening
+{
+    int level = no_flatten_level;
+    FlattenedPath flattened;
+};
+
+// all paths, as parallel arrays indexed by slot.
+// the bounds include the outline so culling and hit testing never need the curves
+struct PathArray
+{
+    std::vector<Id> ids;
+    std::vector<PathGeometry> geometries;
+    std::vector<std::optional<Fill>> fills;
+    std::vector<std::optional<Outline>> outlines;
+    std::vector<Rect> bounds;
+
+    // filled on demand when drawing and hit testing, which only read the store
+    mutable std::vector<PathFlattening> flattenings;
+
+    // how many times a path has been flattened, to see how well the cache works
+    mutable std::size_t flatten_count = 0;
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return ids.size();
+    }
+
+    [[nodiscard]] PathShape get(u32 slot) const
+    {
+        return { ids[slot], geometries[slot], fills[slot], outlines[slot] };
+    }
+
+    // the flattened path that is fine enough for the scale, flattened again
+    // only when the scale is in another level than the cached one
+    const FlattenedPath& get_flattened(u32 slot, float scale) const;
+
+    void reserve(std::size_t count);
+    u32 push_back(const PathShape& shape);
+    void set(u32 slot, const PathShape& shape);
+
+    // moves the path and its cached flattening
+    void translate(u32 slot, const glm::vec2& delta);
+
+    // move the last path into the slot, returns false if the last one was removed
+    bool swap_remove(u32 slot);
+
+    // reorder the arrays, new slot i gets the path from old slot order[i]
+    void permute(const std::vector<u32>& order);
+
+    [[nodiscard]] std::size_t get_memory_usage() const;
+};
+
+Rect get_path_bounds(const PathShape& shape);
+
+// Shapes shared by all instances of the symbol, in the local space of the symbol.
+// The ids only order the shapes within the symbol, they aren't ids in the document
+struct Symbol
+{
+    RectangleArray rectangles;
+    PathArray paths;
+
+    // of all shapes, empty until a shape is added
+    Rect bounds = { {0, 0}, {0, 0} };
+
+    // the color of the largest shape, what an instance too small to draw is merged as
+    Rgba color = { open_color::black, 0 };
+
+    // set when added to a store and never reused, so a cached drawing can tell a symbol from one that replaced it
+    u64 key = 0;
+
+    void add_rectangle(const Rgba& c, const Rect& rect);
+    void add_path(PathGeometry geometry, const std::optional<Fill>& fill, const std::optional<Outline>& outline);
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return rectangles.size() + paths.size();
+    }
+
+    [[nodiscard]] std::size_t get_memory_usage() const;
+
+private:
+    void include(const Rect& shape_bounds, const Rgba& shape_color);
+
+    float color_area = -1.0f;
+};
+
+// A symbol placed in the document, a point p of the symbol is at offset + p * scale in the world.
+// The color replaces the colors of all shapes in the symbol when set
+struct InstanceShape
+{
+    Id id;
+    u32 symbol;
+    glm::vec2 offset;
+    float scale;
+    std::optional<Rgba> color;
+};
+
+// all instances, as parallel arrays indexed by slot.
+// the bounds are the world bounds of the symbol so culling and hit testing start without looking at it
+struct InstanceArray
+{
+    std::vector<Id> ids;
+    std::vector<u32> symbols;
+    std::vector<glm::vec2> offsets;
+    std::vector<float> scales;
+    std::vector<std::optional<Rgba>> colors;
+    std::vector<Rect> bounds;
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return ids.size();
+    }
+
+    [[nodiscard]] InstanceShape get(u32 slot) const
+    {
+        return { ids[slot], symbols[slot], offsets[slot], scales[slot], colors[slot] };
+    }
+
+    void reserve(std::size_t count);
+    u32 push_back(const InstanceShape& shape, const Rect& world_bounds);
+
+    // move the last instance into the slot, returns false if the last one was removed
+    bool swap_remove(u32 slot);
+
+    // reorder the arrays, new slot i gets the instance from old slot order[i]
+    void permute(const std::vector<u32>& order);
+};
+
+Rect get_instance_bounds(const Symbol& symbol, const glm::vec2& offset, float scale);
+
+// Dense shape storage, one set of arrays per shape kind, each sorted on id when z ordered.
+// Shapes are looked up by id through a sparse array indexed by the id value,
+// removal is a swap-remove and the paint order is restored lazily by sorting on id.
+struct ShapeStore
+{
+    RectangleArray rectangles;
+    PathArray paths;
+    InstanceArray instances;
+
+    // the instances refer to the symbols by index, so a symbol is never removed
+    std::vector<Symbol> symbols;
+
+    // returns the index of the symbol
+    u32 add_symbol(Symbol symbol);
+
+    void add(const RectangleShape& shape);
+    void add(const PathShape& shape);
+    void add(const InstanceShape& shape);
+    bool remove(Id id);
+    void clear();
+
+    [[nodiscard]] ShapeRef find(Id id) const
+    {
+        if (id.id >= sparse.size())
+        {
+            return {};
+        }
+        return sparse[id.id];
+    }
+
+    [[nodiscard]] bool contains(Id id) const
+    {
+        return find(id).kind != ShapeKind::none;
+    }
+
+    [[nodiscard]] Rect get_bounds(const ShapeRef& ref) const;
+
+    // a path has the color of its fill, or of its outline if it isn't filled.
+    // an instance has its color, or the color of the symbol if it isn't recolored
+    [[nodiscard]] Rgba get_color(const ShapeRef& ref) const;
+
+    // recoloring an instance sets its color
+    void set_color(const ShapeRef& ref, const Rgba& color);
+
+    // a path or an instance is moved to the bounds, it isn't scaled
+    void set_bounds(const ShapeRef& ref, const Rect& bounds);
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return rectangles.size() + paths.size() + instances.size();
+    }
+
+    // the arrays are sorted on id unless a remove has moved shapes around
+    [[nodiscard]] bool is_z_ordered() const
+    {
+        return z_ordered;
+    }
+
+    // sort all arrays on id so iterating slots paints in creation order
+    void ensure_z_order();
+
+    // approximate heap memory used by the store, the symbols included
+    [[nodiscard]] std::size_t get_memory_usage() const;
+    [[nodiscard]] std::size_t get_symbol_memory_usage() const;
+
+private:
+    void set_ref(Id id, const ShapeRef& ref);
+
+    std::vector<ShapeRef> sparse;
+    bool z_ordered = true;
+};
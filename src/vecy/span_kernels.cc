@@ -0,0 +1,312 @@
+#include "vecy/span_kernels.h"
+
+#include "vecy/cpu.h"
+
+bool is_hatch_set(FillStyle style, int x, int y)
+{
+    // all hatches repeat every 8 pixels
+    const int hx = x & 7;
+    const int hy = y & 7;
+
+    switch (style)
+    {
+    case FillStyle::solid: return true;
+    case FillStyle::bdiagonal_hatch: return ((hx + hy) & 7) == 0;
+    case FillStyle::fdiagonal_hatch: return ((hx - hy) & 7) == 0;
+    case FillStyle::crossdiag_hatch: return ((hx + hy) & 7) == 0 || ((hx - hy) & 7) == 0;
+    case FillStyle::cross_hatch: return hx == 0 || hy == 0;
+    case FillStyle::horizontal_hatch: return hy == 0;
+    case FillStyle::vertical_hatch: return hx == 0;
+    default:
+        return true;
+    }
+}
+
+HatchRow get_hatch_row(FillStyle style, int y)
+{
+    HatchRow row;
+    for (int x = 0; x < 16; x += 1)
+    {
+        row.lanes[x] = is_hatch_set(style, x, y) ? ~u32{0} : 0;
+    }
+    return row;
+}
+
+namespace
+{
+    void scalar_fill(Pixel* dst, int count, Pixel color)
+    {
+        for (int i = 0; i < count; i += 1)
+        {
+            dst[i] = color;
+        }
+    }
+
+    void scalar_blend(Pixel* dst, int count, Pixel color)
+    {
+        for (int i = 0; i < count; i += 1)
+        {
+            dst[i] = blend_pixel(dst[i], color);
+        }
+    }
+
+    void scalar_hatch_fill(Pixel* dst, int x, int count, const HatchRow& row, Pixel color)
+    {
+        for (int i = 0; i < count; i += 1)
+        {
+            if (row.lanes[(x + i) & 7])
+            {
+                dst[i] = color;
+            }
+        }
+    }
+
+    void scalar_hatch_blend(Pixel* dst, int x, int count, const HatchRow& row, Pixel color)
+    {
+        for (int i = 0; i < count; i += 1)
+        {
+            if (row.lanes[(x + i) & 7])
+            {
+                dst[i] = blend_pixel(dst[i], color);
+            }
+        }
+    }
+
+    const SpanKernels scalar_kernels = { "scalar", scalar_fill, scalar_blend, scalar_hatch_fill, scalar_hatch_blend };
+
+#if defined(VECY_X86)
+
+    // blend_pixel on 16 bit channels, the alpha channel is blended as if src alpha was 255
+    // since sa + div255(da * ia) == div255(255 * sa + da * ia)
+    // src * sa + 128 is the same for every pixel so it's computed once
+    struct BlendTerms
+    {
+        short k[4];
+        short ia;
+    };
+
+    BlendTerms get_blend_terms(Pixel color)
+    {
+        const u32 sa = color >> 24;
+        BlendTerms terms;
+        terms.k[0] = static_cast<short>((color & 0xFF) * sa + 128);
+        terms.k[1] = static_cast<short>(((color >> 8) & 0xFF) * sa + 128);
+        terms.k[2] = static_cast<short>(((color >> 16) & 0xFF) * sa + 128);
+        terms.k[3] = static_cast<short>(255 * sa + 128);
+        terms.ia = static_cast<short>(255 - sa);
+        return terms;
+    }
+
+    // d is two pixels with 16 bit channels
+    VECY_TARGET("sse2")
+    __m128i sse2_blend2(__m128i d, __m128i k, __m128i ia)
+    {
+        const auto t = _mm_add_epi16(_mm_mullo_epi16(d, ia), k);
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    }
+
+    VECY_TARGET("sse2")
+    __m128i sse2_blend4(__m128i dst, __m128i k, __m128i ia)
+    {
+        const auto zero = _mm_setzero_si128();
+        const auto lo = sse2_blend2(_mm_unpacklo_epi8(dst, zero), k, ia);
+        const auto hi = sse2_blend2(_mm_unpackhi_epi8(dst, zero), k, ia);
+        return _mm_packus_epi16(lo, hi);
+    }
+
+    VECY_TARGET("sse2")
+    __m128i sse2_select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    VECY_TARGET("sse2")
+    void sse2_fill(Pixel* dst, int count, Pixel color)
+    {
+        const auto c = _mm_set1_epi32(static_cast<int>(color));
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), c);
+        }
+        scalar_fill(dst + i, count - i, color);
+    }
+
+    VECY_TARGET("sse2")
+    void sse2_blend(Pixel* dst, int count, Pixel color)
+    {
+        const auto terms = get_blend_terms(color);
+        const auto k = _mm_set_epi16(terms.k[3], terms.k[2], terms.k[1], terms.k[0], terms.k[3], terms.k[2], terms.k[1], terms.k[0]);
+        const auto ia = _mm_set1_epi16(terms.ia);
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            auto* p = reinterpret_cast<__m128i*>(dst + i);
+            _mm_storeu_si128(p, sse2_blend4(_mm_loadu_si128(p), k, ia));
+        }
+        scalar_blend(dst + i, count - i, color);
+    }
+
+    VECY_TARGET("sse2")
+    void sse2_hatch_fill(Pixel* dst, int x, int count, const HatchRow& row, Pixel color)
+    {
+        const auto c = _mm_set1_epi32(static_cast<int>(color));
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            auto* p = reinterpret_cast<__m128i*>(dst + i);
+            const auto mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.lanes + ((x + i) & 7)));
+            _mm_storeu_si128(p, sse2_select(mask, c, _mm_loadu_si128(p)));
+        }
+        scalar_hatch_fill(dst + i, x + i, count - i, row, color);
+    }
+
+    VECY_TARGET("sse2")
+    void sse2_hatch_blend(Pixel* dst, int x, int count, const HatchRow& row, Pixel color)
+    {
+        const auto terms = get_blend_terms(color);
+        const auto k = _mm_set_epi16(terms.k[3], terms.k[2], terms.k[1], terms.k[0], terms.k[3], terms.k[2], terms.k[1], terms.k[0]);
+        const auto ia = _mm_set1_epi16(terms.ia);
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            auto* p = reinterpret_cast<__m128i*>(dst + i);
+            const auto mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.lanes + ((x + i) & 7)));
+            const auto d = _mm_loadu_si128(p);
+            _mm_storeu_si128(p, sse2_select(mask, sse2_blend4(d, k, ia), d));
+        }
+        scalar_hatch_blend(dst + i, x + i, count - i, row, color);
+    }
+
+    VECY_TARGET("avx2")
+    __m256i avx2_blend4(__m256i d, __m256i k, __m256i ia)
+    {
+        const auto t = _mm256_add_epi16(_mm256_mullo_epi16(d, ia), k);
+        return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    }
+
+    VECY_TARGET("avx2")
+    __m256i avx2_blend8(__m256i dst, __m256i k, __m256i ia)
+    {
+        const auto zero = _mm256_setzero_si256();
+        // unpack and pack both work within 128 bit lanes so the pixel order is kept
+        const auto lo = avx2_blend4(_mm256_unpacklo_epi8(dst, zero), k, ia);
+        const auto hi = avx2_blend4(_mm256_unpackhi_epi8(dst, zero), k, ia);
+        return _mm256_packus_epi16(lo, hi);
+    }
+
+    VECY_TARGET("avx2")
+    __m256i avx2_select(__m256i mask, __m256i a, __m256i b)
+    {
+        return _mm256_or_si256(_mm256_and_si256(mask, a), _mm256_andnot_si256(mask, b));
+    }
+
+    VECY_TARGET("avx2")
+    __m256i avx2_get_k(const BlendTerms& terms)
+    {
+        return _mm256_set_epi16
+        (
+            terms.k[3], terms.k[2], terms.k[1], terms.k[0], terms.k[3], terms.k[2], terms.k[1], terms.k[0],
+            terms.k[3], terms.k[2], terms.k[1], terms.k[0], terms.k[3], terms.k[2], terms.k[1], terms.k[0]
+        );
+    }
+
+    VECY_TARGET("avx2")
+    void avx2_fill(Pixel* dst, int count, Pixel color)
+    {
+        const auto c = _mm256_set1_epi32(static_cast<int>(color));
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), c);
+        }
+        scalar_fill(dst + i, count - i, color);
+    }
+
+    VECY_TARGET("avx2")
+    void avx2_blend(Pixel* dst, int count, Pixel color)
+    {
+        const auto terms = get_blend_terms(color);
+        const auto k = avx2_get_k(terms);
+        const auto ia = _mm256_set1_epi16(terms.ia);
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            auto* p = reinterpret_cast<__m256i*>(dst + i);
+            _mm256_storeu_si256(p, avx2_blend8(_mm256_loadu_si256(p), k, ia));
+        }
+        scalar_blend(dst + i, count - i, color);
+    }
+
+    VECY_TARGET("avx2")
+    void avx2_hatch_fill(Pixel* dst, int x, int count, const HatchRow& row, Pixel color)
+    {
+        const auto c = _mm256_set1_epi32(static_cast<int>(color));
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            auto* p = reinterpret_cast<__m256i*>(dst + i);
+            const auto mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row.lanes + ((x + i) & 7)));
+            _mm256_storeu_si256(p, avx2_select(mask, c, _mm256_loadu_si256(p)));
+        }
+        scalar_hatch_fill(dst + i, x + i, count - i, row, color);
+    }
+
+    VECY_TARGET("avx2")
+    void avx2_hatch_blend(Pixel* dst, int x, int count, const HatchRow& row, Pixel color)
+    {
+        const auto terms = get_blend_terms(color);
+        const auto k = avx2_get_k(terms);
+        const auto ia = _mm256_set1_epi16(terms.ia);
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            auto* p = reinterpret_cast<__m256i*>(dst + i);
+            const auto mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row.lanes + ((x + i) & 7)));
+            const auto d = _mm256_loadu_si256(p);
+            _mm256_storeu_si256(p, avx2_select(mask, avx2_blend8(d, k, ia), d));
+        }
+        scalar_hatch_blend(dst + i, x + i, count - i, row, color);
+    }
+
+    const SpanKernels sse2_kernels = { "sse2", sse2_fill, sse2_blend, sse2_hatch_fill, sse2_hatch_blend };
+    const SpanKernels avx2_kernels = { "avx2", avx2_fill, avx2_blend, avx2_hatch_fill, avx2_hatch_blend };
+
+#endif
+}
+
+const SpanKernels& get_scalar_kernels()
+{
+    return scalar_kernels;
+}
+
+const SpanKernels* get_sse2_kernels()
+{
+#if defined(VECY_X86)
+    static const bool is_supported = has_sse2();
+    return is_supported ? &sse2_kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const SpanKernels* get_avx2_kernels()
+{
+#if defined(VECY_X86)
+    static const bool is_supported = has_avx2();
+    return is_supported ? &avx2_kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const SpanKernels& get_span_kernels()
+{
+    static const SpanKernels* best = []()
+    {
+        if (const auto* avx2 = get_avx2_kernels()) { return avx2; }
+        if (const auto* sse2 = get_sse2_kernels()) { return sse2; }
+        return &scalar_kernels;
+    }();
+    return *best;
+}
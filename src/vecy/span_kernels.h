@@ -0,0 +1,63 @@
+#pragma once
+
+#include "vecy/types.h"
+#include "vecy/style.h"
+
+// a pixel is packed as r, g, b, a from the lowest byte and up
+using Pixel = u32;
+
+// x / 255 rounded to nearest, exact for 0 <= x <= 255 * 255
+inline u32 div255(u32 x)
+{
+    return (x + 128 + ((x + 128) >> 8)) >> 8;
+}
+
+// src over dst with a non premultiplied src, the vector kernels give the same result to the bit
+inline Pixel blend_pixel(Pixel dst, Pixel src)
+{
+    const u32 sa = src >> 24;
+    const u32 ia = 255 - sa;
+
+    const auto channel = [&](int shift) -> u32
+    {
+        const u32 s = (src >> shift) & 0xFF;
+        const u32 d = (dst >> shift) & 0xFF;
+        return div255(s * sa + d * ia);
+    };
+
+    const u32 a = sa + div255((dst >> 24) * ia);
+    return channel(0) | (channel(8) << 8) | (channel(16) << 16) | (a << 24);
+}
+
+// is the hatch pattern set for the pixel, solid is always set
+bool is_hatch_set(FillStyle style, int x, int y);
+
+// the pixels of a row that a hatch pattern sets, ~0 for set and 0 for not set.
+// The 8 pixel pattern is repeated so 8 lanes can be loaded starting at any x & 7.
+struct HatchRow
+{
+    u32 lanes[16];
+};
+
+HatchRow get_hatch_row(FillStyle style, int y);
+
+// the functions the raster painter fills rows with, count pixels starting at dst.
+// x is the image column of dst and selects where in the hatch row to start
+struct SpanKernels
+{
+    const char* name;
+
+    void (*fill)(Pixel* dst, int count, Pixel color);
+    void (*blend)(Pixel* dst, int count, Pixel color);
+    void (*hatch_fill)(Pixel* dst, int x, int count, const HatchRow& row, Pixel color);
+    void (*hatch_blend)(Pixel* dst, int x, int count, const HatchRow& row, Pixel color);
+};
+
+const SpanKernels& get_scalar_kernels();
+
+// null if the kernels aren't compiled in or the cpu doesn't support them
+const SpanKernels* get_sse2_kernels();
+const SpanKernels* get_avx2_kernels();
+
+// the fastest kernels the cpu supports, picked on the first call
+const SpanKernels& get_span_kernels();
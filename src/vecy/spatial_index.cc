@@ -0,0 +1,514 @@
+#include "vecy/spatial_index.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace
+{
+    Rect combine(const Rect& a, const Rect& b)
+    {
+        auto r = a;
+        r.include(b);
+        return r;
+    }
+}
+
+void SpatialIndex::set_leaf(Id id, int leaf)
+{
+    if (id.id >= leaves.size())
+    {
+        leaves.resize(id.id + 1, null_node);
+    }
+    auto& found = leaves[id.id];
+    if (found == null_node && leaf != null_node) { leaf_count += 1; }
+    if (found != null_node && leaf == null_node) { leaf_count -= 1; }
+    found = leaf;
+}
+
+void SpatialIndex::insert(Id id, const Rect& bounds)
+{
+    if (find_leaf(id) != null_node)
+    {
+        update(id, bounds);
+        return;
+    }
+
+    const int leaf = allocate_node();
+    nodes[leaf].bounds = bounds;
+    nodes[leaf].id = id;
+    set_leaf(id, leaf);
+    insert_leaf(leaf);
+}
+
+void SpatialIndex::insert_bulk(const Id* ids, const Rect* bounds, std::size_t count)
+{
+    std::vector<BulkEntry> entries;
+    entries.reserve(count);
+
+    // only sized up front for the first build, later the freed nodes are reused first
+    // and reserving here would copy all the nodes
+    if (nodes.empty())
+    {
+        nodes.reserve(count * 2);
+    }
+    for (std::size_t i = 0; i < count; i += 1)
+    {
+        if (find_leaf(ids[i]) != null_node)
+        {
+            update(ids[i], bounds[i]);
+            continue;
+        }
+
+        const int leaf = allocate_node();
+        nodes[leaf].bounds = bounds[i];
+        nodes[leaf].id = ids[i];
+        nodes[leaf].height = 0;
+        set_leaf(ids[i], leaf);
+        entries.push_back({ bounds[i].topleft + bounds[i].size * 0.5f, leaf });
+    }
+
+    if (entries.empty())
+    {
+        return;
+    }
+
+    // when the new entries are at least as many as the old, rebuilding everything gives a better tree
+    // than hanging a big subtree somewhere in the old one
+    if (root != null_node && leaf_count <= entries.size() * 2)
+    {
+        collect_leaves(root, &entries);
+        root = null_node;
+    }
+
+    const int subtree = build_subtree(entries.data(), entries.data() + entries.size());
+    insert_leaf(subtree);
+}
+
+int SpatialIndex::build_subtree(BulkEntry* first, BulkEntry* last)
+{
+    const auto count = last - first;
+    if (count == 1)
+    {
+        return first->node;
+    }
+
+    auto centers = Rect::from_points(first->center, first->center);
+    for (auto* it = first + 1; it != last; ++it)
+    {
+        centers.include(it->center);
+    }
+    const int axis = centers.size.x >= centers.size.y ? 0 : 1;
+
+    // the centers are sorted next to the node index so the split doesn't jump around the nodes
+    auto* middle = first + count / 2;
+    std::nth_element(first, middle, last, [axis](const BulkEntry& lhs, const BulkEntry& rhs)
+    {
+        return lhs.center[axis] < rhs.center[axis];
+    });
+
+    const int left = build_subtree(first, middle);
+    const int right = build_subtree(middle, last);
+
+    // allocating may move the nodes so nothing is referenced across it
+    const int parent = allocate_node();
+    nodes[parent].parent = null_node;
+    nodes[parent].left = left;
+    nodes[parent].right = right;
+    nodes[parent].height = 1 + std::max(nodes[left].height, nodes[right].height);
+    nodes[parent].bounds = combine(nodes[left].bounds, nodes[right].bounds);
+    nodes[left].parent = parent;
+    nodes[right].parent = parent;
+    return parent;
+}
+
+void SpatialIndex::collect_leaves(int n, std::vector<BulkEntry>* leaf_list)
+{
+    NodeStack stack;
+    stack.push(n);
+    while (stack.is_empty() == false)
+    {
+        const int index = stack.pop();
+        if (nodes[index].is_leaf())
+        {
+            const auto& b = nodes[index].bounds;
+            leaf_list->push_back({ b.topleft + b.size * 0.5f, index });
+            continue;
+        }
+        stack.push(nodes[index].left);
+        stack.push(nodes[index].right);
+        free_node(index);
+    }
+}
+
+void SpatialIndex::remove(Id id)
+{
+    const int leaf = find_leaf(id);
+    if (leaf == null_node)
+    {
+        return;
+    }
+
+    set_leaf(id, null_node);
+    remove_leaf(leaf);
+    free_node(leaf);
+}
+
+void SpatialIndex::update(Id id, const Rect& bounds)
+{
+    const int leaf = find_leaf(id);
+    if (leaf == null_node)
+    {
+        insert(id, bounds);
+        return;
+    }
+
+    const auto& old = nodes[leaf].bounds;
+    if (old.topleft == bounds.topleft && old.size == bounds.size)
+    {
+        return;
+    }
+
+    remove_leaf(leaf);
+    nodes[leaf].bounds = bounds;
+    insert_leaf(leaf);
+}
+
+void SpatialIndex::refit(const Id* ids, const Rect* bounds, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i += 1)
+    {
+        const int leaf = find_leaf(ids[i]);
+        if (leaf == null_node)
+        {
+            continue;
+        }
+
+        // the tree is consistent after each entry, so the walk stops at the first ancestor
+        // that doesn't change, the move is usually too small to reach further than a few levels
+        nodes[leaf].bounds = bounds[i];
+        for (int n = nodes[leaf].parent; n != null_node; n = nodes[n].parent)
+        {
+            const auto fitted = combine(nodes[nodes[n].left].bounds, nodes[nodes[n].right].bounds);
+            if (fitted.topleft == nodes[n].bounds.topleft && fitted.size == nodes[n].bounds.size)
+            {
+                break;
+            }
+            nodes[n].bounds = fitted;
+        }
+    }
+}
+
+void SpatialIndex::clear()
+{
+    nodes.clear();
+    leaves.clear();
+    leaf_count = 0;
+    root = null_node;
+    free_list = null_node;
+}
+
+bool SpatialIndex::contains(Id id) const
+{
+    return find_leaf(id) != null_node;
+}
+
+std::optional<Rect> SpatialIndex::get_bounds(Id id) const
+{
+    const int leaf = find_leaf(id);
+    if (leaf == null_node)
+    {
+        return std::nullopt;
+    }
+    return nodes[leaf].bounds;
+}
+
+std::size_t SpatialIndex::size() const
+{
+    return leaf_count;
+}
+
+int SpatialIndex::get_height() const
+{
+    if (root == null_node)
+    {
+        return 0;
+    }
+    return nodes[root].height;
+}
+
+Rect SpatialIndex::get_bounds() const
+{
+    if (root == null_node)
+    {
+        return { {0, 0}, {0, 0} };
+    }
+    return nodes[root].bounds;
+}
+
+int SpatialIndex::allocate_node()
+{
+    if (free_list == null_node)
+    {
+        nodes.emplace_back();
+        nodes.back().height = 0;
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    const int n = free_list;
+    free_list = nodes[n].left;
+    nodes[n] = Node{};
+    nodes[n].height = 0;
+    return n;
+}
+
+void SpatialIndex::free_node(int n)
+{
+    nodes[n].left = free_list;
+    nodes[n].height = -1;
+    free_list = n;
+}
+
+void SpatialIndex::insert_leaf(int leaf)
+{
+    if (root == null_node)
+    {
+        root = leaf;
+        nodes[root].parent = null_node;
+        return;
+    }
+
+    // find the best sibling by walking down the tree using the surface area heuristic
+    const Rect leaf_bounds = nodes[leaf].bounds;
+    int index = root;
+    while (nodes[index].is_leaf() == false)
+    {
+        const Node& node = nodes[index];
+
+        const float area = node.bounds.get_perimeter();
+        const float combined_area = combine(node.bounds, leaf_bounds).get_perimeter();
+
+        // cost of creating a new parent for this node and the new leaf
+        const float cost = 2.0f * combined_area;
+
+        // minimum cost of pushing the leaf further down the tree
+        const float inheritance_cost = 2.0f * (combined_area - area);
+
+        const auto get_cost = [&](int child) -> float
+        {
+            const Node& c = nodes[child];
+            const float new_area = combine(leaf_bounds, c.bounds).get_perimeter();
+            if (c.is_leaf())
+            {
+                return new_area + inheritance_cost;
+            }
+            else
+            {
+                return (new_area - c.bounds.get_perimeter()) + inheritance_cost;
+            }
+        };
+
+        const float cost_left = get_cost(node.left);
+        const float cost_right = get_cost(node.right);
+
+        if (cost < cost_left && cost < cost_right)
+        {
+            break;
+        }
+
+        index = cost_left < cost_right ? node.left : node.right;
+    }
+
+    const int sibling = index;
+
+    const int old_parent = nodes[sibling].parent;
+    const int new_parent = allocate_node();
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].bounds = combine(leaf_bounds, nodes[sibling].bounds);
+    nodes[new_parent].height = nodes[sibling].height + 1;
+    nodes[new_parent].left = sibling;
+    nodes[new_parent].right = leaf;
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    if (old_parent != null_node)
+    {
+        if (nodes[old_parent].left == sibling)
+        {
+            nodes[old_parent].left = new_parent;
+        }
+        else
+        {
+            nodes[old_parent].right = new_parent;
+        }
+    }
+    else
+    {
+        root = new_parent;
+    }
+
+    refit_to_root(nodes[leaf].parent);
+}
+
+void SpatialIndex::remove_leaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = null_node;
+        return;
+    }
+
+    const int parent = nodes[leaf].parent;
+    const int grand_parent = nodes[parent].parent;
+    const int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    if (grand_parent != null_node)
+    {
+        if (nodes[grand_parent].left == parent)
+        {
+            nodes[grand_parent].left = sibling;
+        }
+        else
+        {
+            nodes[grand_parent].right = sibling;
+        }
+        nodes[sibling].parent = grand_parent;
+        free_node(parent);
+
+        refit_to_root(grand_parent);
+    }
+    else
+    {
+        root = sibling;
+        nodes[sibling].parent = null_node;
+        free_node(parent);
+    }
+}
+
+void SpatialIndex::refit_to_root(int n)
+{
+    int index = n;
+    while (index != null_node)
+    {
+        index = balance(index);
+
+        Node& node = nodes[index];
+        const Node& left = nodes[node.left];
+        const Node& right = nodes[node.right];
+
+        node.height = 1 + std::max(left.height, right.height);
+        node.bounds = combine(left.bounds, right.bounds);
+
+        index = node.parent;
+    }
+}
+
+int SpatialIndex::balance(int ia)
+{
+    assert(ia != null_node);
+
+    Node& a = nodes[ia];
+    if (a.is_leaf() || a.height < 2)
+    {
+        return ia;
+    }
+
+    const int ib = a.left;
+    const int ic = a.right;
+    Node& b = nodes[ib];
+    Node& c = nodes[ic];
+
+    const int balance = c.height - b.height;
+
+    const auto replace_in_parent = [this](int parent, int old_child, int new_child)
+    {
+        if (parent == null_node)
+        {
+            root = new_child;
+        }
+        else if (nodes[parent].left == old_child)
+        {
+            nodes[parent].left = new_child;
+        }
+        else
+        {
+            assert(nodes[parent].right == old_child);
+            nodes[parent].right = new_child;
+        }
+    };
+
+    // rotate c up
+    if (balance > 1)
+    {
+        const int i_f = c.left;
+        const int i_g = c.right;
+        Node& f = nodes[i_f];
+        Node& g = nodes[i_g];
+
+        c.left = ia;
+        c.parent = a.parent;
+        a.parent = ic;
+        replace_in_parent(c.parent, ia, ic);
+
+        if (f.height > g.height)
+        {
+            c.right = i_f;
+            a.right = i_g;
+            g.parent = ia;
+            a.bounds = combine(b.bounds, g.bounds);
+            c.bounds = combine(a.bounds, f.bounds);
+            a.height = 1 + std::max(b.height, g.height);
+            c.height = 1 + std::max(a.height, f.height);
+        }
+        else
+        {
+            c.right = i_g;
+            a.right = i_f;
+            f.parent = ia;
+            a.bounds = combine(b.bounds, f.bounds);
+            c.bounds = combine(a.bounds, g.bounds);
+            a.height = 1 + std::max(b.height, f.height);
+            c.height = 1 + std::max(a.height, g.height);
+        }
+
+        return ic;
+    }
+
+    // rotate b up
+    if (balance < -1)
+    {
+        const int i_d = b.left;
+        const int i_e = b.right;
+        Node& d = nodes[i_d];
+        Node& e = nodes[i_e];
+
+        b.left = ia;
+        b.parent = a.parent;
+        a.parent = ib;
+        replace_in_parent(b.parent, ia, ib);
+
+        if (d.height > e.height)
+        {
+            b.right = i_d;
+            a.left = i_e;
+            e.parent = ia;
+            a.bounds = combine(c.bounds, e.bounds);
+            b.bounds = combine(a.bounds, d.bounds);
+            a.height = 1 + std::max(c.height, e.height);
+            b.height = 1 + std::max(a.height, d.height);
+        }
+        else
+        {
+            b.right = i_e;
+            a.left = i_d;
+            d.parent = ia;
+            a.bounds = combine(c.bounds, d.bounds);
+            b.bounds = combine(a.bounds, e.bounds);
+            a.height = 1 + std::max(c.height, d.height);
+            b.height = 1 + std::max(a.height, e.height);
+        }
+
+        return ib;
+    }
+
+    return ia;
+}
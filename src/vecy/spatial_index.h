@@ -0,0 +1,192 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+
+// A dynamic aabb tree of world space bounds, keyed by shape id.
+// Leaves are kept balanced with rotations so queries stay logarithmic
+// no matter in what order shapes are added.
+struct SpatialIndex
+{
+    void insert(Id id, const Rect& bounds);
+    void remove(Id id);
+
+    // insert many entries at once, they are built into a balanced subtree top down
+    // which is much faster than inserting them one by one and gives a better tree
+    void insert_bulk(const Id* ids, const Rect* bounds, std::size_t count);
+
+    // update the bounds of a shape, inserts it if it isn't in the index
+    void update(Id id, const Rect& bounds);
+
+    // change the bounds of many entries without moving them in the tree, only their ancestors
+    // are grown or shrunk to fit. much faster than updating them one by one, the tree gets looser
+    // if they move far but changing them back restores the same tree. entries not in the index are ignored
+    void refit(const Id* ids, const Rect* bounds, std::size_t count);
+
+    void clear();
+
+    [[nodiscard]] bool contains(Id id) const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] int get_height() const;
+
+    // the bounds of everything in the index
+    [[nodiscard]] Rect get_bounds() const;
+
+    // the bounds of a single entry, nullopt if it isn't in the index
+    [[nodiscard]] std::optional<Rect> get_bounds(Id id) const;
+
+    // calls on_hit(Id, const Rect&) for each entry that overlaps the rect
+    template<typename F>
+    void query_intersecting(const Rect& r, F&& on_hit) const
+    {
+        query_nodes(r, [&](const Node& node)
+        {
+            on_hit(node.id, node.bounds);
+        });
+    }
+
+    // calls on_hit(Id, const Rect&) for each entry that is fully inside the rect
+    template<typename F>
+    void query_enclosed(const Rect& r, F&& on_hit) const
+    {
+        query_nodes(r, [&](const Node& node)
+        {
+            if (r.contains(node.bounds))
+            {
+                on_hit(node.id, node.bounds);
+            }
+        });
+    }
+
+private:
+    static constexpr int null_node = -1;
+
+    struct Node
+    {
+        Rect bounds;
+        Id id = {0};
+        int parent = null_node;
+
+        // next is used by the free list
+        int left = null_node;
+        int right = null_node;
+
+        // leaf = 0, free node = -1
+        int height = -1;
+
+        bool is_leaf() const
+        {
+            return left == null_node;
+        }
+    };
+
+    // a traversal stack that only touches the heap for very unbalanced trees
+    struct NodeStack
+    {
+        int fixed[64];
+        std::vector<int> overflow;
+        int count = 0;
+
+        void push(int n)
+        {
+            if (count < 64)
+            {
+                fixed[count] = n;
+            }
+            else
+            {
+                overflow.push_back(n);
+            }
+            count += 1;
+        }
+
+        int pop()
+        {
+            count -= 1;
+            if (count < 64)
+            {
+                return fixed[count];
+            }
+            const int n = overflow.back();
+            overflow.pop_back();
+            return n;
+        }
+
+        bool is_empty() const
+        {
+            return count == 0;
+        }
+    };
+
+    template<typename F>
+    void query_nodes(const Rect& r, F&& on_leaf) const
+    {
+        if (root == null_node)
+        {
+            return;
+        }
+
+        NodeStack stack;
+        stack.push(root);
+
+        while (stack.is_empty() == false)
+        {
+            const Node& node = nodes[stack.pop()];
+            if (node.bounds.intersects(r) == false)
+            {
+                continue;
+            }
+
+            if (node.is_leaf())
+            {
+                on_leaf(node);
+            }
+            else
+            {
+                stack.push(node.left);
+                stack.push(node.right);
+            }
+        }
+    }
+
+    int allocate_node();
+    void free_node(int n);
+
+    void insert_leaf(int leaf);
+    void remove_leaf(int leaf);
+
+    struct BulkEntry
+    {
+        glm::vec2 center;
+        int node;
+    };
+
+    // build a subtree over the nodes by splitting on the median of the longest axis, returns the root
+    int build_subtree(BulkEntry* first, BulkEntry* last);
+
+    // free the inner nodes under n and add its leaves to the list
+    void collect_leaves(int n, std::vector<BulkEntry>* leaf_list);
+
+    // rotate the subtree if it is unbalanced, returns the new subtree root
+    int balance(int a);
+
+    // walk from n to the root and refit bounds and heights
+    void refit_to_root(int n);
+
+    // the leaf node of each id, by id like the slots of the shape store.
+    // a hash map here was a heap allocation per shape
+    [[nodiscard]] int find_leaf(Id id) const
+    {
+        return id.id < leaves.size() ? leaves[id.id] : null_node;
+    }
+    void set_leaf(Id id, int leaf);
+
+    std::vector<Node> nodes;
+    std::vector<int> leaves;
+    std::size_t leaf_count = 0;
+    int root = null_node;
+    int free_list = null_node;
+};
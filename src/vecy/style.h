@@ -0,0 +1,91 @@
+#pragma once
+
+#include <optional>
+
+#include "vecy/types.h"
+#include "vecy/rgba.h"
+
+enum class LineStyle
+    { solid, dot, long_dash, short_dash, dot_dash };
+
+enum class FillStyle {
+    solid, bdiagonal_hatch, crossdiag_hatch, fdiagonal_hatch,
+    cross_hatch, horizontal_hatch, vertical_hatch
+};
+
+struct DashPattern
+{
+    int count;
+    int lengths[4];
+};
+
+// on, off, on, off... in multiples of the line width
+inline DashPattern get_dash_pattern(LineStyle style)
+{
+    switch (style)
+    {
+    case LineStyle::dot: return { 2, {1, 2, 0, 0} };
+    case LineStyle::long_dash: return { 2, {8, 4, 0, 0} };
+    case LineStyle::short_dash: return { 2, {4, 4, 0, 0} };
+    case LineStyle::dot_dash: return { 4, {6, 3, 1, 3} };
+    case LineStyle::solid:
+    default:
+        return { 0, {0, 0, 0, 0} };
+    }
+}
+
+struct Outline
+{
+    Rgba color;
+    int width;
+    LineStyle style;
+};
+
+struct Fill
+{
+    Rgba color;
+    FillStyle style;
+};
+
+inline bool is_alpha(const Rgba& color)
+{
+    return color.a < 255;
+}
+
+inline bool is_alpha(const std::optional<Fill>& fill, const std::optional<Outline>& outline)
+{
+    if (fill && is_alpha(fill->color)) { return true; }
+    else if (outline && is_alpha(outline->color)) { return true; }
+    else { return false; }
+}
+
+template<typename T>
+std::optional<T> get_or_not(T t, bool include)
+{
+    if (include)
+    {
+        return t;
+    }
+    else
+    {
+        return std::nullopt;
+    }
+}
+
+// packs a style into a single value so draw commands can be grouped on it
+inline u64 get_state_key(const Rgba& c)
+{
+    return (u64{c.r} << 24) | (u64{c.g} << 16) | (u64{c.b} << 8) | u64{c.a};
+}
+
+inline u64 get_state_key(const std::optional<Fill>& fill)
+{
+    if (!fill) { return 0; }
+    return (u64{1} << 40) | (static_cast<u64>(fill->style) << 32) | get_state_key(fill->color);
+}
+
+inline u64 get_state_key(const std::optional<Outline>& outline)
+{
+    if (!outline) { return 0; }
+    return (u64{1} << 56) | (static_cast<u64>(outline->style) << 48) | (static_cast<u64>(outline->width & 0xFFFF) << 32) | get_state_key(outline->color);
+}
@@ -0,0 +1,998 @@
+#include "vecy/svg.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "vecy/document.h"
+
+namespace
+{
+    constexpr std::size_t initial_buffer_size = 64 * 1024;
+
+
+    bool is_space(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        while (text.empty() == false && is_space(text.front())) { text.remove_prefix(1); }
+        while (text.empty() == false && is_space(text.back())) { text.remove_suffix(1); }
+        return text;
+    }
+
+    bool is_digit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    // parses a number from the start of the text and removes it, leading spaces and commas are skipped.
+    // units after the number are left in the text
+    std::optional<float> parse_number(std::string_view* text)
+    {
+        auto t = *text;
+        while (t.empty() == false && (is_space(t.front()) || t.front() == ',')) { t.remove_prefix(1); }
+
+        std::size_t i = 0;
+        bool negative = false;
+        if (i < t.size() && (t[i] == '-' || t[i] == '+'))
+        {
+            negative = t[i] == '-';
+            i += 1;
+        }
+
+        double value = 0.0;
+        bool has_digits = false;
+        for (; i < t.size() && is_digit(t[i]); i += 1)
+        {
+            value = value * 10.0 + (t[i] - '0');
+            has_digits = true;
+        }
+        if (i < t.size() && t[i] == '.')
+        {
+            i += 1;
+            double scale = 0.1;
+            for (; i < t.size() && is_digit(t[i]); i += 1)
+            {
+                value += (t[i] - '0') * scale;
+                scale *= 0.1;
+                has_digits = true;
+            }
+        }
+        if (has_digits == false)
+        {
+            return std::nullopt;
+        }
+
+        if (i + 1 < t.size() && (t[i] == 'e' || t[i] == 'E') && (is_digit(t[i + 1]) || t[i + 1] == '-' || t[i + 1] == '+'))
+        {
+            std::size_t e = i + 1;
+            bool negative_exponent = false;
+            if (t[e] == '-' || t[e] == '+')
+            {
+                negative_exponent = t[e] == '-';
+                e += 1;
+            }
+            int exponent = 0;
+            for (; e < t.size() && is_digit(t[e]); e += 1)
+            {
+                exponent = std::min(exponent * 10 + (t[e] - '0'), 1000);
+            }
+            value *= std::pow(10.0, negative_exponent ? -exponent : exponent);
+            i = e;
+        }
+
+        t.remove_prefix(i);
+        *text = t;
+        return static_cast<float>(negative ? -value : value);
+    }
+
+    float parse_number_or(std::optional<std::string_view> text, float fallback)
+    {
+        if (text.has_value() == false)
+        {
+            return fallback;
+        }
+        auto t = *text;
+        return parse_number(&t).value_or(fallback);
+    }
+
+    int parse_hex_digit(char c)
+    {
+        if (c >= '0' && c <= '9') { return c - '0'; }
+        if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+        if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+        return -1;
+    }
+
+    u8 to_channel(float value)
+    {
+        return static_cast<u8>(std::lround(std::min(255.0f, std::max(0.0f, value))));
+    }
+
+    Rgba with_opacity(const Rgba& color, float opacity)
+    {
+        auto ret = color;
+        ret.a = to_channel(static_cast<float>(color.a) * std::min(1.0f, std::max(0.0f, opacity)));
+        return ret;
+    }
+
+    // the presentation attributes as text, either from attributes or the style attribute
+    struct StyleText
+    {
+        std::optional<std::string_view> fill;
+        std::optional<std::string_view> stroke;
+        std::optional<std::string_view> opacity;
+        std::optional<std::string_view> fill_opacity;
+        std::optional<std::string_view> stroke_opacity;
+        std::optional<std::string_view> stroke_width;
+        std::optional<std::string_view> stroke_dasharray;
+
+        void set(std::string_view name, std::string_view value)
+        {
+            if (name == "fill") { fill = value; }
+            else if (name == "stroke") { stroke = value; }
+            else if (name == "opacity") { opacity = value; }
+            else if (name == "fill-opacity") { fill_opacity = value; }
+            else if (name == "stroke-opacity") { stroke_opacity = value; }
+            else if (name == "stroke-width") { stroke_width = value; }
+            else if (name == "stroke-dasharray") { stroke_dasharray = value; }
+        }
+    };
+
+    void append_hex(std::string* out, u8 value)
+    {
+        constexpr char digits[] = "0123456789abcdef";
+        out->push_back(digits[value >> 4]);
+        out->push_back(digits[value & 0xF]);
+    }
+
+    // the shortest text that reads back to the same float
+    void append_number(std::string* out, float value)
+    {
+        char text[32];
+        int length = 0;
+        for (int precision = 6; precision <= 9; precision += 1)
+        {
+            length = std::snprintf(text, sizeof(text), "%.*g", precision, static_cast<double>(value));
+            if (std::strtof(text, nullptr) == value)
+            {
+                break;
+            }
+        }
+        out->append(text, static_cast<std::size_t>(std::max(0, length)));
+    }
+
+    void append_rectangle(std::string* out, const Rect& rect, const Rgba& color)
+    {
+        out->append("<rect x=\"");
+        append_number(out, rect.topleft.x);
+        out->append("\" y=\"");
+        append_number(out, rect.topleft.y);
+        out->append("\" width=\"");
+        append_number(out, rect.size.x);
+        out->append("\" height=\"");
+        append_number(out, rect.size.y);
+        out->append("\" fill=\"#");
+        append_hex(out, color.r);
+        append_hex(out, color.g);
+        append_hex(out, color.b);
+        out->append("\"");
+        if (color.a < 255)
+        {
+            out->append(" fill-opacity=\"");
+            append_number(out, static_cast<float>(color.a) / 255.0f);
+            out->append("\"");
+        }
+        out->append("/>\n");
+    }
+
+    void append_color(std::string* out, const char* name, const Rgba& color)
+    {
+        out->append(" ");
+        out->append(name);
+        out->append("=\"#");
+        append_hex(out, color.r);
+        append_hex(out, color.g);
+        append_hex(out, color.b);
+        out->append("\"");
+        if (color.a < 255)
+        {
+            out->append(" ");
+            out->append(name);
+            out->append("-opacity=\"");
+            append_number(out, static_cast<float>(color.a) / 255.0f);
+            out->append("\"");
+        }
+    }
+
+    void append_point(std::string* out, const glm::vec2& p)
+    {
+        append_number(out, p.x);
+        out->append(",");
+        append_number(out, p.y);
+    }
+
+    // the color replaces the colors of the path when set
+    void append_path(std::string* out, const PathArray& paths, u32 slot, const std::optional<Rgba>& color = std::nullopt)
+    {
+        const auto& geometry = paths.geometries[slot];
+        out->append("<path d=\"");
+        std::size_t next = 0;
+        for (std::size_t i = 0; i < geometry.verbs.size(); i += 1)
+        {
+            if (i > 0) { out->append(" "); }
+            const auto* p = geometry.points.data() + next;
+            switch (geometry.verbs[i])
+            {
+            case PathVerb::move: out->append("M"); append_point(out, p[0]); next += 1; break;
+            case PathVerb::line: out->append("L"); append_point(out, p[0]); next += 1; break;
+            case PathVerb::quad:
+                out->append("Q"); append_point(out, p[0]);
+                out->append(" "); append_point(out, p[1]);
+                next += 2;
+                break;
+            case PathVerb::cubic:
+                out->append("C"); append_point(out, p[0]);
+                out->append(" "); append_point(out, p[1]);
+                out->append(" "); append_point(out, p[2]);
+                next += 3;
+                break;
+            case PathVerb::close: out->append("Z"); break;
+            }
+        }
+        out->append("\"");
+
+        if (const auto& fill = paths.fills[slot]) { append_color(out, "fill", color.value_or(fill->color)); }
+        else { out->append(" fill=\"none\""); }
+
+        if (const auto& outline = paths.outlines[slot])
+        {
+            append_color(out, "stroke", color.value_or(outline->color));
+            const auto width = static_cast<float>(outline->width);
+            out->append(" stroke-width=\"");
+            append_number(out, width);
+            out->append("\"");
+            if (outline->style != LineStyle::solid)
+            {
+                out->append(" stroke-dasharray=\"");
+                out->append(get_svg_dash_array(outline->style, width));
+                out->append("\"");
+            }
+        }
+        out->append("/>\n");
+    }
+
+    // the shapes of the symbol in the order they were added, in the space of the symbol
+    void append_symbol_shapes(std::string* out, const Symbol& symbol, const std::optional<Rgba>& color)
+    {
+        const auto& rectangles = symbol.rectangles;
+        const auto& paths = symbol.paths;
+        u32 next_path = 0;
+        for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+        {
+            for (; next_path < paths.size() && paths.ids[next_path].id < rectangles.ids[slot].id; next_path += 1)
+            {
+                append_path(out, paths, next_path, color);
+            }
+            append_rectangle(out, rectangles.rects[slot], color.value_or(rectangles.colors[slot]));
+        }
+        for (; next_path < paths.size(); next_path += 1)
+        {
+            append_path(out, paths, next_path, color);
+        }
+    }
+
+    void append_instance_transform(std::string* out, const InstanceArray& instances, u32 slot)
+    {
+        out->append(" transform=\"translate(");
+        append_number(out, instances.offsets[slot].x);
+        out->append(" ");
+        append_number(out, instances.offsets[slot].y);
+        out->append(") scale(");
+        append_number(out, instances.scales[slot]);
+        out->append(")\"");
+    }
+
+    // a use of the symbol, or a copy of its shapes when recolored since a use can't change the colors
+    void append_instance(std::string* out, const ShapeStore& store, u32 slot)
+    {
+        const auto& instances = store.instances;
+        const auto& color = instances.colors[slot];
+        if (color)
+        {
+            out->append("<g");
+            append_instance_transform(out, instances, slot);
+            out->append(">\n");
+            append_symbol_shapes(out, store.symbols[instances.symbols[slot]], color);
+            out->append("</g>\n");
+            return;
+        }
+
+        out->append("<use xlink:href=\"#symbol");
+        out->append(std::to_string(instances.symbols[slot]));
+        out->append("\"");
+        append_instance_transform(out, instances, slot);
+        out->append("/>\n");
+    }
+}
+
+XmlPullParser::XmlPullParser(std::FILE* f)
+    : file(f)
+    , buffer(initial_buffer_size)
+{
+}
+
+bool XmlPullParser::fill(std::size_t count)
+{
+    if (end - cursor >= count)
+    {
+        return true;
+    }
+
+    // move the unread bytes to the front and read after them
+    if (cursor > 0)
+    {
+        std::memmove(buffer.data(), buffer.data() + cursor, end - cursor);
+        end -= cursor;
+        consumed += cursor;
+        cursor = 0;
+    }
+
+    while (end < count)
+    {
+        if (end == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
+        const auto read = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+        if (read == 0)
+        {
+            return false;
+        }
+        end += read;
+    }
+    return true;
+}
+
+bool XmlPullParser::skip_past(std::string_view terminator)
+{
+    while (true)
+    {
+        const auto view = std::string_view{ buffer.data() + cursor, end - cursor };
+        const auto found = view.find(terminator);
+        if (found != std::string_view::npos)
+        {
+            cursor += found + terminator.size();
+            return true;
+        }
+
+        // the terminator may start in the bytes that are kept
+        const auto keep = std::min(view.size(), terminator.size() - 1);
+        cursor = end - keep;
+        if (fill(keep + 1) == false)
+        {
+            return false;
+        }
+    }
+}
+
+bool XmlPullParser::next_element()
+{
+    while (true)
+    {
+        // text between tags is skipped
+        const void* found = nullptr;
+        while ((found = std::memchr(buffer.data() + cursor, '<', end - cursor)) == nullptr)
+        {
+            cursor = end;
+            if (fill(1) == false)
+            {
+                return false;
+            }
+        }
+        cursor = static_cast<std::size_t>(static_cast<const char*>(found) - buffer.data());
+
+        if (fill(2) == false)
+        {
+            return false;
+        }
+
+        const char kind = buffer[cursor + 1];
+        if (kind == '/' || kind == '?' || kind == '!')
+        {
+            if (fill(4) && std::memcmp(buffer.data() + cursor, "<!--", 4) == 0)
+            {
+                if (skip_past("-->") == false) { return false; }
+            }
+            else if (fill(9) && std::memcmp(buffer.data() + cursor, "<![CDATA[", 9) == 0)
+            {
+                if (skip_past("]]>") == false) { return false; }
+            }
+            else if (skip_past(">") == false)
+            {
+                return false;
+            }
+            continue;
+        }
+
+        // find the end of the tag, a > in a quoted value doesn't end it
+        std::size_t offset = 1;
+        char quote = 0;
+        while (true)
+        {
+            if (cursor + offset >= end && fill(offset + 1) == false)
+            {
+                return false;
+            }
+
+            const char c = buffer[cursor + offset];
+            if (quote != 0)
+            {
+                if (c == quote) { quote = 0; }
+            }
+            else if (c == '"' || c == '\'')
+            {
+                quote = c;
+            }
+            else if (c == '>')
+            {
+                break;
+            }
+            offset += 1;
+        }
+
+        const std::size_t first = cursor + 1;
+        const std::size_t last = cursor + offset;
+        std::size_t name_end = first;
+        while (name_end < last && is_space(buffer[name_end]) == false && buffer[name_end] != '/')
+        {
+            name_end += 1;
+        }
+        name = std::string_view{ buffer.data() + first, name_end - first };
+        parse_attributes(name_end, last);
+
+        cursor = last + 1;
+        return true;
+    }
+}
+
+void XmlPullParser::parse_attributes(std::size_t first, std::size_t last)
+{
+    attributes.clear();
+
+    std::size_t i = first;
+    while (i < last)
+    {
+        while (i < last && (is_space(buffer[i]) || buffer[i] == '/')) { i += 1; }
+
+        const std::size_t name_start = i;
+        while (i < last && buffer[i] != '=' && is_space(buffer[i]) == false) { i += 1; }
+        const auto attribute = std::string_view{ buffer.data() + name_start, i - name_start };
+
+        while (i < last && is_space(buffer[i])) { i += 1; }
+        if (i >= last || buffer[i] != '=')
+        {
+            // a name without a value isn't valid xml, skip it
+            continue;
+        }
+        i += 1;
+        while (i < last && is_space(buffer[i])) { i += 1; }
+        if (i >= last || (buffer[i] != '"' && buffer[i] != '\''))
+        {
+            return;
+        }
+
+        const char quote = buffer[i];
+        const std::size_t value_start = i + 1;
+        std::size_t value_end = value_start;
+        while (value_end < last && buffer[value_end] != quote) { value_end += 1; }
+        attributes.emplace_back(attribute, std::string_view{ buffer.data() + value_start, value_end - value_start });
+        i = value_end + 1;
+    }
+}
+
+std::optional<std::string_view> XmlPullParser::get_attribute(std::string_view attribute) const
+{
+    for (const auto& [n, value] : attributes)
+    {
+        if (n == attribute)
+        {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<Rgba> parse_svg_color(std::string_view text)
+{
+    text = trim(text);
+    if (text.empty() || text == "none")
+    {
+        return std::nullopt;
+    }
+
+    if (text.front() == '#')
+    {
+        text.remove_prefix(1);
+        int digits[6];
+        if (text.size() != 3 && text.size() != 6)
+        {
+            return std::nullopt;
+        }
+        for (std::size_t i = 0; i < text.size(); i += 1)
+        {
+            digits[i] = parse_hex_digit(text[i]);
+            if (digits[i] < 0) { return std::nullopt; }
+        }
+        if (text.size() == 3)
+        {
+            return Rgba{ static_cast<open_color::Hex>((digits[0] * 17 << 16) | (digits[1] * 17 << 8) | digits[2] * 17) };
+        }
+        return Rgba{ static_cast<open_color::Hex>((digits[0] << 20) | (digits[1] << 16) | (digits[2] << 12) | (digits[3] << 8) | (digits[4] << 4) | digits[5]) };
+    }
+
+    if (text.substr(0, 4) == "rgb(")
+    {
+        auto rest = text.substr(4);
+        u32 channels[3];
+        for (auto& channel : channels)
+        {
+            auto value = parse_number(&rest);
+            if (value.has_value() == false) { return std::nullopt; }
+            if (rest.empty() == false && rest.front() == '%')
+            {
+                *value *= 2.55f;
+                rest.remove_prefix(1);
+            }
+            channel = to_channel(*value);
+        }
+        return Rgba{ (channels[0] << 16) | (channels[1] << 8) | channels[2] };
+    }
+
+    struct NamedColor
+    {
+        std::string_view name;
+        open_color::Hex hex;
+    };
+    constexpr NamedColor named_colors[] =
+    {
+        {"black", 0x000000}, {"white", 0xffffff}, {"red", 0xff0000}, {"green", 0x008000},
+        {"blue", 0x0000ff}, {"yellow", 0xffff00}, {"cyan", 0x00ffff}, {"magenta", 0xff00ff},
+        {"gray", 0x808080}, {"grey", 0x808080}, {"orange", 0xffa500}, {"purple", 0x800080},
+        {"lime", 0x00ff00}, {"navy", 0x000080}, {"silver", 0xc0c0c0}, {"maroon", 0x800000}
+    };
+    for (const auto& named : named_colors)
+    {
+        if (text == named.name)
+        {
+            return Rgba{ named.hex };
+        }
+    }
+    if (text == "transparent")
+    {
+        return Rgba{ 0, 0 };
+    }
+    return std::nullopt;
+}
+
+LineStyle parse_svg_dash_array(std::string_view text, float stroke_width)
+{
+    text = trim(text);
+    if (text.empty() || text == "none")
+    {
+        return LineStyle::solid;
+    }
+
+    float lengths[8];
+    int count = 0;
+    while (count < 8)
+    {
+        const auto value = parse_number(&text);
+        if (value.has_value() == false) { break; }
+        lengths[count] = *value / std::max(1.0f, stroke_width);
+        count += 1;
+    }
+    if (count == 0)
+    {
+        return LineStyle::solid;
+    }
+
+    // an odd list is repeated to make it even
+    if (count % 2 == 1 && count <= 4)
+    {
+        for (int i = 0; i < count; i += 1) { lengths[count + i] = lengths[i]; }
+        count *= 2;
+    }
+
+    auto best = LineStyle::short_dash;
+    float best_distance = -1.0f;
+    for (const auto style : {LineStyle::dot, LineStyle::long_dash, LineStyle::short_dash, LineStyle::dot_dash})
+    {
+        const auto pattern = get_dash_pattern(style);
+        if (pattern.count != count) { continue; }
+
+        float distance = 0.0f;
+        for (int i = 0; i < count; i += 1)
+        {
+            distance += std::abs(lengths[i] - static_cast<float>(pattern.lengths[i]));
+        }
+        if (best_distance < 0.0f || distance < best_distance)
+        {
+            best = style;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+std::string get_svg_dash_array(LineStyle style, float stroke_width)
+{
+    const auto pattern = get_dash_pattern(style);
+    if (pattern.count == 0)
+    {
+        return "none";
+    }
+
+    std::string ret;
+    for (int i = 0; i < pattern.count; i += 1)
+    {
+        if (i > 0) { ret += ","; }
+        append_number(&ret, static_cast<float>(pattern.lengths[i]) * std::max(1.0f, stroke_width));
+    }
+    return ret;
+}
+
+std::optional<PathGeometry> parse_svg_path_data(std::string_view text)
+{
+    PathGeometry geometry;
+    glm::vec2 current = { 0, 0 };
+    glm::vec2 start = { 0, 0 };
+    char command = 0;
+
+    const auto read_point = [&text](const glm::vec2& origin) -> std::optional<glm::vec2>
+    {
+        const auto x = parse_number(&text);
+        const auto y = x ? parse_number(&text) : std::nullopt;
+        if (x.has_value() == false || y.has_value() == false) { return std::nullopt; }
+        return origin + glm::vec2{ *x, *y };
+    };
+
+    while (true)
+    {
+        while (text.empty() == false && (is_space(text.front()) || text.front() == ',')) { text.remove_prefix(1); }
+        if (text.empty())
+        {
+            break;
+        }
+
+        // a command letter, or more arguments for the previous command
+        const char c = text.front();
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+        {
+            command = c;
+            text.remove_prefix(1);
+            if (command == 'Z' || command == 'z')
+            {
+                if (geometry.empty()) { return std::nullopt; }
+                geometry.close();
+                current = start;
+                continue;
+            }
+        }
+        else if (command == 0 || command == 'Z' || command == 'z')
+        {
+            return std::nullopt;
+        }
+
+        const bool relative = command >= 'a' && command <= 'z';
+        const auto origin = relative ? current : glm::vec2{ 0, 0 };
+        const bool is_move = command == 'M' || command == 'm';
+        if (geometry.empty() && is_move == false)
+        {
+            return std::nullopt;
+        }
+
+        switch (command)
+        {
+        case 'M': case 'm':
+        {
+            const auto p = read_point(origin);
+            if (p.has_value() == false) { return std::nullopt; }
+            geometry.move_to(*p);
+            start = *p;
+            current = *p;
+
+            // more points after a move are lines
+            command = relative ? 'l' : 'L';
+            break;
+        }
+        case 'L': case 'l':
+        {
+            const auto p = read_point(origin);
+            if (p.has_value() == false) { return std::nullopt; }
+            geometry.line_to(*p);
+            current = *p;
+            break;
+        }
+        case 'H': case 'h': case 'V': case 'v':
+        {
+            const auto value = parse_number(&text);
+            if (value.has_value() == false) { return std::nullopt; }
+            const bool horizontal = command == 'H' || command == 'h';
+            auto& axis = horizontal ? current.x : current.y;
+            axis = relative ? axis + *value : *value;
+            geometry.line_to(current);
+            break;
+        }
+        case 'Q': case 'q':
+        {
+            const auto control = read_point(origin);
+            const auto p = control ? read_point(origin) : std::nullopt;
+            if (p.has_value() == false) { return std::nullopt; }
+            geometry.quad_to(*control, *p);
+            current = *p;
+            break;
+        }
+        case 'C': case 'c':
+        {
+            const auto control1 = read_point(origin);
+            const auto control2 = control1 ? read_point(origin) : std::nullopt;
+            const auto p = control2 ? read_point(origin) : std::nullopt;
+            if (p.has_value() == false) { return std::nullopt; }
+            geometry.cubic_to(*control1, *control2, *p);
+            current = *p;
+            break;
+        }
+        default:
+            // smooth curves and arcs
+            return std::nullopt;
+        }
+    }
+
+    if (geometry.empty())
+    {
+        return std::nullopt;
+    }
+    return geometry;
+}
+
+SvgStyle parse_svg_style(const XmlPullParser& parser)
+{
+    StyleText text;
+    for (const auto name : {"fill", "stroke", "opacity", "fill-opacity", "stroke-opacity", "stroke-width", "stroke-dasharray"})
+    {
+        if (const auto value = parser.get_attribute(name))
+        {
+            text.set(name, *value);
+        }
+    }
+
+    // the style attribute wins over the presentation attributes
+    if (auto style = parser.get_attribute("style"))
+    {
+        auto rest = *style;
+        while (rest.empty() == false)
+        {
+            const auto end = rest.find(';');
+            const auto declaration = rest.substr(0, end);
+            rest = end == std::string_view::npos ? std::string_view{} : rest.substr(end + 1);
+
+            const auto colon = declaration.find(':');
+            if (colon == std::string_view::npos) { continue; }
+            text.set(trim(declaration.substr(0, colon)), trim(declaration.substr(colon + 1)));
+        }
+    }
+
+    const float opacity = parse_number_or(text.opacity, 1.0f);
+
+    SvgStyle ret;
+
+    // no fill attribute means black
+    const auto fill_color = text.fill ? parse_svg_color(*text.fill) : std::optional<Rgba>{ Rgba{ 0x000000 } };
+    if (fill_color)
+    {
+        ret.fill = Fill{ with_opacity(*fill_color, opacity * parse_number_or(text.fill_opacity, 1.0f)), FillStyle::solid };
+    }
+
+    const auto stroke_color = text.stroke ? parse_svg_color(*text.stroke) : std::nullopt;
+    if (stroke_color)
+    {
+        const float width = parse_number_or(text.stroke_width, 1.0f);
+        const auto style = text.stroke_dasharray ? parse_svg_dash_array(*text.stroke_dasharray, width) : LineStyle::solid;
+        ret.outline = Outline{ with_opacity(*stroke_color, opacity * parse_number_or(text.stroke_opacity, 1.0f)), std::max(1, static_cast<int>(std::lround(width))), style };
+    }
+
+    return ret;
+}
+
+SvgImportStats read_svg(IdGenerator* ids, const std::string& path, SvgShapes* shapes)
+{
+    SvgImportStats stats;
+
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return stats;
+    }
+
+    // the ids are taken while reading so the rectangles and paths keep the order of the file
+    auto& imported = shapes->rectangles;
+    auto& imported_paths = shapes->paths;
+
+    XmlPullParser parser{ file };
+    while (parser.next_element())
+    {
+        const auto name = parser.get_name();
+        if (name == "rect")
+        {
+            const auto rect = Rect
+            {
+                {parse_number_or(parser.get_attribute("x"), 0.0f), parse_number_or(parser.get_attribute("y"), 0.0f)},
+                {parse_number_or(parser.get_attribute("width"), 0.0f), parse_number_or(parser.get_attribute("height"), 0.0f)}
+            };
+            const auto style = parse_svg_style(parser);
+
+            // the store only has filled rectangles
+            if (rect.size.x <= 0.0f || rect.size.y <= 0.0f || style.fill.has_value() == false)
+            {
+                stats.skipped += 1;
+                continue;
+            }
+            if (style.outline)
+            {
+                stats.strokes_dropped += 1;
+            }
+
+            imported.push_back({ ids->create(), style.fill->color, rect });
+            stats.rectangles += 1;
+        }
+        else if (name == "path")
+        {
+            const auto data = parser.get_attribute("d");
+            auto geometry = data ? parse_svg_path_data(*data) : std::nullopt;
+            const auto style = parse_svg_style(parser);
+            if (geometry.has_value() == false || (style.fill.has_value() == false && style.outline.has_value() == false))
+            {
+                stats.skipped += 1;
+                continue;
+            }
+
+            imported_paths.push_back({ ids->create(), std::move(*geometry), style.fill, style.outline });
+            stats.paths += 1;
+        }
+        else if (name == "circle" || name == "ellipse" || name == "line" || name == "polyline" || name == "polygon")
+        {
+            stats.skipped += 1;
+        }
+    }
+
+    stats.bytes = parser.get_position();
+    stats.ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return stats;
+}
+
+SvgImportStats import_svg(Document* document, const std::string& path)
+{
+    // handed to the document at once so the index is built as one tree, chunks built as subtrees
+    // overlap each other when the shapes are spread over the drawing and queries have to visit all of them
+    SvgShapes shapes;
+    const auto stats = read_svg(&document->ids, path, &shapes);
+    document->restore_rectangles(shapes.rectangles);
+    document->restore_paths(shapes.paths);
+    return stats;
+}
+
+bool export_svg(Document* document, const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    document->shapes.ensure_z_order();
+    const auto& rectangles = document->shapes.rectangles;
+    const auto& paths = document->shapes.paths;
+    const auto& instances = document->shapes.instances;
+    const auto& symbols = document->shapes.symbols;
+    const DocumentFile* base = document->base.get();
+
+    auto bounds = document->index.get_bounds();
+    if (base != nullptr && base->size() > 0)
+    {
+        if (document->shapes.size() > 0) { bounds.include(base->get_bounds()); }
+        else { bounds = base->get_bounds(); }
+    }
+
+    std::string out;
+    out.reserve(initial_buffer_size * 2);
+    bool ok = true;
+    const auto flush = [&]()
+    {
+        ok = ok && std::fwrite(out.data(), 1, out.size(), file) == out.size();
+        out.clear();
+    };
+
+    out.append("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" viewBox=\"");
+    append_number(&out, bounds.topleft.x);
+    out.append(" ");
+    append_number(&out, bounds.topleft.y);
+    out.append(" ");
+    append_number(&out, bounds.size.x);
+    out.append(" ");
+    append_number(&out, bounds.size.y);
+    out.append("\">\n");
+
+    // every symbol is written once and used by the instances
+    if (symbols.empty() == false)
+    {
+        out.append("<defs>\n");
+        for (std::size_t symbol = 0; symbol < symbols.size(); symbol += 1)
+        {
+            out.append("<g id=\"symbol");
+            out.append(std::to_string(symbol));
+            out.append("\">\n");
+            append_symbol_shapes(&out, symbols[symbol], std::nullopt);
+            out.append("</g>\n");
+            if (out.size() >= initial_buffer_size) { flush(); }
+        }
+        out.append("</defs>\n");
+    }
+
+    // the shapes in the loaded file and the edited shapes are both sorted on id
+    u32 next_base = 0;
+    const auto write_base_before = [&](u64 id)
+    {
+        for (; base != nullptr && next_base < base->size() && base->get_id(next_base).id < id; next_base += 1)
+        {
+            if (document->is_base_hidden(next_base) == false)
+            {
+                append_rectangle(&out, base->get_rect(next_base), base->get_color(next_base));
+            }
+            if (out.size() >= initial_buffer_size) { flush(); }
+        }
+    };
+    u32 next_path = 0;
+    const auto write_paths_before = [&](u64 id)
+    {
+        for (; next_path < paths.size() && paths.ids[next_path].id < id; next_path += 1)
+        {
+            write_base_before(paths.ids[next_path].id);
+            append_path(&out, paths, next_path);
+            if (out.size() >= initial_buffer_size) { flush(); }
+        }
+    };
+    u32 next_instance = 0;
+    const auto write_instances_before = [&](u64 id)
+    {
+        for (; next_instance < instances.size() && instances.ids[next_instance].id < id; next_instance += 1)
+        {
+            write_paths_before(instances.ids[next_instance].id);
+            write_base_before(instances.ids[next_instance].id);
+            append_instance(&out, document->shapes, next_instance);
+            if (out.size() >= initial_buffer_size) { flush(); }
+        }
+    };
+    for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+    {
+        write_instances_before(rectangles.ids[slot].id);
+        write_paths_before(rectangles.ids[slot].id);
+        write_base_before(rectangles.ids[slot].id);
+        append_rectangle(&out, rectangles.rects[slot], rectangles.colors[slot]);
+        if (out.size() >= initial_buffer_size) { flush(); }
+    }
+    write_instances_before(std::numeric_limits<u64>::max());
+    write_paths_before(std::numeric_limits<u64>::max());
+    write_base_before(std::numeric_limits<u64>::max());
+
+    out.append("</svg>\n");
+    flush();
+
+    const bool closed = std::fclose(file) == 0;
+    return ok && closed;
+}
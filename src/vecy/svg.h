@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <utility>
+#include <optional>
+#include <string_view>
+
+#include "vecy/types.h"
+#include "vecy/rgba.h"
+#include "vecy/style.h"
+#include "vecy/path.h"
+#include "vecy/shape_store.h"
+
+// A streaming xml tokenizer that only reports start tags and their attributes.
+// The file is read through a fixed buffer that only grows to fit the biggest tag,
+// so memory doesn't depend on the file size.
+struct XmlPullParser
+{
+    explicit XmlPullParser(std::FILE* file);
+
+    // moves to the next start tag, false at the end of the file
+    bool next_element();
+
+    // valid until the next call to next_element
+    [[nodiscard]] std::string_view get_name() const
+    {
+        return name;
+    }
+
+    [[nodiscard]] std::optional<std::string_view> get_attribute(std::string_view attribute) const;
+
+    // bytes consumed so far
+    [[nodiscard]] u64 get_position() const
+    {
+        return consumed + cursor;
+    }
+
+private:
+    // make sure there are at least count bytes after the cursor, false if the file ended before that
+    bool fill(std::size_t count);
+    bool skip_past(std::string_view terminator);
+    void parse_attributes(std::size_t first, std::size_t last);
+
+    std::FILE* file;
+    std::vector<char> buffer;
+    std::size_t cursor = 0;
+    std::size_t end = 0;
+    u64 consumed = 0;
+
+    std::string_view name;
+    std::vector<std::pair<std::string_view, std::string_view>> attributes;
+};
+
+// the presentation attributes of an svg shape, mapped to the styles the painters know
+struct SvgStyle
+{
+    std::optional<Fill> fill;
+    std::optional<Outline> outline;
+};
+
+// #rgb, #rrggbb, rgb(r, g, b) and the basic color names
+[[nodiscard]] std::optional<Rgba> parse_svg_color(std::string_view text);
+
+// the closest dash pattern, in stroke widths
+[[nodiscard]] LineStyle parse_svg_dash_array(std::string_view text, float stroke_width);
+[[nodiscard]] std::string get_svg_dash_array(LineStyle style, float stroke_width);
+
+// the move, line, quadratic, cubic and close commands of path data, absolute and relative.
+// nothing if the data is broken or has a command the paths can't hold
+[[nodiscard]] std::optional<PathGeometry> parse_svg_path_data(std::string_view text);
+
+// fill, stroke, their opacities, stroke-width and stroke-dasharray, from attributes or the style attribute
+[[nodiscard]] SvgStyle parse_svg_style(const XmlPullParser& parser);
+
+struct SvgImportStats
+{
+    bool ok = false;
+    u64 bytes = 0;
+    u64 rectangles = 0;
+    u64 paths = 0;
+
+    // circles, lines, paths with arcs and other shapes the store can't hold yet
+    u64 skipped = 0;
+
+    // rectangles with a stroke, only the fill is kept
+    u64 strokes_dropped = 0;
+};
+
+// the shapes of a file with ids in the order of the file, not in a document yet
+struct SvgShapes
+{
+    std::vector<RectangleShape> rectangles;
+    std::vector<PathShape> paths;
+};
+
+struct Document;
+
+// streams the rect and path elements into the shapes, transforms and uses aren't applied
+SvgImportStats read_svg(IdGenerator* ids, const std::string& path, SvgShapes* shapes);
+
+// reads the file and adds the shapes to the document at once
+SvgImportStats import_svg(Document* document, const std::string& path);
+
+// writes every shape in paint order, the symbols once as definitions the instances use
+bool export_svg(Document* document, const std::string& path);
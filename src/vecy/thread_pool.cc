@@ -0,0 +1,151 @@
+#include "vecy/thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(int thread_count)
+{
+    const int count = std::max(1, thread_count);
+    for (int i = 0; i < count; i += 1)
+    {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (int i = 1; i < count; i += 1)
+    {
+        workers.emplace_back([this, i]() { worker_main(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+int ThreadPool::get_thread_count() const
+{
+    return static_cast<int>(queues.size());
+}
+
+void ThreadPool::parallel_for(int count, const std::function<void(int)>& task)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    if (workers.empty())
+    {
+        for (int i = 0; i < count; i += 1)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    // neighbouring tasks start on the same thread, stealing evens out the rest
+    const int thread_count = get_thread_count();
+    for (int q = 0; q < thread_count; q += 1)
+    {
+        const int first = static_cast<int>(static_cast<long long>(count) * q / thread_count);
+        const int last = static_cast<int>(static_cast<long long>(count) * (q + 1) / thread_count);
+
+        std::lock_guard<std::mutex> lock(queues[q]->mutex);
+        for (int i = first; i < last; i += 1)
+        {
+            queues[q]->items.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current_task = &task;
+        working = static_cast<int>(workers.size());
+        generation += 1;
+    }
+    wake.notify_all();
+
+    run_tasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return working == 0; });
+    current_task = nullptr;
+}
+
+bool ThreadPool::pop(int queue, int* item)
+{
+    auto& q = *queues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.items.empty())
+    {
+        return false;
+    }
+    *item = q.items.back();
+    q.items.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int thief, int* item)
+{
+    const int thread_count = get_thread_count();
+    for (int offset = 1; offset < thread_count; offset += 1)
+    {
+        auto& q = *queues[(thief + offset) % thread_count];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.items.empty() == false)
+        {
+            *item = q.items.front();
+            q.items.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run_tasks(int queue)
+{
+    // no tasks are added while running so when every queue is empty the work is done
+    int item = 0;
+    while (pop(queue, &item) || steal(queue, &item))
+    {
+        (*current_task)(item);
+    }
+}
+
+void ThreadPool::worker_main(int queue)
+{
+    u64 seen_generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return is_stopping || generation != seen_generation; });
+            if (is_stopping)
+            {
+                return;
+            }
+            seen_generation = generation;
+        }
+
+        run_tasks(queue);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            working -= 1;
+        }
+        done.notify_one();
+    }
+}
+
+int get_hardware_thread_count()
+{
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+#include "vecy/types.h"
+
+// A fixed set of worker threads. Every thread has its own queue of tasks and steals
+// from the other queues when it runs out, so uneven tasks still keep all threads busy.
+struct ThreadPool
+{
+    // thread_count includes the thread that calls parallel_for, 1 runs everything on the caller
+    explicit ThreadPool(int thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    void operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] int get_thread_count() const;
+
+    // calls task(i) for every i in [0, count) and returns when all calls are done
+    void parallel_for(int count, const std::function<void(int)>& task);
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<int> items;
+    };
+
+    // take from the back of the own queue, or the front of another queue
+    bool pop(int queue, int* item);
+    bool steal(int thief, int* item);
+
+    void run_tasks(int queue);
+    void worker_main(int queue);
+
+    // queue 0 belongs to the calling thread
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int)>* current_task = nullptr;
+    u64 generation = 0;
+    int working = 0;
+    bool is_stopping = false;
+};
+
+// the number of hardware threads, at least 1
+int get_hardware_thread_count();
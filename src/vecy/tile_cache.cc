@@ -0,0 +1,35 @@
+#include "vecy/tile_cache.h"
+
+#include <cmath>
+
+int get_zoom_level(float scale)
+{
+    return static_cast<int>(std::lround(std::log2(scale) * zoom_levels_per_octave));
+}
+
+float get_level_scale(int level)
+{
+    return std::exp2(static_cast<float>(level) / zoom_levels_per_octave);
+}
+
+CanvasTransform get_tiled_transform(const CanvasTransform& t)
+{
+    auto ret = t;
+    ret.scale = get_level_scale(get_zoom_level(t.scale));
+    ret.scroll = { std::round(t.scroll.x), std::round(t.scroll.y) };
+    return ret;
+}
+
+CanvasTransform get_tile_transform(const TileKey& key, int tile_size)
+{
+    CanvasTransform ret;
+    ret.scale = get_level_scale(key.level);
+    ret.scroll = { static_cast<float>(-key.x * tile_size), static_cast<float>(-key.y * tile_size) };
+    return ret;
+}
+
+Rect get_tile_world_bounds(const TileKey& key, int tile_size)
+{
+    const float size = static_cast<float>(tile_size) / get_level_scale(key.level);
+    return { {static_cast<float>(key.x) * size, static_cast<float>(key.y) * size}, {size, size} };
+}
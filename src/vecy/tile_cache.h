@@ -0,0 +1,210 @@
+#pragma once
+
+#include <list>
+#include <cmath>
+#include <iterator>
+#include <cstddef>
+#include <unordered_map>
+
+#include "glm/vec2.hpp"
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/canvas_transform.h"
+#include "vecy/document.h"
+
+// the scale is snapped to this many levels per doubling, so zooming back to a scale
+// finds the tiles again and every tile at a level lines up with its neighbours
+constexpr int zoom_levels_per_octave = 256;
+
+[[nodiscard]] int get_zoom_level(float scale);
+[[nodiscard]] float get_level_scale(int level);
+
+// a square of the static layer, in tiles from the world origin at a zoom level
+struct TileKey
+{
+    int level;
+    int x;
+    int y;
+
+    bool operator==(const TileKey& rhs) const
+    {
+        return level == rhs.level && x == rhs.x && y == rhs.y;
+    }
+};
+
+namespace std
+{
+    template<>
+    struct hash<TileKey>
+    {
+        std::size_t operator()(const TileKey& k) const
+        {
+            const u64 xy = (static_cast<u64>(static_cast<u32>(k.x)) << 32) | static_cast<u32>(k.y);
+            return hash<u64>{}(xy * 31 + static_cast<u32>(k.level));
+        }
+    };
+}
+
+// the view snapped to a zoom level and whole pixels, what the tiles are drawn with
+[[nodiscard]] CanvasTransform get_tiled_transform(const CanvasTransform& t);
+
+// the transform that draws the tile to a tile_size image
+[[nodiscard]] CanvasTransform get_tile_transform(const TileKey& key, int tile_size);
+
+[[nodiscard]] Rect get_tile_world_bounds(const TileKey& key, int tile_size);
+
+// calls on_tile(const TileKey&, const glm::ivec2& screen_position) for every tile on the screen
+template<typename F>
+void for_each_visible_tile(const CanvasTransform& t, const glm::ivec2& size, int tile_size, F&& on_tile)
+{
+    const auto tiled = get_tiled_transform(t);
+    const int level = get_zoom_level(t.scale);
+    const auto origin = glm::ivec2{ static_cast<int>(tiled.scroll.x), static_cast<int>(tiled.scroll.y) };
+
+    const auto first_tile = [&](int o) { return static_cast<int>(std::floor(static_cast<float>(-o) / tile_size)); };
+    const auto last_tile = [&](int o, int s) { return static_cast<int>(std::floor(static_cast<float>(s - 1 - o) / tile_size)); };
+
+    for (int y = first_tile(origin.y); y <= last_tile(origin.y, size.y); y += 1)
+    {
+        for (int x = first_tile(origin.x); x <= last_tile(origin.x, size.x); x += 1)
+        {
+            on_tile(TileKey{ level, x, y }, glm::ivec2{ origin.x + x * tile_size, origin.y + y * tile_size });
+        }
+    }
+}
+
+struct TileCacheStats
+{
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 evictions = 0;
+    u64 invalidations = 0;
+
+    [[nodiscard]] float get_hit_rate() const
+    {
+        const auto total = hits + misses;
+        return total == 0 ? 0.0f : static_cast<float>(hits) / static_cast<float>(total);
+    }
+};
+
+// Rendered tiles of the static layer, so a pan only has to draw the tiles that scrolled into view.
+// The least recently used tiles are dropped when the budget is full and their memory is
+// reused for the new tiles. Edits to the document only drop the tiles they touched.
+template<typename T>
+struct TileCache
+{
+    int tile_size = 256;
+    std::size_t budget_bytes = 64 * 1024 * 1024;
+
+    TileCacheStats stats;
+
+    [[nodiscard]] std::size_t get_tile_bytes() const
+    {
+        return static_cast<std::size_t>(tile_size) * tile_size * 4;
+    }
+
+    [[nodiscard]] std::size_t get_resident_bytes() const
+    {
+        return tiles.size() * get_tile_bytes();
+    }
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return tiles.size();
+    }
+
+    // the cached tile, render(T*, const TileKey&) is called to draw it on a miss.
+    // the tile may hold an evicted tile and is only valid until the next call
+    template<typename F>
+    const T& get(const TileKey& key, F&& render)
+    {
+        const auto found = lookup.find(key);
+        if (found != lookup.end())
+        {
+            stats.hits += 1;
+            tiles.splice(tiles.begin(), tiles, found->second);
+            return found->second->tile;
+        }
+
+        stats.misses += 1;
+        if (tiles.empty() == false && (tiles.size() + 1) * get_tile_bytes() > budget_bytes)
+        {
+            // reuse the least recently used tile
+            stats.evictions += 1;
+            lookup.erase(tiles.back().key);
+            tiles.splice(tiles.begin(), tiles, std::prev(tiles.end()));
+            tiles.front().key = key;
+        }
+        else
+        {
+            tiles.push_front(Entry{ key, T{} });
+        }
+
+        lookup[key] = tiles.begin();
+        render(&tiles.front().tile, key);
+        return tiles.front().tile;
+    }
+
+    // drop the tiles that show some of the world area
+    void invalidate(const Rect& area)
+    {
+        for (auto it = tiles.begin(); it != tiles.end();)
+        {
+            // a pixel of slack for antialiasing that bleeds over the shape bounds
+            const auto bounds = get_tile_world_bounds(it->key, tile_size).extend(1.0f / get_level_scale(it->key.level));
+            if (bounds.intersects(area))
+            {
+                stats.invalidations += 1;
+                lookup.erase(it->key);
+                it = tiles.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void clear()
+    {
+        stats.invalidations += tiles.size();
+        tiles.clear();
+        lookup.clear();
+    }
+
+    // drop the tiles the document has changed since the last sync
+    void sync(const Document& document)
+    {
+        if (has_synced && seen_version == document.version)
+        {
+            return;
+        }
+
+        const bool has_log = has_synced && document.get_changes_since(seen_version, [this](const Rect& area)
+        {
+            invalidate(area);
+        });
+        if (has_log == false)
+        {
+            clear();
+        }
+
+        has_synced = true;
+        seen_version = document.version;
+    }
+
+private:
+    struct Entry
+    {
+        TileKey key;
+        T tile;
+    };
+
+    // most recently used first
+    std::list<Entry> tiles;
+    std::unordered_map<TileKey, typename std::list<Entry>::iterator> lookup;
+
+    bool has_synced = false;
+    u64 seen_version = 0;
+};
@@ -0,0 +1,107 @@
+#include "vecy/tiled_raster.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "vecy/profiler.h"
+
+void TiledRasterizer::render(const DrawCommandList& list, Image* image, ThreadPool* pool)
+{
+    // with a single thread tiling only adds binning and per tile replay, one painter gives the same image
+    if (pool->get_thread_count() <= 1)
+    {
+        VECY_PROFILE_SCOPE("raster commands");
+        RasterPainter painter{ image };
+        for (const auto& command : list.commands)
+        {
+            replay(&painter, list, command);
+        }
+        stats = painter.stats;
+        return;
+    }
+
+    const int columns = (image->width + tile_size - 1) / tile_size;
+    const int rows = (image->height + tile_size - 1) / tile_size;
+    const int tile_count = columns * rows;
+
+    // the commands are binned in chunks on all threads, each chunk has its own bins per tile
+    // so the tiles can walk the chunks in order and still replay in recorded order.
+    // the bins hold copies of the commands so a tile reads them in order instead of jumping around the list
+    const auto& commands = list.commands;
+    const int chunk_count = std::max(1, std::min(pool->get_thread_count(), static_cast<int>(commands.size() / 1024)));
+    bins.resize(static_cast<std::size_t>(chunk_count) * tile_count);
+
+    pool->parallel_for(chunk_count, [&](int chunk)
+    {
+        VECY_PROFILE_SCOPE("bin commands");
+        auto* chunk_bins = bins.data() + static_cast<std::size_t>(chunk) * tile_count;
+        for (int tile = 0; tile < tile_count; tile += 1)
+        {
+            chunk_bins[tile].clear();
+        }
+
+        const auto first = static_cast<u32>(commands.size() * chunk / chunk_count);
+        const auto last = static_cast<u32>(commands.size() * (chunk + 1) / chunk_count);
+        for (u32 index = first; index < last; index += 1)
+        {
+            const auto bounds = get_bounds(commands[index]);
+
+            int first_column = 0;
+            int last_column = columns - 1;
+            int first_row = 0;
+            int last_row = rows - 1;
+            if (bounds)
+            {
+                // clamped to a pixel past the image before it's made an int, shapes far off screen can be anywhere
+                const auto to_x = [&](float x) { return static_cast<int>(std::min(std::max(-1.0f, std::floor(x)), static_cast<float>(image->width))); };
+                const auto to_y = [&](float y) { return static_cast<int>(std::min(std::max(-1.0f, std::floor(y)), static_cast<float>(image->height))); };
+                const auto bottomright = bounds->get_bottomright();
+                const int left = to_x(bounds->topleft.x);
+                const int top = to_y(bounds->topleft.y);
+                const int right = to_x(bottomright.x);
+                const int bottom = to_y(bottomright.y);
+                if (right < 0 || bottom < 0 || left >= image->width || top >= image->height)
+                {
+                    continue;
+                }
+                first_column = std::max(0, left) / tile_size;
+                first_row = std::max(0, top) / tile_size;
+                last_column = std::min(image->width - 1, right) / tile_size;
+                last_row = std::min(image->height - 1, bottom) / tile_size;
+            }
+
+            for (int row = first_row; row <= last_row; row += 1)
+            {
+                for (int column = first_column; column <= last_column; column += 1)
+                {
+                    chunk_bins[row * columns + column].push_back(commands[index]);
+                }
+            }
+        }
+    });
+
+    tile_stats.assign(tile_count, PainterStats{});
+    pool->parallel_for(tile_count, [&](int tile)
+    {
+        VECY_PROFILE_SCOPE("raster tile");
+        const int x = (tile % columns) * tile_size;
+        const int y = (tile / columns) * tile_size;
+
+        RasterPainter painter{ image };
+        painter.set_clip(Rect{ {x, y}, {tile_size, tile_size} });
+        for (int chunk = 0; chunk < chunk_count; chunk += 1)
+        {
+            for (const auto& command : bins[static_cast<std::size_t>(chunk) * tile_count + tile])
+            {
+                replay(&painter, list, command);
+            }
+        }
+        tile_stats[tile] = painter.stats;
+    });
+
+    stats = {};
+    for (const auto& s : tile_stats)
+    {
+        stats = stats + s;
+    }
+}
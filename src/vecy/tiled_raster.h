@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+#include "vecy/types.h"
+#include "vecy/painter.h"
+#include "vecy/raster.h"
+#include "vecy/thread_pool.h"
+
+// Rasterizes recorded draw commands in screen tiles on a thread pool.
+// Each tile replays only the commands that overlap it, in the order they were recorded,
+// and a pixel is only ever touched by its own tile, so the image is identical to
+// replaying everything on a single raster painter no matter the thread count.
+struct TiledRasterizer
+{
+    int tile_size = 64;
+
+    // summed over the tiles, a primitive is counted once for every tile it touches
+    // unless the pool has a single thread and nothing is tiled
+    PainterStats stats;
+
+    void render(const DrawCommandList& list, Image* image, ThreadPool* pool);
+
+private:
+    // the commands that overlap each tile for each chunk of commands, reused between frames
+    std::vector<std::vector<DrawCommand>> bins;
+    std::vector<PainterStats> tile_stats;
+};
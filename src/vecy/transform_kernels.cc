@@ -0,0 +1,252 @@
+#include "vecy/transform_kernels.h"
+
+#include "vecy/cpu.h"
+
+// the vector kernels read points and rects as packed floats
+static_assert(sizeof(glm::vec2) == 2 * sizeof(float), "points must be packed");
+static_assert(sizeof(Rect) == 4 * sizeof(float), "rects must be packed");
+
+namespace
+{
+    void scalar_points_to_screen(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            dst[i] = t.from_world_to_screen(src[i]);
+        }
+    }
+
+    void scalar_points_to_world(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            dst[i] = t.from_screen_to_world(src[i]);
+        }
+    }
+
+    void scalar_rects_to_screen(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            dst[i] = from_world_to_screen(t, src[i]);
+        }
+    }
+
+    void scalar_rects_to_world(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            dst[i] = from_screen_to_world(t, src[i]);
+        }
+    }
+
+    const TransformKernels scalar_kernels =
+    {
+        "scalar",
+        scalar_points_to_screen, scalar_points_to_world,
+        scalar_rects_to_screen, scalar_rects_to_world
+    };
+
+#if defined(VECY_X86)
+
+    // the same operations in the same order as the scalar functions, a multiply and an add
+    // are never fused so the results match to the bit.
+    // a rect is x, y, w, h in a register, the corners are x, y, x + w, y + h and the
+    // transformed rect is the first corner and the difference to the second
+
+    VECY_TARGET("sse2")
+    __m128 sse2_get_corners(__m128 r)
+    {
+        const auto sum = _mm_add_ps(_mm_movelh_ps(r, r), r);
+        return _mm_shuffle_ps(r, sum, _MM_SHUFFLE(3, 2, 1, 0));
+    }
+
+    VECY_TARGET("sse2")
+    __m128 sse2_from_corners(__m128 c)
+    {
+        const auto size = _mm_sub_ps(c, _mm_movelh_ps(c, c));
+        return _mm_shuffle_ps(c, size, _MM_SHUFFLE(3, 2, 1, 0));
+    }
+
+    VECY_TARGET("sse2")
+    void sse2_points_to_screen(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count)
+    {
+        const auto scroll = _mm_setr_ps(t.scroll.x, t.scroll.y, t.scroll.x, t.scroll.y);
+        const auto scale = _mm_set1_ps(t.scale);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const auto p = _mm_loadu_ps(&src[i].x);
+            _mm_storeu_ps(&dst[i].x, _mm_add_ps(scroll, _mm_mul_ps(p, scale)));
+        }
+        scalar_points_to_screen(t, src + i, dst + i, count - i);
+    }
+
+    VECY_TARGET("sse2")
+    void sse2_points_to_world(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count)
+    {
+        const auto scroll = _mm_setr_ps(t.scroll.x, t.scroll.y, t.scroll.x, t.scroll.y);
+        const auto scale = _mm_set1_ps(t.scale);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const auto p = _mm_loadu_ps(&src[i].x);
+            _mm_storeu_ps(&dst[i].x, _mm_div_ps(_mm_sub_ps(p, scroll), scale));
+        }
+        scalar_points_to_world(t, src + i, dst + i, count - i);
+    }
+
+    VECY_TARGET("sse2")
+    void sse2_rects_to_screen(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count)
+    {
+        const auto scroll = _mm_setr_ps(t.scroll.x, t.scroll.y, t.scroll.x, t.scroll.y);
+        const auto scale = _mm_set1_ps(t.scale);
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            const auto c = sse2_get_corners(_mm_loadu_ps(&src[i].topleft.x));
+            _mm_storeu_ps(&dst[i].topleft.x, sse2_from_corners(_mm_add_ps(scroll, _mm_mul_ps(c, scale))));
+        }
+    }
+
+    VECY_TARGET("sse2")
+    void sse2_rects_to_world(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count)
+    {
+        const auto scroll = _mm_setr_ps(t.scroll.x, t.scroll.y, t.scroll.x, t.scroll.y);
+        const auto scale = _mm_set1_ps(t.scale);
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            const auto c = sse2_get_corners(_mm_loadu_ps(&src[i].topleft.x));
+            _mm_storeu_ps(&dst[i].topleft.x, sse2_from_corners(_mm_div_ps(_mm_sub_ps(c, scroll), scale)));
+        }
+    }
+
+    // only avx is used, but it's picked together with the avx2 span kernels.
+    // the shuffles work within 128 bit lanes so each lane is one rect
+    VECY_TARGET("avx2")
+    __m256 avx2_get_corners(__m256 r)
+    {
+        const auto sum = _mm256_add_ps(_mm256_shuffle_ps(r, r, _MM_SHUFFLE(1, 0, 1, 0)), r);
+        return _mm256_shuffle_ps(r, sum, _MM_SHUFFLE(3, 2, 1, 0));
+    }
+
+    VECY_TARGET("avx2")
+    __m256 avx2_from_corners(__m256 c)
+    {
+        const auto size = _mm256_sub_ps(c, _mm256_shuffle_ps(c, c, _MM_SHUFFLE(1, 0, 1, 0)));
+        return _mm256_shuffle_ps(c, size, _MM_SHUFFLE(3, 2, 1, 0));
+    }
+
+    VECY_TARGET("avx2")
+    __m256 avx2_get_scroll(const CanvasTransform& t)
+    {
+        return _mm256_setr_ps(t.scroll.x, t.scroll.y, t.scroll.x, t.scroll.y, t.scroll.x, t.scroll.y, t.scroll.x, t.scroll.y);
+    }
+
+    VECY_TARGET("avx2")
+    void avx2_points_to_screen(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count)
+    {
+        const auto scroll = avx2_get_scroll(t);
+        const auto scale = _mm256_set1_ps(t.scale);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const auto p = _mm256_loadu_ps(&src[i].x);
+            _mm256_storeu_ps(&dst[i].x, _mm256_add_ps(scroll, _mm256_mul_ps(p, scale)));
+        }
+        scalar_points_to_screen(t, src + i, dst + i, count - i);
+    }
+
+    VECY_TARGET("avx2")
+    void avx2_points_to_world(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count)
+    {
+        const auto scroll = avx2_get_scroll(t);
+        const auto scale = _mm256_set1_ps(t.scale);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const auto p = _mm256_loadu_ps(&src[i].x);
+            _mm256_storeu_ps(&dst[i].x, _mm256_div_ps(_mm256_sub_ps(p, scroll), scale));
+        }
+        scalar_points_to_world(t, src + i, dst + i, count - i);
+    }
+
+    VECY_TARGET("avx2")
+    void avx2_rects_to_screen(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count)
+    {
+        const auto scroll = avx2_get_scroll(t);
+        const auto scale = _mm256_set1_ps(t.scale);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const auto c = avx2_get_corners(_mm256_loadu_ps(&src[i].topleft.x));
+            _mm256_storeu_ps(&dst[i].topleft.x, avx2_from_corners(_mm256_add_ps(scroll, _mm256_mul_ps(c, scale))));
+        }
+        scalar_rects_to_screen(t, src + i, dst + i, count - i);
+    }
+
+    VECY_TARGET("avx2")
+    void avx2_rects_to_world(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count)
+    {
+        const auto scroll = avx2_get_scroll(t);
+        const auto scale = _mm256_set1_ps(t.scale);
+        std::size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            const auto c = avx2_get_corners(_mm256_loadu_ps(&src[i].topleft.x));
+            _mm256_storeu_ps(&dst[i].topleft.x, avx2_from_corners(_mm256_div_ps(_mm256_sub_ps(c, scroll), scale)));
+        }
+        scalar_rects_to_world(t, src + i, dst + i, count - i);
+    }
+
+    const TransformKernels sse2_kernels =
+    {
+        "sse2",
+        sse2_points_to_screen, sse2_points_to_world,
+        sse2_rects_to_screen, sse2_rects_to_world
+    };
+
+    const TransformKernels avx2_kernels =
+    {
+        "avx2",
+        avx2_points_to_screen, avx2_points_to_world,
+        avx2_rects_to_screen, avx2_rects_to_world
+    };
+
+#endif
+}
+
+const TransformKernels& get_scalar_transform_kernels()
+{
+    return scalar_kernels;
+}
+
+const TransformKernels* get_sse2_transform_kernels()
+{
+#if defined(VECY_X86)
+    static const bool is_supported = has_sse2();
+    return is_supported ? &sse2_kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const TransformKernels* get_avx2_transform_kernels()
+{
+#if defined(VECY_X86)
+    static const bool is_supported = has_avx2();
+    return is_supported ? &avx2_kernels : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const TransformKernels& get_transform_kernels()
+{
+    static const TransformKernels* best = []()
+    {
+        if (const auto* avx2 = get_avx2_transform_kernels()) { return avx2; }
+        if (const auto* sse2 = get_sse2_transform_kernels()) { return sse2; }
+        return &scalar_kernels;
+    }();
+    return *best;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+#include "glm/vec2.hpp"
+
+#include "vecy/rect.h"
+#include "vecy/canvas_transform.h"
+
+// The functions that move arrays of points and rects between world and screen space.
+// Every kernel gives the same result to the bit as the single point and rect functions in canvas_transform.h.
+// src and dst can be the same array, but may not partially overlap.
+struct TransformKernels
+{
+    const char* name;
+
+    void (*points_to_screen)(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count);
+    void (*points_to_world)(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count);
+    void (*rects_to_screen)(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count);
+    void (*rects_to_world)(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count);
+};
+
+const TransformKernels& get_scalar_transform_kernels();
+
+// null if the kernels aren't compiled in or the cpu doesn't support them
+const TransformKernels* get_sse2_transform_kernels();
+const TransformKernels* get_avx2_transform_kernels();
+
+// the fastest kernels the cpu supports, picked on the first call
+const TransformKernels& get_transform_kernels();
+
+// batch versions of the canvas_transform.h functions
+inline void from_world_to_screen(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count)
+{
+    get_transform_kernels().points_to_screen(t, src, dst, count);
+}
+
+inline void from_screen_to_world(const CanvasTransform& t, const glm::vec2* src, glm::vec2* dst, std::size_t count)
+{
+    get_transform_kernels().points_to_world(t, src, dst, count);
+}
+
+inline void from_world_to_screen(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count)
+{
+    get_transform_kernels().rects_to_screen(t, src, dst, count);
+}
+
+inline void from_screen_to_world(const CanvasTransform& t, const Rect* src, Rect* dst, std::size_t count)
+{
+    get_transform_kernels().rects_to_world(t, src, dst, count);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+using u8 = std::uint8_t;
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+
+struct Id
+{
+    u64 id;
+
+    bool operator==(const Id& rhs) const
+    {
+        return id == rhs.id;
+    }
+
+    bool operator!=(const Id& rhs) const
+    {
+        return id != rhs.id;
+    }
+};
+
+namespace std
+{
+	template<>
+	struct hash<Id>
+	{
+		std::size_t operator()(const Id& k) const
+		{
+            return hash<u64>{}(k.id);
+		}
+	};
+}
+
+struct IdGenerator
+{
+    u64 next = 0;
+
+    Id create()
+    {
+        const u64 value = next;
+        next += 1;
+        return { value };
+    }
+};
@@ -0,0 +1,47 @@
+#include "vecy_bench/allocation_stats.h"
+
+#include <new>
+#include <cstdlib>
+
+// the operators are in their own file so they aren't inlined where the compiler knows which object is
+// deleted, it would then see the header in front of the object as out of bounds
+
+AllocationStats allocation_stats;
+
+namespace
+{
+    // every allocation is prefixed with its size, aligned so the memory after it is aligned like malloc's
+    struct alignas(std::max_align_t) AllocationHeader
+    {
+        std::size_t size;
+    };
+}
+
+void* operator new(std::size_t size)
+{
+    void* memory = std::malloc(sizeof(AllocationHeader) + size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc{};
+    }
+    auto* header = new (memory) AllocationHeader{ size };
+    allocation_stats.live_bytes.fetch_add(size, std::memory_order_relaxed);
+    allocation_stats.allocations.fetch_add(1, std::memory_order_relaxed);
+    return header + 1;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    auto* header = static_cast<AllocationHeader*>(ptr) - 1;
+    allocation_stats.live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    std::free(header);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
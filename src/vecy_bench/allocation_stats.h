@@ -0,0 +1,26 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Heap usage of the whole process, counted by the replaced global operator new and delete,
+// so the benchmarks can report memory per shape and check that a loop doesn't allocate.
+// The thread pool workers allocate too so the counts are atomic, relaxed as they are only read
+// once the work is done.
+struct AllocationStats
+{
+    std::atomic<std::size_t> live_bytes{ 0 };
+    std::atomic<std::size_t> allocations{ 0 };
+
+    [[nodiscard]] std::size_t get_live_bytes() const
+    {
+        return live_bytes.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::size_t get_allocations() const
+    {
+        return allocations.load(std::memory_order_relaxed);
+    }
+};
+
+extern AllocationStats allocation_stats;
@@ -0,0 +1,2924 @@
+// Benchmarks for the core data structures, run without a window.
+// vecy_bench --check [name] runs the correctness checks instead, ctest runs each of them.
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <functional>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/canvas_transform.h"
+#include "vecy/spatial_index.h"
+#include "vecy/rgba.h"
+#include "vecy/shape_store.h"
+#include "vecy/span_kernels.h"
+#include "vecy/transform_kernels.h"
+#include "vecy/document.h"
+#include "vecy/document_file.h"
+#include "vecy/render.h"
+#include "vecy/raster.h"
+#include "vecy/thread_pool.h"
+#include "vecy/tiled_raster.h"
+#include "vecy/tile_cache.h"
+#include "vecy/svg.h"
+
+#include "vecy_bench/allocation_stats.h"
+#include "vecy_bench/scenes.h"
+#include "vecy_bench/suite.h"
+#include "vecy/history.h"
+#include "vecy/profiler.h"
+
+
+struct Timer
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    double get_elapsed_ns() const
+    {
+        const auto now = std::chrono::steady_clock::now();
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+    }
+};
+
+struct Scene
+{
+    std::unordered_map<Id, Rect> shapes;
+    SpatialIndex index;
+    float world_size;
+};
+
+Scene make_uniform_scene(int count)
+{
+    std::mt19937 gen(42);
+
+    Scene scene;
+    // keep the density constant so the number of hits per query is comparable
+    scene.world_size = std::sqrt(static_cast<float>(count)) * 40.0f;
+    std::uniform_real_distribution<float> position(0.0f, scene.world_size);
+    std::uniform_real_distribution<float> size(5.0f, 30.0f);
+
+    IdGenerator ids;
+    for (int i = 0; i < count; i += 1)
+    {
+        const auto id = ids.create();
+        const auto rect = Rect{ {position(gen), position(gen)}, {size(gen), size(gen)} };
+        scene.shapes[id] = rect;
+        scene.index.insert(id, rect);
+    }
+
+    return scene;
+}
+
+// the linear scan, as CanvasWidget::get_hit did it before the index
+int linear_hit(const Scene& scene, const CanvasTransform& t, const glm::vec2& p, float extra)
+{
+    int hits = 0;
+    for (const auto& shape : scene.shapes)
+    {
+        if (from_world_to_screen(t, shape.second).extend(extra).contains(p))
+        {
+            hits += 1;
+        }
+    }
+    return hits;
+}
+
+int indexed_hit(const Scene& scene, const CanvasTransform& t, const glm::vec2& p, float extra)
+{
+    int hits = 0;
+    const auto world = t.from_screen_to_world(p);
+    const auto query = Rect{ world, {0, 0} }.extend((extra + 1.0f) / t.scale);
+    scene.index.query_intersecting(query, [&](Id, const Rect& r)
+    {
+        if (from_world_to_screen(t, r).extend(extra).contains(p))
+        {
+            hits += 1;
+        }
+    });
+    return hits;
+}
+
+int linear_marquee(const Scene& scene, const Rect& world, bool enclosed)
+{
+    int hits = 0;
+    for (const auto& shape : scene.shapes)
+    {
+        const bool hit = enclosed ? world.contains(shape.second) : world.intersects(shape.second);
+        if (hit)
+        {
+            hits += 1;
+        }
+    }
+    return hits;
+}
+
+int indexed_marquee(const Scene& scene, const Rect& world, bool enclosed)
+{
+    int hits = 0;
+    const auto on_hit = [&](Id, const Rect&) { hits += 1; };
+    if (enclosed)
+    {
+        scene.index.query_enclosed(world, on_hit);
+    }
+    else
+    {
+        scene.index.query_intersecting(world, on_hit);
+    }
+    return hits;
+}
+
+template<typename F>
+double measure_ns_per_op(int ops, F&& f)
+{
+    const auto timer = Timer{};
+    for (int i = 0; i < ops; i += 1)
+    {
+        f(i);
+    }
+    return timer.get_elapsed_ns() / ops;
+}
+
+void bench_spatial_index(int count)
+{
+    const auto scene = make_uniform_scene(count);
+
+    std::mt19937 gen(1337);
+    std::uniform_real_distribution<float> position(0.0f, scene.world_size);
+    std::uniform_real_distribution<float> marquee_size(50.0f, 400.0f);
+
+    constexpr int query_count = 1000;
+    // the linear scans are slow on large scenes, so run fewer of them
+    const int linear_count = std::max(10, std::min(query_count, 10000000 / count));
+    const auto t = CanvasTransform{};
+
+    std::vector<glm::vec2> points;
+    std::vector<Rect> marquees;
+    for (int i = 0; i < query_count; i += 1)
+    {
+        points.emplace_back(position(gen), position(gen));
+        marquees.push_back(Rect{ {position(gen), position(gen)}, {marquee_size(gen), marquee_size(gen)} });
+    }
+
+    // the index must agree with the linear scan before timing it
+    int mismatches = 0;
+    for (int i = 0; i < linear_count; i += 1)
+    {
+        if (linear_hit(scene, t, points[i], 10.0f) != indexed_hit(scene, t, points[i], 10.0f)) { mismatches += 1; }
+        if (linear_marquee(scene, marquees[i], true) != indexed_marquee(scene, marquees[i], true)) { mismatches += 1; }
+        if (linear_marquee(scene, marquees[i], false) != indexed_marquee(scene, marquees[i], false)) { mismatches += 1; }
+    }
+
+    int sink = 0;
+    const auto linear_hit_ns = measure_ns_per_op(linear_count, [&](int i) { sink += linear_hit(scene, t, points[i], 10.0f); });
+    const auto indexed_hit_ns = measure_ns_per_op(query_count, [&](int i) { sink += indexed_hit(scene, t, points[i], 10.0f); });
+    const auto linear_enclosed_ns = measure_ns_per_op(linear_count, [&](int i) { sink += linear_marquee(scene, marquees[i], true); });
+    const auto indexed_enclosed_ns = measure_ns_per_op(query_count, [&](int i) { sink += indexed_marquee(scene, marquees[i], true); });
+    const auto linear_intersect_ns = measure_ns_per_op(linear_count, [&](int i) { sink += linear_marquee(scene, marquees[i], false); });
+    const auto indexed_intersect_ns = measure_ns_per_op(query_count, [&](int i) { sink += indexed_marquee(scene, marquees[i], false); });
+
+    std::printf
+    (
+        "%9d | %12.0f %12.0f | %12.0f %12.0f | %12.0f %12.0f | %6d | %d\n",
+        count,
+        linear_hit_ns, indexed_hit_ns,
+        linear_enclosed_ns, indexed_enclosed_ns,
+        linear_intersect_ns, indexed_intersect_ns,
+        scene.index.get_height(),
+        mismatches
+    );
+
+    if (sink == 42) { std::printf(" "); }
+}
+
+// the shape storage before the shape store, a heap allocated object per shape
+struct LegacyShape
+{
+    Id id;
+    explicit LegacyShape(Id i) : id(i) {}
+    virtual ~LegacyShape() = default;
+    virtual float paint(const CanvasTransform& t) const = 0;
+};
+
+struct LegacyRectangleShape : LegacyShape
+{
+    Rgba color;
+    Rect rect;
+
+    LegacyRectangleShape(Id i, Rgba c, Rect r) : LegacyShape(i), color(c), rect(r) {}
+
+    float paint(const CanvasTransform& t) const override
+    {
+        const auto r = from_world_to_screen(t, rect);
+        return r.size.x * r.size.y + color.r;
+    }
+};
+
+float paint_all(const std::unordered_map<Id, std::shared_ptr<LegacyShape>>& shapes, const CanvasTransform& t)
+{
+    float sum = 0.0f;
+    for (const auto& shape : shapes)
+    {
+        sum += shape.second->paint(t);
+    }
+    return sum;
+}
+
+float paint_all(const ShapeStore& store, const CanvasTransform& t)
+{
+    float sum = 0.0f;
+    const auto& rectangles = store.rectangles;
+    for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+    {
+        const auto r = from_world_to_screen(t, rectangles.rects[slot]);
+        sum += r.size.x * r.size.y + rectangles.colors[slot].r;
+    }
+    return sum;
+}
+
+void bench_shape_store(int count)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> position(0.0f, 10000.0f);
+    std::uniform_real_distribution<float> size(5.0f, 30.0f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+
+    std::vector<RectangleShape> source;
+    source.reserve(count);
+    IdGenerator ids;
+    for (int i = 0; i < count; i += 1)
+    {
+        source.push_back({ ids.create(), Rgba{color(gen)}, Rect{ {position(gen), position(gen)}, {size(gen), size(gen)} } });
+    }
+
+    const auto t = CanvasTransform{};
+    constexpr int iterations = 10;
+    float sink = 0.0f;
+
+    double legacy_bytes = 0.0;
+    double legacy_ns = 0.0;
+    {
+        const auto before = allocation_stats.get_live_bytes();
+        std::unordered_map<Id, std::shared_ptr<LegacyShape>> shapes;
+        for (const auto& s : source)
+        {
+            shapes[s.id] = std::make_shared<LegacyRectangleShape>(s.id, s.color, s.rect);
+        }
+        legacy_bytes = static_cast<double>(allocation_stats.get_live_bytes() - before);
+        legacy_ns = measure_ns_per_op(iterations, [&](int) { sink += paint_all(shapes, t); });
+    }
+
+    double store_bytes = 0.0;
+    double store_ns = 0.0;
+    {
+        const auto before = allocation_stats.get_live_bytes();
+        ShapeStore store;
+        store.rectangles.reserve(count);
+        for (const auto& s : source)
+        {
+            store.add(s);
+        }
+        store_bytes = static_cast<double>(allocation_stats.get_live_bytes() - before);
+        store_ns = measure_ns_per_op(iterations, [&](int) { sink += paint_all(store, t); });
+    }
+
+    std::printf
+    (
+        "%9d | %12.1f %12.1f | %12.3f %12.3f\n",
+        count,
+        legacy_bytes / count, store_bytes / count,
+        legacy_ns / 1000000.0, store_ns / 1000000.0
+    );
+
+    if (sink == 42.0f) { std::printf(" "); }
+}
+
+// the span kernels that can run on this cpu, the scalar ones first
+std::vector<const SpanKernels*> get_supported_kernels()
+{
+    std::vector<const SpanKernels*> kernels = { &get_scalar_kernels() };
+    if (const auto* sse2 = get_sse2_kernels()) { kernels.push_back(sse2); }
+    if (const auto* avx2 = get_avx2_kernels()) { kernels.push_back(avx2); }
+    return kernels;
+}
+
+// run every kernel on random rows and compare them with the scalar result, returns the number of differing pixels
+int check_span_kernels(const SpanKernels& kernels)
+{
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<u32> pixel;
+    std::uniform_int_distribution<int> alpha_pick(0, 3);
+    std::uniform_int_distribution<int> offset(0, 15);
+    std::uniform_int_distribution<int> length(0, 100);
+    std::uniform_int_distribution<int> style(0, 6);
+
+    const auto& scalar = get_scalar_kernels();
+    constexpr int width = 128;
+    std::vector<Pixel> expected(width);
+    std::vector<Pixel> actual(width);
+
+    int mismatches = 0;
+    for (int test = 0; test < 20000; test += 1)
+    {
+        for (auto& p : expected) { p = pixel(gen); }
+        actual = expected;
+
+        // include the alpha edge cases
+        const u32 alphas[] = { 0, 255, 1, pixel(gen) & 0xFF };
+        const Pixel color = (pixel(gen) & 0xFFFFFF) | (alphas[alpha_pick(gen)] << 24);
+        const int start = offset(gen);
+        const int count = length(gen);
+        const auto row = get_hatch_row(static_cast<FillStyle>(style(gen)), test);
+
+        switch (test % 4)
+        {
+        case 0:
+            scalar.fill(expected.data() + start, count, color);
+            kernels.fill(actual.data() + start, count, color);
+            break;
+        case 1:
+            scalar.blend(expected.data() + start, count, color);
+            kernels.blend(actual.data() + start, count, color);
+            break;
+        case 2:
+            scalar.hatch_fill(expected.data() + start, start, count, row, color);
+            kernels.hatch_fill(actual.data() + start, start, count, row, color);
+            break;
+        case 3:
+            scalar.hatch_blend(expected.data() + start, start, count, row, color);
+            kernels.hatch_blend(actual.data() + start, start, count, row, color);
+            break;
+        }
+
+        for (int i = 0; i < width; i += 1)
+        {
+            if (expected[i] != actual[i]) { mismatches += 1; }
+        }
+    }
+    return mismatches;
+}
+
+void bench_span_kernels(const SpanKernels& kernels)
+{
+    // a full hd frame, filled a row at a time like the raster painter does
+    constexpr int width = 1920;
+    constexpr int height = 1080;
+    constexpr int iterations = 20;
+    std::vector<Pixel> image(static_cast<std::size_t>(width) * height, 0xFF202020);
+
+    const Pixel opaque = 0xFF3080F0;
+    const Pixel translucent = 0x803080F0;
+
+    const auto get_mpixels_per_s = [&](auto&& fill_row)
+    {
+        const auto ns = measure_ns_per_op(iterations, [&](int)
+        {
+            for (int y = 0; y < height; y += 1)
+            {
+                fill_row(image.data() + static_cast<std::size_t>(y) * width, y);
+            }
+        });
+        return (static_cast<double>(width) * height) / (ns / 1000.0);
+    };
+
+    const auto fill = get_mpixels_per_s([&](Pixel* row, int) { kernels.fill(row, width, opaque); });
+    const auto blend = get_mpixels_per_s([&](Pixel* row, int) { kernels.blend(row, width, translucent); });
+    const auto hatch_fill = get_mpixels_per_s([&](Pixel* row, int y)
+    {
+        kernels.hatch_fill(row, 0, width, get_hatch_row(FillStyle::bdiagonal_hatch, y), opaque);
+    });
+    const auto hatch_blend = get_mpixels_per_s([&](Pixel* row, int y)
+    {
+        kernels.hatch_blend(row, 0, width, get_hatch_row(FillStyle::fdiagonal_hatch, y), translucent);
+    });
+
+    std::printf
+    (
+        "%9s | %12.0f %12.0f %12.0f %12.0f | %d\n",
+        kernels.name, fill, blend, hatch_fill, hatch_blend, check_span_kernels(kernels)
+    );
+}
+
+std::vector<const TransformKernels*> get_supported_transform_kernels()
+{
+    std::vector<const TransformKernels*> kernels = { &get_scalar_transform_kernels() };
+    if (const auto* sse2 = get_sse2_transform_kernels()) { kernels.push_back(sse2); }
+    if (const auto* avx2 = get_avx2_transform_kernels()) { kernels.push_back(avx2); }
+    return kernels;
+}
+
+// compare every kernel with the single point and rect functions, to the bit and for every tail length, returns the number of differing values
+int check_transform_kernels(const TransformKernels& kernels)
+{
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<float> coord(-5000.0f, 5000.0f);
+    std::uniform_real_distribution<float> scale(0.1f, 15.0f);
+
+    int mismatches = 0;
+    const auto add_mismatches = [&](const void* expected, const void* actual, std::size_t bytes)
+    {
+        if (bytes != 0 && std::memcmp(expected, actual, bytes) != 0) { mismatches += 1; }
+    };
+    for (std::size_t count = 0; count < 40; count += 1)
+    {
+        CanvasTransform t;
+        t.scroll = { coord(gen), coord(gen) };
+        t.scale = scale(gen);
+
+        std::vector<glm::vec2> points(count);
+        std::vector<Rect> rects(count);
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            points[i] = { coord(gen), coord(gen) };
+            rects[i] = Rect{ {coord(gen), coord(gen)}, {coord(gen) * 0.1f, coord(gen) * 0.1f} };
+        }
+
+        std::vector<glm::vec2> expected_points(count);
+        std::vector<glm::vec2> actual_points = points;
+        for (std::size_t i = 0; i < count; i += 1) { expected_points[i] = t.from_world_to_screen(points[i]); }
+        kernels.points_to_screen(t, actual_points.data(), actual_points.data(), count);
+        add_mismatches(expected_points.data(), actual_points.data(), count * sizeof(glm::vec2));
+
+        actual_points = points;
+        for (std::size_t i = 0; i < count; i += 1) { expected_points[i] = t.from_screen_to_world(points[i]); }
+        kernels.points_to_world(t, actual_points.data(), actual_points.data(), count);
+        add_mismatches(expected_points.data(), actual_points.data(), count * sizeof(glm::vec2));
+
+        std::vector<Rect> expected_rects(count);
+        std::vector<Rect> actual_rects(count);
+        for (std::size_t i = 0; i < count; i += 1) { expected_rects[i] = from_world_to_screen(t, rects[i]); }
+        kernels.rects_to_screen(t, rects.data(), actual_rects.data(), count);
+        add_mismatches(expected_rects.data(), actual_rects.data(), count * sizeof(Rect));
+
+        for (std::size_t i = 0; i < count; i += 1) { expected_rects[i] = from_screen_to_world(t, rects[i]); }
+        kernels.rects_to_world(t, rects.data(), actual_rects.data(), count);
+        add_mismatches(expected_rects.data(), actual_rects.data(), count * sizeof(Rect));
+    }
+    return mismatches;
+}
+
+void bench_transform_kernels(const TransformKernels& kernels)
+{
+    // a batch the size render_shapes uses, transformed over and over so it measures the kernel and not memory
+    constexpr std::size_t count = 256;
+    constexpr int iterations = 20000;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> coord(0.0f, 10000.0f);
+    std::vector<glm::vec2> points(count);
+    std::vector<Rect> rects(count);
+    for (std::size_t i = 0; i < count; i += 1)
+    {
+        points[i] = { coord(gen), coord(gen) };
+        rects[i] = Rect{ {coord(gen), coord(gen)}, {20.0f, 10.0f} };
+    }
+    std::vector<glm::vec2> point_results(count);
+    std::vector<Rect> rect_results(count);
+
+    CanvasTransform t;
+    t.scroll = { -1234.5f, 678.25f };
+    t.scale = 0.37f;
+
+    const auto get_m_per_s = [&](auto&& transform)
+    {
+        const auto ns = measure_ns_per_op(iterations, [&](int) { transform(); });
+        return static_cast<double>(count) / (ns / 1000.0);
+    };
+    const auto points_to_screen = get_m_per_s([&]() { kernels.points_to_screen(t, points.data(), point_results.data(), count); });
+    const auto points_to_world = get_m_per_s([&]() { kernels.points_to_world(t, points.data(), point_results.data(), count); });
+    const auto rects_to_screen = get_m_per_s([&]() { kernels.rects_to_screen(t, rects.data(), rect_results.data(), count); });
+    const auto rects_to_world = get_m_per_s([&]() { kernels.rects_to_world(t, rects.data(), rect_results.data(), count); });
+
+    std::printf
+    (
+        "%9s | %12.0f %12.0f %12.0f %12.0f | %d\n",
+        kernels.name, points_to_screen, points_to_world, rects_to_screen, rects_to_world, check_transform_kernels(kernels)
+    );
+}
+
+// everything the canvas draws for a frame with a selection and a marquee, in the same order
+void render_frame(Painter* painter, Document* document, const CanvasTransform& t, const glm::ivec2& size, const IdSet& selection)
+{
+    // every shape is drawn on its own so this measures the rasterizer and not the level of detail
+    Settings settings;
+    settings.lod_pixel_threshold = 0.0f;
+    RenderCache cache;
+    render_scene(painter, document, settings, t, size, &cache);
+    render_handles(painter, *document, settings, t, size, selection, {}, &cache);
+    render_selection_box(painter, settings, Rect{ {100, 100}, {400, 300} }, false);
+}
+
+void bench_tiled_raster(int count)
+{
+    std::mt19937 gen(42);
+    const float world_size = std::sqrt(static_cast<float>(count)) * 40.0f;
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(5.0f, 30.0f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+    std::uniform_int_distribution<int> alpha(0, 3);
+
+    Document document;
+    IdSet selection;
+    for (int i = 0; i < count; i += 1)
+    {
+        // a quarter of the shapes are translucent so blending is part of the frame
+        const auto c = Rgba{ color(gen), static_cast<u8>(alpha(gen) == 0 ? 128 : 255) };
+        const auto id = document.add_rectangle(c, Rect{ {position(gen), position(gen)}, {size(gen), size(gen)} });
+        if (i % (count / 100) == 0)
+        {
+            selection.insert(id);
+        }
+    }
+
+    // zoomed out so every shape is on screen
+    const auto screen = glm::ivec2{ 1920, 1080 };
+    CanvasTransform t;
+    t.scale = static_cast<float>(screen.y) / world_size;
+
+    constexpr int iterations = 3;
+
+    // the tiles must give the same image as drawing everything at once
+    Image expected{ screen.x, screen.y };
+    {
+        RasterPainter painter{ &expected };
+        render_frame(&painter, &document, t, screen, selection);
+    }
+
+    DrawCommandList commands;
+    RecordingPainter recorder{ &commands };
+    render_frame(&recorder, &document, t, screen, selection);
+
+    Image single{ screen.x, screen.y };
+    const auto single_ns = measure_ns_per_op(iterations, [&](int)
+    {
+        RasterPainter painter{ &single };
+        for (const auto& c : commands.commands)
+        {
+            replay(&painter, commands, c);
+        }
+    });
+
+    std::printf("%9s | %12.1f %12s | %s\n", "single", single_ns / 1000000.0, "1.00", "-");
+
+    std::vector<int> thread_counts = { 1, 2, 4, 8, 16 };
+    if (get_hardware_thread_count() > 16)
+    {
+        thread_counts.push_back(get_hardware_thread_count());
+    }
+
+    for (const int threads : thread_counts)
+    {
+        ThreadPool pool{ threads };
+        TiledRasterizer rasterizer;
+        Image image{ screen.x, screen.y };
+        const auto tiled_ns = measure_ns_per_op(iterations, [&](int) { rasterizer.render(commands, &image, &pool); });
+
+        int mismatches = 0;
+        for (std::size_t i = 0; i < image.pixels.size(); i += 1)
+        {
+            if (image.pixels[i] != expected.pixels[i]) { mismatches += 1; }
+        }
+
+        std::printf("%9d | %12.1f %12.2f | %d\n", threads, tiled_ns / 1000000.0, single_ns / tiled_ns, mismatches);
+    }
+}
+
+// the painters merge the small shapes like the wx painter does, the rasterizer doesn't on its own
+template<typename P>
+struct LodPainter : P
+{
+    using P::P;
+
+    bool wants_lod() const override
+    {
+        return true;
+    }
+};
+
+// primitives issued and raster time at each zoom level, with and without merging sub-pixel shapes
+void bench_lod(int count)
+{
+    // a dense drawing where every shape is smaller than a pixel at the smallest scale
+    std::mt19937 gen(42);
+    const float world_size = std::sqrt(static_cast<float>(count)) * 4.0f;
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(2.0f, 10.0f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+
+    Document document;
+    for (int i = 0; i < count; i += 1)
+    {
+        document.add_rectangle(Rgba{ color(gen), 255 }, Rect{ {position(gen), position(gen)}, {size(gen), size(gen)} });
+    }
+
+    const auto screen = glm::ivec2{ 1920, 1080 };
+    RenderCache cache;
+    Image image{ screen.x, screen.y };
+
+    for (const float scale : {0.1f, 0.2f, 0.3f, 0.5f, 1.0f})
+    {
+        // centered on the world
+        CanvasTransform t;
+        t.scale = scale;
+        t.scroll = glm::vec2{ screen } * 0.5f - glm::vec2{ world_size, world_size } * 0.5f * scale;
+
+        const auto measure = [&](float threshold, int* primitives, int* merged)
+        {
+            Settings settings;
+            settings.lod_pixel_threshold = threshold;
+
+            DrawCommandList commands;
+            LodPainter<RecordingPainter> recorder{ &commands };
+            const auto shape_stats = render_shapes(&recorder, &document, settings, t, screen, &cache);
+            *primitives = recorder.stats.primitives;
+            *merged = shape_stats.lod_merged;
+
+            return measure_ns_per_op(3, [&](int)
+            {
+                LodPainter<RasterPainter> painter{ &image };
+                render_shapes(&painter, &document, settings, t, screen, &cache);
+            });
+        };
+
+        int primitives_off = 0;
+        int primitives_on = 0;
+        int merged_off = 0;
+        int merged_on = 0;
+        const auto off_ns = measure(0.0f, &primitives_off, &merged_off);
+        const auto on_ns = measure(1.0f, &primitives_on, &merged_on);
+
+        std::printf
+        (
+            "%9.2f | %12d %12d %12d | %12.2f %12.2f\n",
+            scale, primitives_off, primitives_on, merged_on, off_ns / 1000000.0, on_ns / 1000000.0
+        );
+    }
+}
+
+// a pan across the canvas with one shape moved halfway through, drawn from scratch every frame and from the tile cache
+void bench_tile_cache(int count, std::size_t budget_bytes)
+{
+    std::mt19937 gen(42);
+    const float world_size = std::sqrt(static_cast<float>(count)) * 40.0f;
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(5.0f, 30.0f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+
+    Document document;
+    std::vector<Id> ids;
+    for (int i = 0; i < count; i += 1)
+    {
+        ids.push_back(document.add_rectangle(Rgba{ color(gen), 255 }, Rect{ {position(gen), position(gen)}, {size(gen), size(gen)} }));
+    }
+
+    const auto screen = glm::ivec2{ 1920, 1080 };
+    const Settings settings;
+    RenderCache render_cache;
+
+    TileCache<Image> cache;
+    cache.budget_bytes = budget_bytes;
+    const auto render_tile = [&](Image* tile, const TileKey& key)
+    {
+        if (tile->width != cache.tile_size || tile->height != cache.tile_size)
+        {
+            *tile = Image{ cache.tile_size, cache.tile_size };
+        }
+        RasterPainter painter{ tile };
+        render_scene(&painter, &document, settings, get_tile_transform(key, cache.tile_size), { cache.tile_size, cache.tile_size }, &render_cache);
+    };
+
+    constexpr int frames = 200;
+    const auto get_view = [&](int frame)
+    {
+        CanvasTransform t;
+        t.scale = 0.25f;
+        t.scroll = { -world_size * 0.125f - static_cast<float>(frame) * 7.3f, -world_size * 0.125f + static_cast<float>(frame) * 2.1f };
+        return get_tiled_transform(t);
+    };
+    const auto edit = [&](int frame)
+    {
+        if (frame != frames / 2) { return; }
+        const auto ref = document.shapes.find(ids[0]);
+        document.shapes.rectangles.rects[ref.slot].topleft += glm::vec2{ 10, 10 };
+        document.on_changed(ids[0]);
+    };
+
+    Image full{ screen.x, screen.y };
+    const auto full_ns = measure_ns_per_op(frames, [&](int frame)
+    {
+        edit(frame);
+        RasterPainter painter{ &full };
+        render_scene(&painter, &document, settings, get_view(frame), screen, &render_cache);
+    });
+
+    // undo the edit so the cached run sees the same document
+    const auto ref = document.shapes.find(ids[0]);
+    document.shapes.rectangles.rects[ref.slot].topleft -= glm::vec2{ 10, 10 };
+    document.on_changed(ids[0]);
+
+    Image tiled{ screen.x, screen.y };
+    const auto tiled_ns = measure_ns_per_op(frames, [&](int frame)
+    {
+        edit(frame);
+        cache.sync(document);
+        for_each_visible_tile(get_view(frame), screen, cache.tile_size, [&](const TileKey& key, const glm::ivec2& p)
+        {
+            blit(&tiled, cache.get(key, render_tile), p.x, p.y);
+        });
+    });
+
+    int mismatches = 0;
+    for (std::size_t i = 0; i < tiled.pixels.size(); i += 1)
+    {
+        if (tiled.pixels[i] != full.pixels[i]) { mismatches += 1; }
+    }
+
+    std::printf
+    (
+        "%9zu | %12.2f %12.2f | %8.1f%% %10zu %10llu | %d\n",
+        budget_bytes / (1024 * 1024), full_ns / 1000000.0, tiled_ns / 1000000.0,
+        cache.stats.get_hit_rate() * 100.0f, cache.get_resident_bytes() / 1024,
+        static_cast<unsigned long long>(cache.stats.evictions), mismatches
+    );
+}
+
+// save, load the mapped file and use it, compared to parsing every shape into a new document
+void bench_document_file(int count)
+{
+    std::mt19937 gen(42);
+    const float world_size = std::sqrt(static_cast<float>(count)) * 40.0f;
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(5.0f, 30.0f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+
+    Document document;
+    for (int i = 0; i < count; i += 1)
+    {
+        document.add_rectangle(Rgba{ color(gen), 255 }, Rect{ {position(gen), position(gen)}, {size(gen), size(gen)} });
+    }
+
+    const std::string path = "vecy_bench.vecy";
+    bool saved = false;
+    const auto save_ns = measure_ns_per_op(1, [&](int) { saved = save_document(document, path); });
+
+    Document loaded;
+    bool is_loaded = false;
+    const auto load_ns = measure_ns_per_op(1, [&](int) { is_loaded = load_document(&loaded, path); });
+    if (saved == false || is_loaded == false)
+    {
+        std::printf("%9d | failed to save or load\n", count);
+        return;
+    }
+
+    // the first frame touches the pages of the visible shapes and the index
+    const auto screen = glm::ivec2{ 1920, 1080 };
+    CanvasTransform t;
+    t.scroll = -glm::vec2{ world_size, world_size } * 0.5f;
+    RenderCache cache;
+    Image image{ screen.x, screen.y };
+    const auto first_frame_ns = measure_ns_per_op(1, [&](int)
+    {
+        RasterPainter painter{ &image };
+        render_shapes(&painter, &loaded, Settings{}, t, screen, &cache);
+    });
+
+    // what loading costs when every shape is parsed into the editable shapes
+    const auto parse_ns = measure_ns_per_op(1, [&](int)
+    {
+        Document parsed;
+        const auto& file = *loaded.base;
+        for (u32 i = 0; i < file.size(); i += 1)
+        {
+            parsed.add_rectangle(file.get_color(i), file.get_rect(i));
+        }
+    });
+
+    // an edit in the loaded document survives a save and a load of the result
+    Image expected{ screen.x, screen.y };
+    {
+        RasterPainter painter{ &expected };
+        render_shapes(&painter, &document, Settings{}, t, screen, &cache);
+    }
+    int mismatches = 0;
+    for (std::size_t i = 0; i < image.pixels.size(); i += 1)
+    {
+        if (image.pixels[i] != expected.pixels[i]) { mismatches += 1; }
+    }
+
+    const auto edited = Id{ static_cast<u64>(count / 2) };
+    loaded.materialize(edited);
+    const auto ref = loaded.shapes.find(edited);
+    loaded.shapes.rectangles.rects[ref.slot].topleft += glm::vec2{ 100, 100 };
+    loaded.on_changed(edited);
+    Document reloaded;
+    if (save_document(loaded, path + "2") == false || load_document(&reloaded, path + "2") == false || reloaded.size() != static_cast<std::size_t>(count) || reloaded.get_bounds(edited)->topleft != loaded.get_bounds(edited)->topleft)
+    {
+        mismatches += 1;
+    }
+    reloaded.set_base(nullptr);
+    loaded.set_base(nullptr);
+    std::remove((path + "2").c_str());
+    std::remove(path.c_str());
+
+    std::printf
+    (
+        "%9d | %10.1f %10.2f | %10.3f %12.2f %10.1f | %d\n",
+        count, save_ns / 1000000.0, static_cast<double>(sizeof(ShapeRecord)) * count / (1024.0 * 1024.0),
+        load_ns / 1000000.0, first_frame_ns / 1000000.0, parse_ns / 1000000.0, mismatches
+    );
+}
+
+// a file like an exported drawing, mostly rects with a few shapes the store can't hold
+bool write_bench_svg(const std::string& path, std::size_t target_bytes, u64* rectangles)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    std::mt19937 gen(42);
+    const float world_size = std::sqrt(static_cast<float>(target_bytes / 80)) * 40.0f;
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(5.0f, 30.0f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+    std::uniform_int_distribution<int> kind(0, 15);
+
+    std::size_t written = std::fprintf(file, "<?xml version=\"1.0\"?>\n<!-- vecy bench -->\n<svg xmlns=\"http://www.w3.org/2000/svg\">\n<g>\n");
+    char line[256];
+    *rectangles = 0;
+    while (written < target_bytes)
+    {
+        int length = 0;
+        switch (kind(gen))
+        {
+        case 0:
+            length = std::snprintf(line, sizeof(line), "<circle cx=\"%.2f\" cy=\"%.2f\" r=\"%.2f\" fill=\"#%06x\"/>\n", position(gen), position(gen), size(gen), color(gen));
+            break;
+        case 1:
+            length = std::snprintf(line, sizeof(line), "<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\" style=\"fill:#%06x;fill-opacity:0.5;stroke:black;stroke-dasharray:4 4\"/>\n", position(gen), position(gen), size(gen), size(gen), color(gen));
+            *rectangles += 1;
+            break;
+        default:
+            length = std::snprintf(line, sizeof(line), "<rect x=\"%.2f\" y=\"%.2f\" width=\"%.2f\" height=\"%.2f\" fill=\"#%06x\"/>\n", position(gen), position(gen), size(gen), size(gen), color(gen));
+            *rectangles += 1;
+            break;
+        }
+        written += std::fwrite(line, 1, static_cast<std::size_t>(length), file);
+    }
+    written += std::fprintf(file, "</g>\n</svg>\n");
+    return std::fclose(file) == 0;
+}
+
+void bench_svg(std::size_t target_bytes)
+{
+    const std::string path = "vecy_bench.svg";
+    u64 expected_rectangles = 0;
+    if (write_bench_svg(path, target_bytes, &expected_rectangles) == false)
+    {
+        std::printf("failed to write %s\n", path.c_str());
+        return;
+    }
+
+    // the parser alone, what it holds doesn't depend on the file size
+    std::size_t parser_peak = 0;
+    u64 parsed = 0;
+    {
+        const auto before = allocation_stats.get_live_bytes();
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        XmlPullParser parser{ file };
+        while (parser.next_element())
+        {
+            if (parser.get_name() == "rect") { parsed += 1; }
+            parser_peak = std::max(parser_peak, allocation_stats.get_live_bytes() - before);
+        }
+        std::fclose(file);
+    }
+
+    Document document;
+    SvgImportStats stats;
+    const auto import_ns = measure_ns_per_op(1, [&](int) { stats = import_svg(&document, path); });
+    const double mib = static_cast<double>(stats.bytes) / (1024.0 * 1024.0);
+
+    // the same shapes inserted one at a time
+    const auto& rectangles = document.shapes.rectangles;
+    SpatialIndex one_by_one;
+    const auto insert_ns = measure_ns_per_op(1, [&](int)
+    {
+        for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+        {
+            one_by_one.insert(rectangles.ids[slot], rectangles.rects[slot]);
+        }
+    });
+    SpatialIndex bulk;
+    const auto bulk_ns = measure_ns_per_op(1, [&](int)
+    {
+        bulk.insert_bulk(rectangles.ids.data(), rectangles.rects.data(), rectangles.size());
+    });
+
+    // queries on both trees, a better tree visits fewer nodes
+    std::mt19937 gen(7);
+    const auto bounds = document.index.get_bounds();
+    std::uniform_real_distribution<float> qx(bounds.topleft.x, bounds.topleft.x + bounds.size.x);
+    std::uniform_real_distribution<float> qy(bounds.topleft.y, bounds.topleft.y + bounds.size.y);
+    std::vector<Rect> queries;
+    for (int i = 0; i < 1000; i += 1)
+    {
+        queries.push_back(Rect{ {qx(gen), qy(gen)}, {200, 200} });
+    }
+    int mismatches = 0;
+    int hits_one = 0;
+    int hits_bulk = 0;
+    const auto query_one_ns = measure_ns_per_op(static_cast<int>(queries.size()), [&](int i) { one_by_one.query_intersecting(queries[i], [&](Id, const Rect&) { hits_one += 1; }); });
+    const auto query_bulk_ns = measure_ns_per_op(static_cast<int>(queries.size()), [&](int i) { bulk.query_intersecting(queries[i], [&](Id, const Rect&) { hits_bulk += 1; }); });
+    if (hits_one != hits_bulk) { mismatches += 1; }
+
+    const std::string export_path = "vecy_bench_export.svg";
+    bool exported = false;
+    const auto export_ns = measure_ns_per_op(1, [&](int) { exported = export_svg(&document, export_path); });
+    std::FILE* export_file = std::fopen(export_path.c_str(), "rb");
+    double export_mib = 0.0;
+    if (export_file != nullptr)
+    {
+        std::fseek(export_file, 0, SEEK_END);
+        export_mib = static_cast<double>(std::ftell(export_file)) / (1024.0 * 1024.0);
+        std::fclose(export_file);
+    }
+
+    // the export reads back to the same shapes in the same order
+    Document round_trip;
+    const auto round_trip_stats = import_svg(&round_trip, export_path);
+    const auto& back = round_trip.shapes.rectangles;
+    if (exported == false || round_trip_stats.ok == false || back.size() != rectangles.size())
+    {
+        mismatches += 1;
+    }
+    else
+    {
+        for (u32 slot = 0; slot < back.size(); slot += 1)
+        {
+            const auto& a = rectangles.colors[slot];
+            const auto& b = back.colors[slot];
+            const bool same
+                =  std::abs(back.rects[slot].topleft.x - rectangles.rects[slot].topleft.x) < 0.01f
+                && std::abs(back.rects[slot].size.y - rectangles.rects[slot].size.y) < 0.01f
+                && a.r == b.r && a.g == b.g && a.b == b.b && std::abs(a.a - b.a) <= 1
+                ;
+            if (same == false) { mismatches += 1; }
+        }
+    }
+    if (stats.ok == false || stats.rectangles != expected_rectangles || parsed != expected_rectangles) { mismatches += 1; }
+    std::remove(export_path.c_str());
+    std::remove(path.c_str());
+
+    std::printf
+    (
+        "%9.1f %10llu | %10.1f %10.1f %10.2f %10.1f | %10.1f %10.1f | %10.2f %10.2f | %10.1f | %d\n",
+        mib, static_cast<unsigned long long>(stats.rectangles),
+        import_ns / 1000000.0, mib / (import_ns / 1e9), stats.rectangles / (import_ns / 1e3), parser_peak / 1024.0,
+        insert_ns / 1000000.0, bulk_ns / 1000000.0,
+        query_one_ns / 1000.0, query_bulk_ns / 1000.0,
+        export_mib / (export_ns / 1e9),
+        mismatches
+    );
+}
+
+Document make_bench_document(int count)
+{
+    std::mt19937 gen(42);
+    const float world_size = std::sqrt(static_cast<float>(count)) * 40.0f;
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(5.0f, 30.0f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+
+    Document document;
+    std::vector<RectangleShape> shapes;
+    shapes.reserve(count);
+    for (int i = 0; i < count; i += 1)
+    {
+        shapes.push_back({ Id{0}, Rgba{ color(gen) }, Rect{ {position(gen), position(gen)}, {size(gen), size(gen)} } });
+    }
+    document.add_rectangles(&shapes);
+    return document;
+}
+
+// the memory of a small edit doesn't depend on the document size
+void bench_history_memory(int count)
+{
+    auto document = make_bench_document(count);
+    std::vector<Id> ids;
+    for (u64 i = 0; i < 100; i += 1)
+    {
+        ids.push_back(Id{ i * static_cast<u64>(count / 100) });
+    }
+
+    History history;
+    history.move(&document, ids, { 10, 10 });
+    const auto move_bytes = history.get_memory_usage();
+    history.set_color(&document, ids, Rgba{ 0xff0000 });
+    const auto restyle_bytes = history.get_memory_usage() - move_bytes;
+    history.remove(&document, ids);
+    const auto remove_bytes = history.get_memory_usage() - move_bytes - restyle_bytes;
+
+    std::printf
+    (
+        "%9d | %10zu %10zu %10zu | %12.1f\n",
+        count, move_bytes, restyle_bytes, remove_bytes,
+        static_cast<double>(document.shapes.get_memory_usage()) / (1024.0 * 1024.0)
+    );
+}
+
+// an edit of count shapes in a document of 1M
+void bench_history_edit(const char* name, int count, const std::function<void(Document*, History*, const std::vector<Id>&)>& edit)
+{
+    auto document = make_bench_document(1000000);
+    std::vector<Id> ids;
+    for (u64 i = 0; i < static_cast<u64>(count); i += 1)
+    {
+        ids.push_back(Id{ i * (1000000 / static_cast<u64>(count)) });
+    }
+
+    // the document as it was, in paint order
+    const auto get_state = [](Document* d)
+    {
+        d->shapes.ensure_z_order();
+        return std::make_pair(d->shapes.rectangles.rects, d->shapes.rectangles.colors);
+    };
+    const auto before = get_state(&document);
+
+    History history;
+    const auto edit_ns = measure_ns_per_op(1, [&](int) { edit(&document, &history, ids); });
+    const auto after = get_state(&document);
+    const auto undo_ns = measure_ns_per_op(1, [&](int) { history.undo(&document); });
+    const auto undone = get_state(&document);
+    const auto redo_ns = measure_ns_per_op(1, [&](int) { history.redo(&document); });
+    const auto redone = get_state(&document);
+
+    const auto is_same = [](const auto& lhs, const auto& rhs)
+    {
+        if (lhs.first.size() != rhs.first.size()) { return false; }
+        for (std::size_t i = 0; i < lhs.first.size(); i += 1)
+        {
+            const auto& a = lhs.second[i];
+            const auto& b = rhs.second[i];
+            if (lhs.first[i].topleft != rhs.first[i].topleft || lhs.first[i].size != rhs.first[i].size || a.r != b.r || a.g != b.g || a.b != b.b || a.a != b.a)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    int mismatches = 0;
+    if (is_same(before, undone) == false) { mismatches += 1; }
+    if (is_same(after, redone) == false) { mismatches += 1; }
+
+    std::printf
+    (
+        "%9s %9d | %10.2f %10.2f %10.2f | %10.1f | %d\n",
+        name, count, edit_ns / 1000000.0, undo_ns / 1000000.0, redo_ns / 1000000.0,
+        static_cast<double>(history.get_memory_usage()) / 1024.0, mismatches
+    );
+}
+
+// a random transform, rect and point for the hit test property check.
+// a third of the points are on the edges of the extended screen rect where the rounding differs
+struct HitCase
+{
+    CanvasTransform t;
+    Rect rect;
+    glm::vec2 point;
+    float extra;
+};
+
+// the cases where the point is within a few float steps of an edge of the rect
+bool is_float_steps_from_edge(int index)
+{
+    return index % 3 == 2 && (index / 3) % 2 == 0;
+}
+
+HitCase make_hit_case(std::mt19937* gen, int index)
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> coord(-100000.0f, 100000.0f);
+    const auto next = [&]() { return unit(*gen); };
+
+    HitCase c;
+    const float min = c.t.scale_range_min;
+    const float max = c.t.scale_range_max;
+    c.t.scale = index % 16 == 0 ? min : index % 16 == 1 ? max : min * std::pow(max / min, next());
+    c.t.scroll = { coord(*gen), coord(*gen) };
+    c.extra = index % 3 == 0 ? 0.0f : index % 3 == 1 ? 10.0f : next() * 20.0f;
+
+    // around the middle of the screen, sometimes empty or huge
+    const auto center = c.t.from_screen_to_world({ next() * 1920.0f, next() * 1080.0f });
+    const float size_scale = index % 7 == 0 ? 0.0f : index % 7 == 1 ? 100000.0f : 500.0f;
+    c.rect = Rect{ center, {next() * size_scale, next() * size_scale} };
+
+    const auto screen = from_world_to_screen(c.t, c.rect).extend(c.extra);
+    switch (index % 3)
+    {
+    case 0:
+        // anywhere on the screen
+        c.point = { next() * 1920.0f, next() * 1080.0f };
+        break;
+    case 1:
+        // near the rect
+        c.point = screen.extend(20.0f).topleft + glm::vec2{ next(), next() } * screen.extend(20.0f).size;
+        break;
+    default:
+    {
+        // on an edge, a few float steps to either side of it, or every other time up to a few pixels
+        // away so the tests are also compared where the world space test starts to answer on its own
+        const bool vertical = next() < 0.5f;
+        const bool low = next() < 0.5f;
+        const auto edge = vertical
+            ? (low ? screen.topleft.x : screen.topleft.x + screen.size.x)
+            : (low ? screen.topleft.y : screen.topleft.y + screen.size.y);
+        const auto along = vertical
+            ? screen.topleft.y + next() * screen.size.y
+            : screen.topleft.x + next() * screen.size.x;
+        const int steps = static_cast<int>(next() * 5.0f) - 2;
+        auto nudged = edge;
+        if (is_float_steps_from_edge(index))
+        {
+            for (int i = 0; i < std::abs(steps); i += 1) { nudged = std::nextafter(nudged, steps < 0 ? -1e30f : 1e30f); }
+        }
+        else
+        {
+            nudged += (steps < 0 ? -1.0f : 1.0f) * std::exp2(-8.0f + next() * 12.0f);
+        }
+        c.point = vertical ? glm::vec2{ nudged, along } : glm::vec2{ along, nudged };
+        break;
+    }
+    }
+    return c;
+}
+
+// the world space hit test against the screen space one it replaced, the results must be
+// the same for every scale in the zoom range
+void bench_world_hit_test(int cases)
+{
+    std::mt19937 gen(11);
+    int mismatches = 0;
+    int hits = 0;
+    for (int index = 0; index < cases; index += 1)
+    {
+        const auto c = make_hit_case(&gen, index);
+        const bool expected = is_rectangle_hit(c.t, c.rect, c.point, c.extra);
+        const bool actual = WorldHitTest{ c.t, c.point, c.extra }.is_rectangle_hit(c.rect);
+        if (expected != actual) { mismatches += 1; }
+        if (expected) { hits += 1; }
+    }
+
+    // one point against many shapes, like a query in a dense area
+    constexpr int count = 1000000;
+    std::vector<Rect> rects;
+    for (int i = 0; i < count; i += 1)
+    {
+        rects.push_back(make_hit_case(&gen, i).rect);
+    }
+    CanvasTransform t;
+    t.scale = 0.37f;
+    t.scroll = { 512.0f, -256.0f };
+    const auto p = glm::vec2{ 960.0f, 540.0f };
+    int found = 0;
+    const auto screen_ns = measure_ns_per_op(1, [&](int)
+    {
+        for (const auto& r : rects) { if (is_rectangle_hit(t, r, p, 10.0f)) { found += 1; } }
+    }) / count;
+    const auto world_ns = measure_ns_per_op(1, [&](int)
+    {
+        const auto hit = WorldHitTest{ t, p, 10.0f };
+        for (const auto& r : rects) { if (hit.is_rectangle_hit(r)) { found -= 1; } }
+    }) / count;
+    if (found != 0) { mismatches += 1; }
+
+    std::printf("%9d %9d | %10.2f %10.2f | %d\n", cases, hits, screen_ns, world_ns, mismatches);
+}
+
+// all hits against the topmost pick on a generated scene
+void bench_topmost_hit(SceneKind kind, int count)
+{
+    Document document;
+    const float world_size = fill_document(&document, SceneSpec{ kind, count });
+
+    CanvasTransform t;
+    t.scale = 0.5f;
+    SceneRandom random{ 5 };
+    constexpr int queries = 1000;
+    std::vector<glm::vec2> points;
+    for (int i = 0; i < queries; i += 1)
+    {
+        points.push_back(t.from_world_to_screen({ random.next(0.0f, world_size), random.next(0.0f, world_size) }));
+    }
+
+    std::size_t found = 0;
+    IdSet set;
+    std::vector<Id> sorted;
+    const auto set_ns = measure_ns_per_op(queries, [&](int i) { document.get_hit(t, points[i], 10.0f, &set); found += set.size(); });
+    const auto sorted_ns = measure_ns_per_op(queries, [&](int i) { document.get_hits(t, points[i], 10.0f, &sorted); found += sorted.size(); });
+    const auto topmost_ns = measure_ns_per_op(queries, [&](int i) { found += document.get_topmost_hit(t, points[i], 10.0f).has_value(); });
+
+    // the sorted hits are the set topmost first, and the pick is the first of them
+    int mismatches = 0;
+    for (const auto& p : points)
+    {
+        document.get_hit(t, p, 10.0f, &set);
+        document.get_hits(t, p, 10.0f, &sorted);
+        const auto topmost = document.get_topmost_hit(t, p, 10.0f);
+        if (sorted.size() != set.size()) { mismatches += 1; continue; }
+        for (std::size_t i = 0; i < sorted.size(); i += 1)
+        {
+            if (set.contains(sorted[i]) == false || (i > 0 && sorted[i - 1].id <= sorted[i].id)) { mismatches += 1; }
+        }
+        if (topmost.has_value() != (sorted.empty() == false) || (topmost && *topmost != sorted[0])) { mismatches += 1; }
+    }
+
+    std::printf
+    (
+        "%11s %9d | %8.1f | %10.2f %10.2f %10.2f | %d\n",
+        to_string(kind), count, static_cast<double>(found) / (queries * 3), set_ns / 1000.0, sorted_ns / 1000.0, topmost_ns / 1000.0, mismatches
+    );
+}
+
+// hover and marquee updates the way the canvas does them on mouse moves, with reused sets
+// against building a new std::unordered_set for each event like the canvas used to
+void bench_selection_events(int count)
+{
+    Document document;
+    const float world_size = fill_document(&document, SceneSpec{ SceneKind::uniform, count });
+
+    // the whole world on the screen, the marquee grows from a corner until it covers everything
+    CanvasTransform t;
+    t.scale = 1080.0f / world_size;
+    constexpr int events = 50;
+    SceneRandom random{ 9 };
+    std::vector<glm::vec2> hover_points;
+    for (int i = 0; i < events; i += 1)
+    {
+        hover_points.push_back({ random.next(0.0f, 1080.0f), random.next(0.0f, 1080.0f) });
+    }
+    const auto get_marquee = [&](int i) { return Rect{ {0.0f, 0.0f}, glm::vec2{ 1080.0f, 1080.0f } * (static_cast<float>(i + 1) / events) }; };
+
+    IdSet hovers;
+    const auto hover = [&](int i)
+    {
+        hovers.clear();
+        if (const auto hit = document.get_topmost_hit(t, hover_points[i], 10.0f)) { hovers.insert(*hit); }
+    };
+    const auto marquee = [&](int i) { document.get_selection(t, get_marquee(i), false, &hovers); };
+
+    std::unordered_set<Id> old_hovers;
+    IdSet scratch;
+    const auto old_hover = [&](int i)
+    {
+        document.get_hit(t, hover_points[i], 10.0f, &scratch);
+        old_hovers = std::unordered_set<Id>(scratch.begin(), scratch.end());
+    };
+    const auto old_marquee = [&](int i)
+    {
+        document.get_selection(t, get_marquee(i), false, &scratch);
+        old_hovers = std::unordered_set<Id>(scratch.begin(), scratch.end());
+    };
+
+    // allocations per event after a first pass has grown the buffers
+    const auto measure = [&](auto&& on_event, double* ns)
+    {
+        for (int i = 0; i < events; i += 1) { on_event(i); }
+        const auto before = allocation_stats.get_allocations();
+        *ns = measure_ns_per_op(events, on_event);
+        return static_cast<double>(allocation_stats.get_allocations() - before) / events;
+    };
+    double hover_ns = 0.0;
+    double marquee_ns = 0.0;
+    double old_hover_ns = 0.0;
+    double old_marquee_ns = 0.0;
+    const auto hover_allocations = measure(hover, &hover_ns);
+    const auto marquee_allocations = measure(marquee, &marquee_ns);
+    const auto old_hover_allocations = measure(old_hover, &old_hover_ns);
+    const auto old_marquee_allocations = measure(old_marquee, &old_marquee_ns);
+
+    // the last marquee covers everything
+    int mismatches = hovers.size() == document.size() ? 0 : 1;
+    hovers.sort();
+    for (std::size_t i = 1; i < hovers.size(); i += 1)
+    {
+        if ((hovers.begin() + i - 1)->id >= (hovers.begin() + i)->id) { mismatches += 1; }
+    }
+
+    std::printf
+    (
+        "%9d | %10.1f %10.1f | %10.1f %10.1f | %10.2f %10.2f | %10.2f %10.2f | %d\n",
+        count, old_hover_allocations, hover_allocations, old_marquee_allocations, marquee_allocations,
+        old_hover_ns / 1000.0, hover_ns / 1000.0, old_marquee_ns / 1000000.0, marquee_ns / 1000000.0, mismatches
+    );
+}
+
+// dragging a large selection, moving the shapes in the document for every mouse event
+// against drawing them with a moved transform and committing the move once on release
+void bench_drag_preview(int count, int selected)
+{
+    Document document;
+    const float world_size = fill_document(&document, SceneSpec{ SceneKind::uniform, count });
+    History history;
+
+    const auto screen = glm::ivec2{ 1920, 1080 };
+    CanvasTransform t;
+    t.scale = screen.y / world_size;
+    const auto area = Rect{ {0, 0}, screen };
+
+    IdSet dragged;
+    const auto& all_ids = document.shapes.rectangles.ids;
+    const auto step = static_cast<std::size_t>(std::max(1, count / selected));
+    for (std::size_t i = 0; i < all_ids.size() && static_cast<int>(dragged.size()) < selected; i += step)
+    {
+        dragged.insert(all_ids[i]);
+    }
+    dragged.sort();
+    const auto ids = std::vector<Id>(dragged.begin(), dragged.end());
+
+    constexpr int events = 20;
+    const auto get_mouse_delta = [](int i) { return glm::vec2{ static_cast<float>(i + 1), static_cast<float>(i + 1) * 0.5f }; };
+
+    Image image{ screen.x, screen.y };
+    RenderCache cache;
+
+    // the static layer is drawn once without the dragged shapes
+    const auto static_ns = measure_ns_per_op(1, [&](int)
+    {
+        RasterPainter painter{ &image };
+        render_scene(&painter, &document, Settings{}, t, screen, &cache, &dragged);
+    });
+
+    const auto measure_preview = [&](const CanvasTransform& view)
+    {
+        return measure_ns_per_op(events, [&](int i)
+        {
+            auto moved = view;
+            moved.scroll += get_mouse_delta(i);
+            RasterPainter painter{ &image };
+            render_shape_set(&painter, document, Settings{}, moved, screen, area, dragged, &cache);
+        });
+    };
+    // all of the world on the screen is the worst case, every shape ends up merged by the lod
+    const auto preview_ns = measure_preview(t);
+    // a quarter of the world across, around the middle
+    CanvasTransform zoomed;
+    zoomed.scale = t.scale * 4.0f;
+    zoomed.scroll = glm::vec2{ screen } * 0.5f - glm::vec2{ world_size, world_size } * 0.5f * zoomed.scale;
+    const auto zoomed_ns = measure_preview(zoomed);
+
+    // the screen positions the preview ended with
+    std::vector<Rect> before;
+    for (const auto id : ids)
+    {
+        before.push_back(*document.get_bounds(id));
+    }
+    auto preview_t = t;
+    preview_t.scroll += get_mouse_delta(events - 1);
+
+    const auto delta = get_mouse_delta(events - 1) / t.scale;
+    const auto commit_ns = measure_ns_per_op(1, [&](int) { history.move(&document, ids, delta); });
+
+    int mismatches = 0;
+    for (std::size_t i = 0; i < ids.size(); i += 1)
+    {
+        const auto after = *document.get_bounds(ids[i]);
+        auto expected = before[i];
+        expected.topleft += delta;
+        if (after.topleft != expected.topleft || after.size != expected.size) { mismatches += 1; continue; }
+
+        const auto previewed = from_world_to_screen(preview_t, before[i]);
+        const auto committed = from_world_to_screen(t, after);
+        const auto error = previewed.topleft - committed.topleft;
+        if (std::abs(error.x) > 0.01f || std::abs(error.y) > 0.01f) { mismatches += 1; }
+    }
+    history.undo(&document);
+
+    // the old way, the shapes are moved for every event and the whole frame is drawn again
+    const auto moved_ns = measure_ns_per_op(events, [&](int)
+    {
+        history.move(&document, ids, delta / static_cast<float>(events), true);
+        RasterPainter painter{ &image };
+        render_scene(&painter, &document, Settings{}, t, screen, &cache);
+    });
+
+    std::printf
+    (
+        "%9d %9d | %10.2f %10.2f %10.2f | %10.2f %10.2f | %d\n",
+        count, static_cast<int>(dragged.size()), moved_ns / 1000000.0, preview_ns / 1000000.0, zoomed_ns / 1000000.0,
+        static_ns / 1000000.0, commit_ns / 1000000.0, mismatches
+    );
+}
+
+// heap allocations for building, saving and loading a document, and for frames and queries
+// once the scratch memory has grown to fit
+void bench_allocations(int count)
+{
+    auto scene = generate_scene(SceneSpec{ SceneKind::uniform, count });
+    const auto count_allocations = [](auto&& f)
+    {
+        const auto before = allocation_stats.get_allocations();
+        f();
+        return allocation_stats.get_allocations() - before;
+    };
+
+    Document document;
+    const auto build = count_allocations([&]() { document.add_rectangles(&scene.shapes); });
+
+    const std::string path = "vecy_bench_allocations.vecy";
+    const auto save = count_allocations([&]() { save_document(document, path); });
+    Document loaded;
+    const auto load = count_allocations([&]() { load_document(&loaded, path); });
+
+    const auto screen = glm::ivec2{ 1920, 1080 };
+    CanvasTransform t;
+    t.scale = screen.y / scene.world_size;
+    Image image{ screen.x, screen.y };
+    RenderCache cache;
+    IdSet selection;
+    loaded.get_selection(t, Rect{ {0, 0}, screen }, true, &selection);
+    std::vector<Id> hits;
+
+    // the first pass grows the scratch memory, the second should not allocate
+    std::size_t steady = 0;
+    std::size_t frame = 0;
+    std::size_t queries = 0;
+    for (int pass = 0; pass < 2; pass += 1)
+    {
+        frame = count_allocations([&]()
+        {
+            RasterPainter painter{ &image };
+            render_scene(&painter, &loaded, Settings{}, t, screen, &cache);
+            render_handles(&painter, loaded, Settings{}, t, screen, selection, {}, &cache);
+        });
+        queries = count_allocations([&]()
+        {
+            loaded.get_selection(t, Rect{ {100, 100}, {300, 300} }, false, &selection);
+            loaded.get_hits(t, { 500, 500 }, 10.0f, &hits);
+            (void)loaded.get_topmost_hit(t, { 500, 500 }, 10.0f);
+        });
+        steady = frame + queries;
+    }
+    const auto scratch = cache.get_stats();
+    loaded.set_base(nullptr);
+    std::remove(path.c_str());
+
+    std::printf
+    (
+        "%9d | %10zu %10zu %10zu | %10zu %10zu | %10zu %10zu | %zu\n",
+        count, build, save, load, frame, queries, scratch.reserved_bytes / 1024, scratch.live_bytes / 1024, steady
+    );
+}
+
+// a closed blob of cubics, a closed star of lines or an open wave of quads, about size across
+PathShape make_bench_path(std::mt19937* gen, const glm::vec2& center, float size)
+{
+    std::uniform_real_distribution<float> jitter(0.6f, 1.0f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+    std::uniform_int_distribution<int> kind(0, 2);
+
+    constexpr float pi = 3.14159265358979323846f;
+    const float radius = size * 0.5f;
+    const auto on_circle = [&](float angle, float r) { return center + glm::vec2{ std::cos(angle), std::sin(angle) } * r; };
+
+    PathShape shape{ Id{0}, {}, std::nullopt, std::nullopt };
+    auto& g = shape.geometry;
+    switch (kind(*gen))
+    {
+    case 0:
+    {
+        constexpr int sides = 4;
+        g.move_to(on_circle(0.0f, radius * jitter(*gen)));
+        for (int i = 0; i < sides; i += 1)
+        {
+            const float a0 = 2.0f * pi * static_cast<float>(i) / sides;
+            const float a1 = 2.0f * pi * static_cast<float>(i + 1) / sides;
+            const float bulge = radius * 1.3f * jitter(*gen);
+            g.cubic_to(on_circle(a0 + 0.5f, bulge), on_circle(a1 - 0.5f, bulge), i + 1 == sides ? g.points[0] : on_circle(a1, radius * jitter(*gen)));
+        }
+        g.close();
+        shape.fill = Fill{ Rgba{ color(*gen) }, FillStyle::solid };
+        break;
+    }
+    case 1:
+    {
+        constexpr int points = 5;
+        for (int i = 0; i < points * 2; i += 1)
+        {
+            const auto p = on_circle(pi * static_cast<float>(i) / points, i % 2 == 0 ? radius : radius * 0.4f * jitter(*gen));
+            if (i == 0) { g.move_to(p); }
+            else { g.line_to(p); }
+        }
+        g.close();
+        shape.fill = Fill{ Rgba{ color(*gen), 192 }, FillStyle::solid };
+        shape.outline = Outline{ Rgba{ color(*gen) }, 1, LineStyle::solid };
+        break;
+    }
+    default:
+    {
+        constexpr int waves = 3;
+        const float step = size / waves;
+        auto p = center - glm::vec2{ radius, 0.0f };
+        g.move_to(p);
+        for (int i = 0; i < waves; i += 1)
+        {
+            const float up = i % 2 == 0 ? -radius : radius;
+            g.quad_to(p + glm::vec2{ step * 0.5f, up * jitter(*gen) }, p + glm::vec2{ step, 0.0f });
+            p += glm::vec2{ step, 0.0f };
+        }
+        shape.outline = Outline{ Rgba{ color(*gen) }, 2, LineStyle::solid };
+        break;
+    }
+    }
+    return shape;
+}
+
+// the furthest a point on the curves is from the flattened path, sampled along every curve
+float get_max_flatten_error(const PathGeometry& path, const FlattenedPath& flattened)
+{
+    const auto get_distance = [&](const glm::vec2& p)
+    {
+        float best = std::numeric_limits<float>::max();
+        const auto view = flattened.get_view();
+        for (std::size_t contour = 0; contour < view.contour_count; contour += 1)
+        {
+            for (u32 i = view.get_start(contour); i + 1 < view.contours[contour].end; i += 1)
+            {
+                const auto a = view.points[i];
+                const auto ab = view.points[i + 1] - a;
+                const float length = ab.x * ab.x + ab.y * ab.y;
+                const float t = length > 0.0f ? std::clamp(((p.x - a.x) * ab.x + (p.y - a.y) * ab.y) / length, 0.0f, 1.0f) : 0.0f;
+                const auto d = p - (a + ab * t);
+                best = std::min(best, std::sqrt(d.x * d.x + d.y * d.y));
+            }
+        }
+        return best;
+    };
+
+    constexpr int samples = 32;
+    float error = 0.0f;
+    glm::vec2 current = { 0, 0 };
+    std::size_t next = 0;
+    for (const auto verb : path.verbs)
+    {
+        const auto* p = path.points.data() + next;
+        for (int i = 1; i < samples && (verb == PathVerb::quad || verb == PathVerb::cubic); i += 1)
+        {
+            const float t = static_cast<float>(i) / samples;
+            const float u = 1.0f - t;
+            const auto point = verb == PathVerb::quad
+                ? u * u * current + 2.0f * u * t * p[0] + t * t * p[1]
+                : u * u * u * current + 3.0f * u * u * t * p[0] + 3.0f * u * t * t * p[1] + t * t * t * p[2];
+            error = std::max(error, get_distance(point));
+        }
+        switch (verb)
+        {
+        case PathVerb::move: case PathVerb::line: current = p[0]; next += 1; break;
+        case PathVerb::quad: current = p[1]; next += 2; break;
+        case PathVerb::cubic: current = p[2]; next += 3; break;
+        case PathVerb::close: break;
+        }
+    }
+    return error;
+}
+
+// zooming in on paths, flattening once per zoom level against flattening every frame
+void bench_path_zoom(int count)
+{
+    std::mt19937 gen(42);
+    const float world_size = std::sqrt(static_cast<float>(count)) * 40.0f;
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(10.0f, 60.0f);
+    std::vector<PathShape> shapes;
+    shapes.reserve(count);
+    for (int i = 0; i < count; i += 1)
+    {
+        shapes.push_back(make_bench_path(&gen, { position(gen), position(gen) }, size(gen)));
+    }
+    Document document;
+    document.add_paths(&shapes);
+    const auto& paths = document.shapes.paths;
+
+    // from all of the world on the screen to a few paths across, about 7 zoom levels
+    const auto screen = glm::ivec2{ 1920, 1080 };
+    constexpr int frames = 240;
+    const float fit_scale = screen.y / world_size;
+    const auto get_view = [&](int frame)
+    {
+        CanvasTransform t;
+        t.scale = fit_scale * std::pow(1.02f, static_cast<float>(frame));
+        t.scroll = glm::vec2{ screen } * 0.5f - glm::vec2{ world_size, world_size } * 0.5f * t.scale;
+        return t;
+    };
+
+    Image image{ screen.x, screen.y };
+    RenderCache cache;
+    const auto render_zoom = [&](bool keep_cache)
+    {
+        const auto flattened_before = paths.flatten_count;
+        const auto ns = measure_ns_per_op(frames, [&](int frame)
+        {
+            if (keep_cache == false)
+            {
+                for (auto& f : paths.flattenings) { f.level = no_flatten_level; }
+            }
+            RasterPainter painter{ &image };
+            render_scene(&painter, &document, Settings{}, get_view(frame), screen, &cache);
+        });
+        return std::make_pair(ns, paths.flatten_count - flattened_before);
+    };
+    const auto [uncached_ns, uncached_flattens] = render_zoom(false);
+    for (auto& f : paths.flattenings) { f.level = no_flatten_level; }
+    const auto [cached_ns, cached_flattens] = render_zoom(true);
+
+    int levels = 0;
+    for (int frame = 1; frame < frames; frame += 1)
+    {
+        if (get_flatten_level(get_view(frame).scale) != get_flatten_level(get_view(frame - 1).scale)) { levels += 1; }
+    }
+
+    int mismatches = 0;
+
+    // zooming within the level flattens nothing again
+    {
+        auto t = get_view(frames - 1);
+        const auto before = paths.flatten_count;
+        for (const float zoom : {1.0f, 1.001f, 0.999f})
+        {
+            auto z = t;
+            z.scale = t.scale * zoom;
+            if (get_flatten_level(z.scale) != get_flatten_level(t.scale)) { continue; }
+            RasterPainter painter{ &image };
+            render_scene(&painter, &document, Settings{}, z, screen, &cache);
+        }
+        if (paths.flatten_count != before) { mismatches += 1; }
+    }
+
+    // every level is within its tolerance of the curves, and the rounding of the coordinates
+    constexpr u32 checked_paths = 200;
+    for (int level = -4; level <= 4; level += 1)
+    {
+        const auto tolerance = get_flatten_tolerance(level);
+        for (u32 slot = 0; slot < checked_paths && slot < paths.size(); slot += 1)
+        {
+            FlattenedPath flattened;
+            flatten_path(paths.geometries[slot], tolerance, &flattened);
+            const auto far = paths.bounds[slot].get_bottomright();
+            const float rounding = 4.0f * std::numeric_limits<float>::epsilon() * std::max(std::abs(far.x), std::abs(far.y));
+            if (get_max_flatten_error(paths.geometries[slot], flattened) > tolerance + rounding) { mismatches += 1; }
+        }
+    }
+
+    // hits on the cached flattening agree with a much finer one, away from the edges
+    {
+        auto t = get_view(frames / 2);
+        const auto world_tolerance = get_flatten_tolerance(get_flatten_level(t.scale));
+        std::uniform_int_distribution<u32> pick(0, static_cast<u32>(paths.size() - 1));
+        std::uniform_real_distribution<float> unit(-0.1f, 1.1f);
+        IdSet hits;
+        FlattenedPath fine;
+        for (int i = 0; i < 2000; i += 1)
+        {
+            const auto slot = pick(gen);
+            const auto& b = paths.bounds[slot];
+            const auto world = b.topleft + b.size * glm::vec2{ unit(gen), unit(gen) };
+            flatten_path(paths.geometries[slot], world_tolerance * 0.01f, &fine);
+
+            const auto& outline = paths.outlines[slot];
+            const float half_width = outline ? static_cast<float>(outline->width) * 0.5f : 0.0f;
+            const auto view = fine.get_view();
+            const bool near_edge = is_near_path_outline(view, world, half_width + world_tolerance * 2.0f)
+                && is_near_path_outline(view, world, std::max(0.0f, half_width - world_tolerance * 2.0f)) == false;
+            if (near_edge)
+            {
+                continue;
+            }
+            const bool expected = (paths.fills[slot] && is_inside_path(view, world)) || is_near_path_outline(view, world, half_width);
+
+            document.get_hit(t, t.from_world_to_screen(world), 0.0f, &hits);
+            if (hits.contains(paths.ids[slot]) != expected) { mismatches += 1; }
+        }
+    }
+
+    // the paths survive a save and load
+    {
+        const std::string path = "vecy_bench_paths.vecy";
+        Document loaded;
+        if (save_document(document, path) == false || load_document(&loaded, path) == false || loaded.shapes.paths.size() != paths.size())
+        {
+            mismatches += 1;
+        }
+        else
+        {
+            for (u32 slot = 0; slot < paths.size(); slot += 1)
+            {
+                const auto ref = loaded.shapes.find(paths.ids[slot]);
+                if (ref.kind != ShapeKind::path || loaded.shapes.paths.geometries[ref.slot].points != paths.geometries[slot].points) { mismatches += 1; }
+            }
+        }
+        loaded.set_base(nullptr);
+        std::remove(path.c_str());
+    }
+
+    std::printf
+    (
+        "%9d %9d %9d | %10.2f %10.2f | %10zu %10zu | %d\n",
+        count, frames, levels, uncached_ns / 1000000.0, cached_ns / 1000000.0, uncached_flattens, cached_flattens, mismatches
+    );
+}
+
+// a component with pins on both sides, a notch and a trace, like the symbols drawings repeat
+Symbol make_bench_symbol()
+{
+    Symbol symbol;
+    symbol.add_rectangle(open_color::gray_7, Rect{ {0, 0}, {20, 28} });
+    for (int pin = 0; pin < 6; pin += 1)
+    {
+        const float y = 2.0f + static_cast<float>(pin) * 4.5f;
+        symbol.add_rectangle(open_color::yellow_6, Rect{ {-4, y}, {4, 1.5f} });
+        symbol.add_rectangle(open_color::yellow_6, Rect{ {20, y}, {4, 1.5f} });
+    }
+
+    PathGeometry notch;
+    notch.move_to({ 7, 0 });
+    notch.quad_to({ 10, 5 }, { 13, 0 });
+    notch.close();
+    symbol.add_path(std::move(notch), Fill{ open_color::gray_4, FillStyle::solid }, std::nullopt);
+
+    symbol.add_rectangle(open_color::gray_2, Rect{ {4, 20}, {12, 3} });
+
+    PathGeometry trace;
+    trace.move_to({ 3, 8 });
+    trace.cubic_to({ 8, 2 }, { 12, 18 }, { 17, 12 });
+    symbol.add_path(std::move(trace), std::nullopt, Outline{ open_color::teal_5, 2, LineStyle::solid });
+    return symbol;
+}
+
+// the shapes of the instance added to the document on their own, what a document without symbols would have.
+// owners gets the instance of every added shape by id
+void add_expanded_instance(Document* document, const Symbol& symbol, const InstanceShape& instance, u32 owner, std::vector<u32>* owners)
+{
+    const auto& rectangles = symbol.rectangles;
+    const auto& paths = symbol.paths;
+    std::vector<RectangleShape> new_rectangles;
+    std::vector<PathShape> new_paths;
+    u32 next_path = 0;
+    const auto add_path = [&]()
+    {
+        auto shape = paths.get(next_path);
+        shape.id = document->ids.create();
+        for (auto& p : shape.geometry.points)
+        {
+            p = instance.offset + p * instance.scale;
+        }
+        if (shape.fill) { shape.fill->color = instance.color.value_or(shape.fill->color); }
+        if (shape.outline)
+        {
+            shape.outline->color = instance.color.value_or(shape.outline->color);
+            shape.outline->width = static_cast<int>(std::lround(static_cast<float>(shape.outline->width) * instance.scale));
+        }
+        new_paths.push_back(std::move(shape));
+        next_path += 1;
+    };
+    for (u32 slot = 0; slot < rectangles.size(); slot += 1)
+    {
+        while (next_path < paths.size() && paths.ids[next_path].id < rectangles.ids[slot].id) { add_path(); }
+        const auto& r = rectangles.rects[slot];
+        new_rectangles.push_back({ document->ids.create(), instance.color.value_or(rectangles.colors[slot]), Rect{ instance.offset + r.topleft * instance.scale, r.size * instance.scale } });
+    }
+    while (next_path < paths.size()) { add_path(); }
+
+    owners->resize(document->ids.next, owner);
+    document->restore_rectangles(new_rectangles);
+    document->restore_paths(new_paths);
+}
+
+// a drawing of one symbol placed many times, as instances against every shape on its own
+void bench_instances(int count)
+{
+    std::mt19937 gen(42);
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+    constexpr float spacing = 40.0f;
+    const float world_size = static_cast<float>(columns) * spacing;
+    std::uniform_int_distribution<int> pick_scale(0, 9);
+    std::uniform_int_distribution<int> pick_color(0, 9);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+
+    // mostly the same size, a few larger or smaller and a few recolored
+    std::vector<InstanceShape> placed;
+    placed.reserve(count);
+    for (int i = 0; i < count; i += 1)
+    {
+        const auto offset = glm::vec2{ static_cast<float>(i % columns), static_cast<float>(i / columns) } * spacing;
+        const int s = pick_scale(gen);
+        const float scale = s == 0 ? 0.5f : s == 1 ? 2.0f : 1.0f;
+        const auto recolor = pick_color(gen) == 0 ? std::optional<Rgba>{ Rgba{ color(gen) } } : std::nullopt;
+        placed.push_back({ Id{0}, 0, offset, scale, recolor });
+    }
+
+    const auto symbol = make_bench_symbol();
+    const auto build_instanced = [&]()
+    {
+        Document document;
+        document.shapes.add_symbol(symbol);
+        auto instances = placed;
+        document.add_instances(&instances);
+        return document;
+    };
+    std::vector<u32> owners;
+    const auto build_expanded = [&]()
+    {
+        Document document;
+        for (u32 i = 0; i < placed.size(); i += 1)
+        {
+            add_expanded_instance(&document, symbol, placed[i], i, &owners);
+        }
+        return document;
+    };
+
+    // the heap used by the shapes, the symbols and the spatial index
+    auto before = allocation_stats.get_live_bytes();
+    auto instanced = build_instanced();
+    const auto instanced_bytes = allocation_stats.get_live_bytes() - before;
+    before = allocation_stats.get_live_bytes();
+    auto expanded = build_expanded();
+    const auto expanded_bytes = allocation_stats.get_live_bytes() - before;
+
+    // from all of the drawing on the screen to a few symbols across
+    const auto screen = glm::ivec2{ 1920, 1080 };
+    constexpr int frames = 120;
+    const float fit_scale = screen.y / world_size;
+    const auto get_view = [&](int frame)
+    {
+        CanvasTransform t;
+        t.scale = fit_scale * std::pow(1.04f, static_cast<float>(frame));
+        t.scroll = glm::vec2{ screen } * 0.5f - glm::vec2{ world_size, world_size } * 0.5f * t.scale;
+        return t;
+    };
+
+    Image image{ screen.x, screen.y };
+    RenderCache instanced_cache;
+    RenderCache expanded_cache;
+    const auto render_zoom = [&](Document* document, RenderCache* cache)
+    {
+        return measure_ns_per_op(frames, [&](int frame)
+        {
+            RasterPainter painter{ &image };
+            render_scene(&painter, document, Settings{}, get_view(frame), screen, cache);
+        });
+    };
+    const auto expanded_ns = render_zoom(&expanded, &expanded_cache);
+    const auto records_before = instanced_cache.symbol_record_count;
+    const auto instanced_ns = render_zoom(&instanced, &instanced_cache);
+    const auto records = instanced_cache.symbol_record_count - records_before;
+
+    int mismatches = 0;
+
+    // without merging small shapes both draw the same pixels, up to how the coordinates round
+    Settings exact;
+    exact.lod_pixel_threshold = 0.0f;
+    Image expected{ screen.x, screen.y };
+    std::size_t differing = 0;
+    // a view where the edges land exactly between pixels rounds differently, these don't
+    for (const float zoom : {1.731f, 5.287f})
+    {
+        auto t = get_view(0);
+        t.scale = zoom;
+        t.scroll = glm::vec2{ 0.37f, 0.13f } - glm::vec2{ world_size * 0.3f, world_size * 0.3f } * zoom;
+        {
+            RasterPainter painter{ &expected };
+            render_scene(&painter, &expanded, exact, t, screen, &expanded_cache);
+        }
+        {
+            RasterPainter painter{ &image };
+            render_scene(&painter, &instanced, exact, t, screen, &instanced_cache);
+        }
+        for (std::size_t i = 0; i < image.pixels.size(); i += 1)
+        {
+            if (image.pixels[i] != expected.pixels[i]) { differing += 1; }
+        }
+
+        // zooming within the level draws the recordings again without recording
+        const auto recorded = instanced_cache.symbol_record_count;
+        for (const float z : {1.0001f, 0.9999f})
+        {
+            auto nudged = t;
+            nudged.scale = t.scale * z;
+            if (get_flatten_level(nudged.scale) != get_flatten_level(t.scale)) { continue; }
+            RasterPainter painter{ &image };
+            render_scene(&painter, &instanced, exact, nudged, screen, &instanced_cache);
+        }
+        if (instanced_cache.symbol_record_count != recorded) { mismatches += 1; }
+    }
+    if (differing * 1000 > image.pixels.size()) { mismatches += 1; }
+
+    // an instance is hit where the shapes of its symbol on their own would be
+    {
+        auto t = get_view(0);
+        t.scale = 3.1f;
+        std::uniform_real_distribution<float> world(0.0f, world_size);
+        for (int i = 0; i < 20000; i += 1)
+        {
+            const auto p = t.from_world_to_screen({ world(gen), world(gen) });
+            const auto hit = instanced.get_topmost_hit(t, p, 2.0f);
+            const auto expected_hit = expanded.get_topmost_hit(t, p, 2.0f);
+            // the instances were the first shapes added so their ids are their order
+            if (hit.has_value() != expected_hit.has_value() || (hit && hit->id != owners[expected_hit->id])) { mismatches += 1; }
+        }
+    }
+
+    // undo gives back a removed instance and the color of the symbol to a recolored one
+    {
+        History history;
+        std::vector<Id> ids;
+        for (u32 slot = 0; slot < 100; slot += 1)
+        {
+            ids.push_back(instanced.shapes.instances.ids[slot]);
+        }
+        const auto before_colors = std::vector<std::optional<Rgba>>(instanced.shapes.instances.colors.begin(), instanced.shapes.instances.colors.begin() + 100);
+        history.set_color(&instanced, ids, Rgba{ 0xff0000 });
+        history.remove(&instanced, ids);
+        history.undo(&instanced);
+        history.undo(&instanced);
+        for (u32 i = 0; i < ids.size(); i += 1)
+        {
+            const auto ref = instanced.shapes.find(ids[i]);
+            const auto& colors = instanced.shapes.instances.colors;
+            const bool same_color = ref.kind == ShapeKind::instance && colors[ref.slot].has_value() == before_colors[i].has_value()
+                && (colors[ref.slot].has_value() == false || get_state_key(*colors[ref.slot]) == get_state_key(*before_colors[i]));
+            if (same_color == false) { mismatches += 1; }
+        }
+    }
+
+    // the symbols and instances survive a save and load, and draw the same
+    {
+        const std::string path = "vecy_bench_instances.vecy";
+        Document loaded;
+        if (save_document(instanced, path) == false || load_document(&loaded, path) == false || loaded.shapes.instances.size() != instanced.shapes.instances.size() || loaded.shapes.symbols.size() != 1)
+        {
+            mismatches += 1;
+        }
+        else
+        {
+            auto t = get_view(frames / 2);
+            RenderCache loaded_cache;
+            {
+                RasterPainter painter{ &expected };
+                render_scene(&painter, &instanced, Settings{}, t, screen, &instanced_cache);
+            }
+            {
+                RasterPainter painter{ &image };
+                render_scene(&painter, &loaded, Settings{}, t, screen, &loaded_cache);
+            }
+            if (image.pixels != expected.pixels) { mismatches += 1; }
+        }
+        loaded.set_base(nullptr);
+        std::remove(path.c_str());
+    }
+
+    const auto mib = [](std::size_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+    std::printf
+    (
+        "%9d %9zu | %10.1f %10.1f | %10.2f %10.2f | %10zu %10zu | %d\n",
+        count, expanded.shapes.size(), mib(instanced_bytes), mib(expanded_bytes), instanced_ns / 1000000.0, expanded_ns / 1000000.0, records, differing, mismatches
+    );
+}
+
+#if defined(VECY_PROFILER)
+// the cost of a zone and that zones written from many threads at once read back whole
+void bench_profiler(int count)
+{
+    const auto scope_ns = measure_ns_per_op(count, [](int) { VECY_PROFILE_SCOPE("bench zone"); });
+
+    ThreadPool pool{ get_hardware_thread_count() };
+    const int per_thread = count / pool.get_thread_count();
+    const auto threaded_ns = measure_ns_per_op(1, [&](int)
+    {
+        pool.parallel_for(pool.get_thread_count(), [&](int)
+        {
+            for (int i = 0; i < per_thread; i += 1)
+            {
+                const auto now = get_profile_time_ns();
+                record_profile_zone("bench thread", now, now + 1);
+            }
+        });
+    }) / (static_cast<double>(per_thread) * pool.get_thread_count());
+
+    Timer report_timer;
+    const auto zones = get_profile_zones();
+    const auto report_ms = report_timer.get_elapsed_ns() / 1000000.0;
+
+    int mismatches = 0;
+    for (const auto& zone : zones)
+    {
+        const bool is_bench = std::strcmp(zone.name, "bench zone") == 0 || std::strcmp(zone.name, "bench thread") == 0;
+        if (is_bench == false || zone.end_ns < zone.start_ns) { mismatches += 1; }
+    }
+    if (zones.size() != profile_ring_size) { mismatches += 1; }
+
+    std::printf("%9d | %10.1f %10.1f | %10.3f | %d\n", count, scope_ns, threaded_ns, report_ms, mismatches);
+}
+#endif
+
+// the correctness checks below fail the --check run instead of only printing a mismatch count,
+// each one returns the number of failures and is a test of its own in ctest
+struct Check
+{
+    const char* name;
+    std::function<int()> run;
+};
+
+u64 hash_scene(const GeneratedScene& scene)
+{
+    // fnv-1a over the bits of every shape
+    u64 hash = 14695981039346656037ull;
+    const auto add = [&](const void* data, std::size_t size)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; i += 1)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    for (const auto& shape : scene.shapes)
+    {
+        add(&shape.rect.topleft.x, sizeof(float));
+        add(&shape.rect.topleft.y, sizeof(float));
+        add(&shape.rect.size.x, sizeof(float));
+        add(&shape.rect.size.y, sizeof(float));
+        const u8 color[] = { shape.color.r, shape.color.g, shape.color.b, shape.color.a };
+        add(color, sizeof(color));
+    }
+    return hash;
+}
+
+// the scenes are the same on every run and platform, and the suite results survive the json round trip
+int check_scenes()
+{
+    int failures = 0;
+
+    // the hashes of the scenes when the generator was written, a change here invalidates every saved baseline
+    const std::pair<SceneKind, u64> expected[] =
+    {
+        { SceneKind::uniform, 0xeee8658106e390f8ull },
+        { SceneKind::clustered, 0x27c1600b3492789aull },
+        { SceneKind::overlapping, 0x80baf54b156f54b0ull },
+    };
+    for (const auto& [kind, expected_hash] : expected)
+    {
+        const auto spec = SceneSpec{ kind, 5000, 42 };
+        const auto scene = generate_scene(spec);
+        if (scene.shapes.size() != static_cast<std::size_t>(spec.count)) { failures += 1; }
+        for (const auto& shape : scene.shapes)
+        {
+            if (Rect{ {0, 0}, {scene.world_size, scene.world_size} }.contains(shape.rect) == false) { failures += 1; }
+        }
+        const auto hash = hash_scene(scene);
+        if (hash != hash_scene(generate_scene(spec))) { failures += 1; }
+        if (hash != expected_hash)
+        {
+            std::printf("%s scene hash is %llx\n", to_string(kind), static_cast<unsigned long long>(hash));
+            failures += 1;
+        }
+    }
+
+    const std::string path = "vecy_check_results.json";
+    const std::vector<BenchResult> results =
+    {
+        { "hit", "uniform", 10000, 123.25, "ns" },
+        { "frame", "clustered", 1000000, 0.5, "ms" },
+    };
+    if (write_results_json(results, path) == false) { failures += 1; }
+    const auto read = read_results_json(path);
+    std::remove(path.c_str());
+    if (read.size() != results.size()) { failures += 1; }
+    for (std::size_t i = 0; i < std::min(read.size(), results.size()); i += 1)
+    {
+        const auto& r = read[i];
+        const auto& e = results[i];
+        if (r.name != e.name || r.scene != e.scene || r.shapes != e.shapes || r.value != e.value || r.unit != e.unit) { failures += 1; }
+    }
+
+    return failures;
+}
+
+// every span kernel the cpu has, on random rows and on whole frames, to the bit against the scalar kernels
+int check_span_kernel_frames()
+{
+    Document document;
+    const float world_size = fill_document(&document, SceneSpec{ SceneKind::overlapping, 3000, 3 });
+    add_example_shapes(&document);
+    auto& colors = document.shapes.rectangles.colors;
+    for (std::size_t i = 0; i < colors.size(); i += 2)
+    {
+        colors[i].a = static_cast<u8>(i * 37);
+    }
+
+    const auto size = glm::ivec2{ 640, 480 };
+    CanvasTransform t;
+    t.scale = static_cast<float>(size.y) / world_size;
+    IdSet selection;
+    for (std::size_t i = 0; i < colors.size(); i += 50)
+    {
+        selection.insert(document.shapes.rectangles.ids[i]);
+    }
+
+    const auto render = [&](const SpanKernels& kernels)
+    {
+        Image image{ size.x, size.y };
+        RasterPainter painter{ &image };
+        painter.kernels = &kernels;
+        render_frame(&painter, &document, t, size, selection);
+        return image;
+    };
+
+    int failures = 0;
+    const auto expected = render(get_scalar_kernels());
+    for (const auto* kernels : get_supported_kernels())
+    {
+        int mismatches = check_span_kernels(*kernels);
+        const auto actual = render(*kernels);
+        for (std::size_t i = 0; i < expected.pixels.size(); i += 1)
+        {
+            if (expected.pixels[i] != actual.pixels[i]) { mismatches += 1; }
+        }
+        std::printf("%s kernels: %d mismatches\n", kernels->name, mismatches);
+        failures += mismatches;
+    }
+    return failures;
+}
+
+int check_all_transform_kernels()
+{
+    int failures = 0;
+    for (const auto* kernels : get_supported_transform_kernels())
+    {
+        const int mismatches = check_transform_kernels(*kernels);
+        std::printf("%s kernels: %d mismatches\n", kernels->name, mismatches);
+        failures += mismatches;
+    }
+    return failures;
+}
+
+// the history stays under its budget however many edits are made, what it reports is what it holds on the heap,
+// and a small edit costs the same in a small and a large document
+int check_history_memory()
+{
+    int failures = 0;
+
+    constexpr std::size_t edit_size = 100;
+    std::size_t small_edit_bytes = 0;
+    for (const int count : {10000, 200000})
+    {
+        auto document = make_bench_document(count);
+        std::vector<Id> ids;
+        for (u64 i = 0; i < edit_size; i += 1)
+        {
+            ids.push_back(Id{ i * static_cast<u64>(count / edit_size) });
+        }
+        History history;
+        history.move(&document, ids, { 10, 10 });
+        history.set_color(&document, ids, Rgba{ 0xff0000 });
+        history.remove(&document, ids);
+        const auto bytes = history.get_memory_usage();
+
+        // the ids, the rects and the colors of the removed shapes, with room for the vectors and the commands
+        if (bytes > edit_size * 128 + 3 * sizeof(Command)) { failures += 1; }
+        if (small_edit_bytes != 0 && bytes != small_edit_bytes) { failures += 1; }
+        small_edit_bytes = bytes;
+        std::printf("edit of %zu shapes in %d: %zu bytes\n", edit_size, count, bytes);
+    }
+
+    auto document = make_bench_document(100000);
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<u64> pick(1, 100000);
+    for (const std::size_t budget : {std::size_t{ 64 * 1024 }, std::size_t{ 1024 * 1024 }})
+    {
+        History history;
+        history.budget_bytes = budget;
+        for (int edit = 0; edit < 2000; edit += 1)
+        {
+            std::vector<Id> ids(static_cast<std::size_t>(edit % 300) + 1);
+            for (auto& id : ids) { id = Id{ pick(gen) }; }
+            switch (edit % 4)
+            {
+            case 0: history.move(&document, ids, { 1, -1 }); break;
+            case 1: history.set_color(&document, ids, Rgba{ 0x00ff00, 100 }); break;
+            case 2: history.remove(&document, ids); break;
+            case 3: history.undo(&document); break;
+            }
+            if (history.get_memory_usage() > budget) { failures += 1; }
+        }
+        if (history.size() == 0) { failures += 1; }
+
+        // what clearing the history frees is what it held, so the usage it reports can't hide memory from the budget
+        const auto reported = history.get_memory_usage();
+        const auto commands = history.size();
+        const auto live_with_history = allocation_stats.get_live_bytes();
+        history.clear();
+        const auto held = live_with_history - allocation_stats.get_live_bytes();
+        std::printf("budget %zu KiB: %zu KiB reported, %zu KiB held, %zu commands\n", budget / 1024, reported / 1024, held / 1024, commands);
+        if (held < reported || held > reported + reported / 4 + 4096) { failures += 1; }
+        if (held > budget + budget / 4 + 4096) { failures += 1; }
+    }
+
+    // an edit bigger than the whole budget pushes out the older edits but can still be undone
+    {
+        auto big = make_bench_document(100000);
+        History history;
+        history.budget_bytes = 64 * 1024;
+        std::vector<Id> small_ids = { Id{ 1 }, Id{ 2 } };
+        history.move(&big, small_ids, { 1, 1 });
+
+        std::vector<Id> ids;
+        for (u64 i = 0; i < 20000; i += 1) { ids.push_back(Id{ i * 5 + 1 }); }
+        const auto before = big.size();
+        const auto bounds = big.get_bounds(ids.back());
+        history.remove(&big, ids);
+        const auto removed = before - big.size();
+        const bool kept = history.can_undo() && history.size() == 1 && history.get_memory_usage() > history.budget_bytes;
+        const bool undone = history.undo(&big) && big.size() == before && bounds && big.get_bounds(ids.back())->topleft == bounds->topleft && history.can_undo() == false;
+        std::printf("edit of %zu removed shapes over a %zu KiB budget: %s, %s\n", removed, history.budget_bytes / 1024, kept ? "kept" : "dropped", undone ? "undone" : "not undone");
+        if (kept == false) { failures += 1; }
+        if (undone == false) { failures += 1; }
+    }
+
+    return failures;
+}
+
+// the world space hit test gives the same answer as projecting the shape to the screen at every scale,
+// and the picked shape is the topmost of all the hits
+int check_world_hit_test()
+{
+    std::mt19937 gen(11);
+    int mismatches = 0;
+
+    // anywhere or near the rect, a few float steps from an edge, or up to a few pixels from an edge
+    const char* kinds[3] = { "anywhere", "float steps from an edge", "pixels from an edge" };
+    int cases[3] = { 0, 0, 0 };
+    int fallbacks[3] = { 0, 0, 0 };
+    for (int index = 0; index < 2000000; index += 1)
+    {
+        const auto c = make_hit_case(&gen, index);
+        const bool expected = is_rectangle_hit(c.t, c.rect, c.point, c.extra);
+        const WorldHitTest hit{ c.t, c.point, c.extra };
+        if (hit.is_rectangle_hit(c.rect) != expected) { mismatches += 1; }
+
+        // the cases the world test answers on its own must agree, the rest are redone in screen space
+        // and only compare the screen test with itself
+        const int kind = index % 3 != 2 ? 0 : is_float_steps_from_edge(index) ? 1 : 2;
+        cases[kind] += 1;
+        const auto world = hit.get_world_rectangle_hit(c.rect);
+        if (world.has_value() == false) { fallbacks[kind] += 1; }
+        else if (*world != expected) { mismatches += 1; }
+    }
+    std::printf("world against screen: %d mismatches, redone in screen space:\n", mismatches);
+    double shares[3] = {};
+    for (int kind = 0; kind < 3; kind += 1)
+    {
+        shares[kind] = static_cast<double>(fallbacks[kind]) / cases[kind];
+        std::printf("    %.3f%% of %d cases %s\n", shares[kind] * 100.0, cases[kind], kinds[kind]);
+    }
+
+    // a wider rounding band would hide a broken world space test behind the screen test.
+    // the points a float step from an edge are meant to be redone
+    if (shares[0] > 0.02) { mismatches += 1; }
+    if (shares[2] > 0.75) { mismatches += 1; }
+
+    Document document;
+    const float world_size = fill_document(&document, SceneSpec{ SceneKind::overlapping, 20000 });
+    add_example_shapes(&document);
+    SceneRandom random{ 5 };
+    IdSet set;
+    std::vector<Id> sorted;
+    int pick_mismatches = 0;
+    for (int i = 0; i < 2000; i += 1)
+    {
+        CanvasTransform t;
+        t.scale = random.next(0.05f, 4.0f);
+        const auto p = t.from_world_to_screen({ random.next(-100.0f, world_size), random.next(-100.0f, world_size) });
+        document.get_hit(t, p, 10.0f, &set);
+        document.get_hits(t, p, 10.0f, &sorted);
+        const auto topmost = document.get_topmost_hit(t, p, 10.0f);
+        if (sorted.size() != set.size()) { pick_mismatches += 1; continue; }
+        for (std::size_t h = 0; h < sorted.size(); h += 1)
+        {
+            if (set.contains(sorted[h]) == false || (h > 0 && sorted[h - 1].id <= sorted[h].id)) { pick_mismatches += 1; }
+        }
+        if (topmost.has_value() != (sorted.empty() == false) || (topmost && *topmost != sorted[0])) { pick_mismatches += 1; }
+    }
+    std::printf("topmost against every hit: %d mismatches\n", pick_mismatches);
+
+    return mismatches + pick_mismatches;
+}
+
+// hovering and dragging a marquee the way the canvas does on mouse moves doesn't allocate
+// once the sets have grown
+int check_selection_allocations()
+{
+    Document document;
+    const float world_size = fill_document(&document, SceneSpec{ SceneKind::uniform, 100000 });
+    add_example_shapes(&document);
+
+    CanvasTransform t;
+    t.scale = 1080.0f / world_size;
+    constexpr int events = 200;
+    SceneRandom random{ 9 };
+    std::vector<glm::vec2> hover_points;
+    for (int i = 0; i < events; i += 1)
+    {
+        hover_points.push_back({ random.next(0.0f, 1080.0f), random.next(0.0f, 1080.0f) });
+    }
+
+    IdSet hovers;
+    IdSet selection;
+    const auto move = [&](int i)
+    {
+        hovers.clear();
+        if (const auto hit = document.get_topmost_hit(t, hover_points[i], 10.0f)) { hovers.insert(*hit); }
+        const auto marquee = Rect{ {0.0f, 0.0f}, glm::vec2{ 1080.0f, 1080.0f } * (static_cast<float>(i + 1) / events) };
+        document.get_selection(t, marquee, i % 2 == 0, &selection);
+    };
+
+    // the first pass grows the sets to the whole document
+    for (int i = 0; i < events; i += 1) { move(i); }
+    const auto before = allocation_stats.get_allocations();
+    for (int i = 0; i < events; i += 1) { move(i); }
+    const auto allocations = static_cast<int>(allocation_stats.get_allocations() - before);
+    std::printf("%d events: %d allocations, %zu selected\n", events, allocations, selection.size());
+
+    return allocations + (selection.size() == document.size() ? 0 : 1);
+}
+
+// an svg import is one step in the history, undo takes all of it away and redo brings back the same drawing
+int check_svg_import_undo()
+{
+    const auto read_file = [](const std::string& path)
+    {
+        std::string text;
+        if (std::FILE* file = std::fopen(path.c_str(), "rb"))
+        {
+            for (int c = std::fgetc(file); c != EOF; c = std::fgetc(file)) { text.push_back(static_cast<char>(c)); }
+            std::fclose(file);
+        }
+        return text;
+    };
+    const std::string path = "vecy_check_import.svg";
+    // without the header, the view box comes from the index and an index that had shapes removed can be a float step larger
+    const auto export_text = [&](Document* document)
+    {
+        const auto text = export_svg(document, path) ? read_file(path) : std::string{};
+        const auto svg = text.find("<svg");
+        return svg == std::string::npos ? std::string{} : text.substr(text.find('\n', svg));
+    };
+
+    Document source;
+    add_example_shapes(&source);
+    fill_document(&source, SceneSpec{ SceneKind::clustered, 2000 });
+    const auto source_path = "vecy_check_source.svg";
+    int failures = export_svg(&source, source_path) ? 0 : 1;
+
+    Document document;
+    fill_document(&document, SceneSpec{ SceneKind::uniform, 500 });
+    History history;
+    history.move(&document, { Id{ 3 } }, { 5, 5 });
+    const auto before = export_text(&document);
+    const auto size_before = document.size();
+
+    SvgShapes shapes;
+    const auto stats = read_svg(&document.ids, source_path, &shapes);
+    const auto history_before = history.get_memory_usage();
+    history.add(&document, std::move(shapes.rectangles), std::move(shapes.paths));
+    const auto imported = export_text(&document);
+    if (stats.ok == false || stats.rectangles == 0 || stats.paths == 0) { failures += 1; }
+    if (document.size() != size_before + stats.rectangles + stats.paths) { failures += 1; }
+
+    // the shapes are in the document, the history only keeps their ids until the import is undone
+    const auto shape_count = static_cast<std::size_t>(stats.rectangles + stats.paths);
+    const auto ids_bytes = history.get_memory_usage() - history_before;
+    if (ids_bytes > sizeof(Command) + shape_count * sizeof(Id)) { failures += 1; }
+
+    if (history.undo(&document) == false || export_text(&document) != before || document.size() != size_before) { failures += 1; }
+    const auto undone_bytes = history.get_memory_usage() - history_before;
+    if (history.redo(&document) == false || export_text(&document) != imported) { failures += 1; }
+    if (history.get_memory_usage() - history_before != ids_bytes) { failures += 1; }
+    if (history.undo(&document) == false || export_text(&document) != before || history.redo(&document) == false || export_text(&document) != imported) { failures += 1; }
+    if (history.undo(&document) == false || history.undo(&document) == false || history.can_undo()) { failures += 1; }
+    std::printf("history for the import: %zu bytes while done, %zu bytes while undone\n", ids_bytes, undone_bytes);
+
+    std::remove(path.c_str());
+    std::remove(source_path);
+    std::printf("%llu rectangles and %llu paths imported\n", static_cast<unsigned long long>(stats.rectangles), static_cast<unsigned long long>(stats.paths));
+    return failures;
+}
+
+// the merged small shapes keep their place in the paint order: above the large shapes before them,
+// below the large shapes after them. the same drawing with each small shape as the pixel it merges
+// into must come out the same
+int check_lod_order()
+{
+    struct Shape
+    {
+        Rgba color;
+        Rect rect;
+    };
+    const auto dot = [](int x, int y, const Rgba& color)
+    {
+        // a quarter of the pixel, centered on it
+        return Shape{ color, Rect{ {x + 0.25f, y + 0.25f}, {0.5f, 0.5f} } };
+    };
+    const Shape shapes[] =
+    {
+        { Rgba{ 0xff0000 }, Rect{ {0, 0}, {40, 40} } },
+        dot(10, 10, Rgba{ 0x0000ff }),
+        dot(20, 20, Rgba{ 0x00ff00 }),
+        { Rgba{ 0xffff00 }, Rect{ {15.5f, 15.5f}, {15, 15} } },
+        dot(25, 25, Rgba{ 0xff00ff }),
+        dot(15, 15, Rgba{ 0x00ffff }),
+        { Rgba{ 0xffffff, 128 }, Rect{ {24, 24}, {10, 10} } },
+        dot(26, 26, Rgba{ 0x000000 }),
+    };
+
+    Document merged;
+    Document expected;
+    for (const auto& shape : shapes)
+    {
+        merged.add_rectangle(shape.color, shape.rect);
+        if (shape.rect.size.x < 1.0f)
+        {
+            auto color = shape.color;
+            color.a = 64;
+            expected.add_rectangle(color, Rect{ {std::floor(shape.rect.topleft.x), std::floor(shape.rect.topleft.y)}, {1, 1} });
+        }
+        else
+        {
+            expected.add_rectangle(shape.color, shape.rect);
+        }
+    }
+
+    const auto size = glm::ivec2{ 48, 48 };
+    Settings settings;
+    settings.lod_pixel_threshold = 1.0f;
+    RenderCache cache;
+    Image merged_image{ size.x, size.y };
+    Image expected_image{ size.x, size.y };
+    LodPainter<RasterPainter> lod_painter{ &merged_image };
+    RasterPainter painter{ &expected_image };
+    const auto stats = render_scene(&lod_painter, &merged, settings, CanvasTransform{}, size, &cache);
+    settings.lod_pixel_threshold = 0.0f;
+    render_scene(&painter, &expected, settings, CanvasTransform{}, size, &cache);
+
+    int mismatches = stats.lod_merged == 5 ? 0 : 1;
+    for (std::size_t i = 0; i < expected_image.pixels.size(); i += 1)
+    {
+        if (merged_image.pixels[i] != expected_image.pixels[i]) { mismatches += 1; }
+    }
+    std::printf("%d merged into %d primitives, %d mismatches\n", stats.lod_merged, stats.lod_primitives, mismatches);
+    return mismatches;
+}
+
+// a diagonal line is only stepped where it can reach the clip. stamped like the painter does but over the
+// whole line, the pixels must be the same, and a line far past the screen must not take long
+int check_clipped_lines()
+{
+    const int size = 128;
+    const auto stamp_whole_line = [&](Image* image, const glm::vec2& from, const glm::vec2& to, const Outline& outline)
+    {
+        const int w = std::max(1, outline.width);
+        const int offset = (w - 1) / 2;
+        const auto delta = to - from;
+        const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y);
+        const int steps = static_cast<int>(std::ceil(std::max(std::abs(delta.x), std::abs(delta.y))));
+        for (int i = 0; i < steps; i += 1)
+        {
+            const float t = static_cast<float>(i) / static_cast<float>(steps);
+            if (is_dash_on(outline.style, w, length * t) == false) { continue; }
+            const int px = static_cast<int>(std::floor(from.x + delta.x * t)) - offset;
+            const int py = static_cast<int>(std::floor(from.y + delta.y * t)) - offset;
+            for (int y = py; y < py + w; y += 1)
+            {
+                for (int x = px; x < px + w; x += 1)
+                {
+                    if (x >= 0 && x < size && y >= 0 && y < size) { image->get_row(y)[x] = to_pixel(outline.color); }
+                }
+            }
+        }
+    };
+
+    std::mt19937 gen(17);
+    std::uniform_real_distribution<float> coordinate(-4000.0f, 4000.0f);
+    std::uniform_int_distribution<int> width(1, 6);
+    std::uniform_int_distribution<int> style(0, 4);
+    int mismatches = 0;
+    for (int line = 0; line < 2000; line += 1)
+    {
+        // through the image or past it, in any direction
+        const glm::vec2 through{ coordinate(gen) / 20.0f + size / 2, coordinate(gen) / 20.0f + size / 2 };
+        const glm::vec2 from{ coordinate(gen), coordinate(gen) };
+        const glm::vec2 to = through + (through - from) * (line % 3 == 0 ? 0.2f : 1.0f);
+        if (from.x == to.x || from.y == to.y) { continue; }
+        const Outline outline{ Rgba{ 0x1971c2 }, width(gen), static_cast<LineStyle>(style(gen)) };
+
+        Image expected{ size, size };
+        stamp_whole_line(&expected, from, to, outline);
+        Image actual{ size, size };
+        RasterPainter painter{ &actual };
+        painter.draw_line(from, to, outline);
+        if (actual.pixels != expected.pixels) { mismatches += 1; }
+    }
+
+    Image image{ size, size };
+    RasterPainter painter{ &image };
+    const Timer timer;
+    painter.draw_line({ -6.0e7f, -2.0e7f }, { 6.0e7f, 2.0e7f }, Outline{ Rgba{ 0x000000 }, 2, LineStyle::solid });
+    const bool drawn = std::any_of(image.pixels.begin(), image.pixels.end(), [](Pixel p) { return p != 0; });
+    // more steps than an int holds
+    painter.draw_line({ -3.0e9f, -1.0e9f }, { 3.0e9f, 1.0e9f }, Outline{ Rgba{ 0x000000 }, 2, LineStyle::solid });
+    const double far_ms = timer.get_elapsed_ns() / 1000000.0;
+
+    std::printf("clipped against whole lines: %d mismatches, lines 1.2e8 and 6e9 pixels long in %.3f ms\n", mismatches, far_ms);
+    return mismatches + (far_ms > 100.0 ? 1 : 0) + (drawn ? 0 : 1);
+}
+
+// shapes straddling the top left edge are binned to the first tiles, shapes far off screen to none.
+// the tiles draw the same as one painter does without the far off shapes
+int check_tiled_bins()
+{
+    const auto screen = glm::ivec2{ 300, 200 };
+    std::mt19937 gen(23);
+    std::uniform_real_distribution<float> near(-80.0f, 360.0f);
+    std::uniform_real_distribution<float> size(1.0f, 90.0f);
+    std::uniform_real_distribution<float> far(1.0e10f, 1.0e30f);
+    std::uniform_int_distribution<open_color::Hex> color(0, 0xffffff);
+
+    DrawCommandList on_screen;
+    DrawCommandList with_far;
+    RecordingPainter on_screen_painter{ &on_screen };
+    RecordingPainter with_far_painter{ &with_far };
+    for (int i = 0; i < 4000; i += 1)
+    {
+        const auto fill = Fill{ Rgba{ color(gen), static_cast<u8>(i % 2 == 0 ? 255 : 128) }, FillStyle::solid };
+        const auto rect = Rect{ {near(gen), near(gen)}, {size(gen), size(gen)} };
+        on_screen_painter.draw_rectangle(rect, fill, std::nullopt);
+        with_far_painter.draw_rectangle(rect, fill, std::nullopt);
+
+        const float sign_x = i % 3 == 0 ? -1.0f : 1.0f;
+        const float sign_y = i % 5 == 0 ? -1.0f : 1.0f;
+        with_far_painter.draw_rectangle(Rect{ {sign_x * far(gen), sign_y * far(gen)}, {size(gen), size(gen)} }, fill, std::nullopt);
+    }
+
+    Image expected{ screen.x, screen.y };
+    RasterPainter single{ &expected };
+    for (const auto& c : on_screen.commands)
+    {
+        replay(&single, on_screen, c);
+    }
+
+    int mismatches = 0;
+    for (const int threads : {1, 3})
+    {
+        ThreadPool pool{ threads };
+        TiledRasterizer rasterizer;
+        rasterizer.tile_size = 32;
+        Image image{ screen.x, screen.y };
+        rasterizer.render(with_far, &image, &pool);
+        for (std::size_t i = 0; i < image.pixels.size(); i += 1)
+        {
+            if (image.pixels[i] != expected.pixels[i]) { mismatches += 1; }
+        }
+    }
+    std::printf("tiles with far off shapes against one painter without: %d mismatches\n", mismatches);
+    return mismatches;
+}
+
+std::vector<Check> get_checks()
+{
+    return
+    {
+        { "scenes", check_scenes },
+        { "span_kernels", check_span_kernel_frames },
+        { "transform_kernels", check_all_transform_kernels },
+        { "history_memory", check_history_memory },
+        { "world_hit_test", check_world_hit_test },
+        { "selection_allocations", check_selection_allocations },
+        { "svg_import_undo", check_svg_import_undo },
+        { "lod_order", check_lod_order },
+        { "clipped_lines", check_clipped_lines },
+        { "tiled_bins", check_tiled_bins },
+    };
+}
+
+// runs every check, or only the named one, returns the exit code
+int run_checks(const std::string& only)
+{
+    int failed = 0;
+    bool found = false;
+    for (const auto& check : get_checks())
+    {
+        if (only.empty() == false && only != check.name)
+        {
+            continue;
+        }
+        found = true;
+        const int failures = check.run();
+        std::printf("%-24s %s, %d failures\n", check.name, failures == 0 ? "ok" : "FAILED", failures);
+        if (failures != 0)
+        {
+            failed += 1;
+        }
+    }
+    if (found == false)
+    {
+        std::fprintf(stderr, "unknown check %s\n", only.c_str());
+        return 2;
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+namespace
+{
+    void print_usage(std::FILE* file)
+    {
+        std::fprintf
+        (
+            file,
+            "usage: vecy_bench                 run the benchmark tables\n"
+            "       vecy_bench --check [name]  run the checks, or only the named one\n"
+            "       vecy_bench --suite [--json results.json] [--max-shapes 10000000] [--compare baseline.json] [--threshold 1.1]\n"
+        );
+    }
+
+    // the whole text must be a number
+    bool parse_number(const char* text, double* number)
+    {
+        char* end = nullptr;
+        *number = std::strtod(text, &end);
+        return end != text && *end == '\0';
+    }
+
+    // --suite and its options, false if an argument isn't known, misses its value
+    // or is a suite option without --suite
+    bool parse_suite_options(int argc, char** argv, bool* suite, SuiteOptions* options)
+    {
+        bool has_suite_option = false;
+        for (int i = 1; i < argc; i += 1)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--suite")
+            {
+                *suite = true;
+                continue;
+            }
+
+            const bool takes_value = arg == "--json" || arg == "--compare" || arg == "--max-shapes" || arg == "--threshold";
+            if (takes_value == false)
+            {
+                std::fprintf(stderr, "unknown argument %s\n", arg.c_str());
+                return false;
+            }
+            if (i + 1 >= argc)
+            {
+                std::fprintf(stderr, "%s needs a value\n", arg.c_str());
+                return false;
+            }
+
+            const char* value = argv[i + 1];
+            i += 1;
+            has_suite_option = true;
+
+            double number = 0.0;
+            const bool is_number = parse_number(value, &number);
+            if (arg == "--json") { options->json_path = value; }
+            else if (arg == "--compare") { options->compare_path = value; }
+            else if (arg == "--max-shapes" && is_number && number >= 1.0) { options->max_shapes = static_cast<int>(number); }
+            else if (arg == "--threshold" && is_number && number > 0.0) { options->threshold = number; }
+            else
+            {
+                std::fprintf(stderr, "%s %s isn't a valid value\n", arg.c_str(), value);
+                return false;
+            }
+        }
+
+        if (has_suite_option && *suite == false)
+        {
+            std::fprintf(stderr, "--json, --compare, --max-shapes and --threshold need --suite\n");
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 2 && (std::string{ argv[1] } == "--help" || std::string{ argv[1] } == "-h"))
+    {
+        print_usage(stdout);
+        return 0;
+    }
+
+    // vecy_bench --check [name] runs the checks instead of the tables
+    if (argc >= 2 && std::string{ argv[1] } == "--check")
+    {
+        if (argc > 3)
+        {
+            print_usage(stderr);
+            return 2;
+        }
+        return run_checks(argc >= 3 ? argv[2] : "");
+    }
+
+    // a mistyped argument must not run the tables for minutes or look like the suite wrote its results
+    bool suite = false;
+    SuiteOptions suite_options;
+    if (parse_suite_options(argc, argv, &suite, &suite_options) == false)
+    {
+        print_usage(stderr);
+        return 2;
+    }
+    if (suite)
+    {
+        return run_suite(suite_options);
+    }
+
+    std::printf("spatial index vs linear scan, ns per query\n");
+    std::printf
+    (
+        "%9s | %12s %12s | %12s %12s | %12s %12s | %6s | %s\n",
+        "shapes",
+        "hit linear", "hit index",
+        "encl linear", "encl index",
+        "isect linear", "isect index",
+        "height",
+        "mismatches"
+    );
+
+    for (const int count : {1000, 10000, 100000, 1000000})
+    {
+        bench_spatial_index(count);
+    }
+
+    std::printf("\nshape store vs heap allocated shapes\n");
+    std::printf
+    (
+        "%9s | %12s %12s | %12s %12s\n",
+        "shapes",
+        "B/shape old", "B/shape soa",
+        "ms/iter old", "ms/iter soa"
+    );
+
+    for (const int count : {10000, 100000, 1000000})
+    {
+        bench_shape_store(count);
+    }
+
+    std::printf("\nraster span kernels, megapixels per second on a 1920x1080 frame\n");
+    std::printf
+    (
+        "%9s | %12s %12s %12s %12s | %s\n",
+        "kernels",
+        "fill", "blend", "hatch fill", "hatch blend",
+        "mismatches"
+    );
+
+    for (const auto* kernels : get_supported_kernels())
+    {
+        bench_span_kernels(*kernels);
+    }
+
+    std::printf("\ncanvas transform kernels, millions per second on batches of 256\n");
+    std::printf
+    (
+        "%9s | %12s %12s %12s %12s | %s\n",
+        "kernels",
+        "pts screen", "pts world", "rects screen", "rects world",
+        "mismatches"
+    );
+
+    for (const auto* kernels : get_supported_transform_kernels())
+    {
+        bench_transform_kernels(*kernels);
+    }
+
+    std::printf("\ntiled raster, 1M shapes at 1920x1080, %d hardware threads\n", get_hardware_thread_count());
+    std::printf("%9s | %12s %12s | %s\n", "threads", "ms/frame", "speedup", "mismatches");
+    bench_tiled_raster(1000000);
+
+    std::printf("\nlevel of detail, 1M shapes at 1920x1080 with a 1 pixel threshold\n");
+    std::printf("%9s | %12s %12s %12s | %12s %12s\n", "scale", "prims off", "prims on", "merged", "ms off", "ms on");
+    bench_lod(1000000);
+
+    std::printf("\ndocument file, mapped load vs parsing every shape\n");
+    std::printf("%9s | %10s %10s | %10s %12s %10s | %s\n", "shapes", "ms save", "MiB", "ms load", "ms 1st frame", "ms parse", "mismatches");
+    for (const int count : {10000, 100000, 1000000, 4000000})
+    {
+        bench_document_file(count);
+    }
+
+    std::printf("\nstatic layer tile cache, 200 frame pan over 100k shapes at 1920x1080\n");
+    std::printf("%9s | %12s %12s | %9s %10s %10s | %s\n", "MiB", "ms/frame", "ms cached", "hit rate", "KiB", "evictions", "mismatches");
+    for (const std::size_t budget : {4, 16, 64})
+    {
+        bench_tile_cache(100000, budget * 1024 * 1024);
+    }
+
+    std::printf("\nundo history, bytes kept for an edit of 100 shapes\n");
+    std::printf("%9s | %10s %10s %10s | %12s\n", "shapes", "B move", "B restyle", "B remove", "MiB document");
+    for (const int count : {10000, 100000, 1000000})
+    {
+        bench_history_memory(count);
+    }
+
+    std::printf("\nundo history, edits in a document of 1M shapes\n");
+    std::printf("%9s %9s | %10s %10s %10s | %10s | %s\n", "edit", "shapes", "ms edit", "ms undo", "ms redo", "KiB", "mismatches");
+    for (const int count : {1000, 100000})
+    {
+        bench_history_edit("move", count, [](Document* d, History* h, const std::vector<Id>& ids) { h->move(d, ids, { 25, -10 }); });
+        bench_history_edit("restyle", count, [](Document* d, History* h, const std::vector<Id>& ids) { h->set_color(d, ids, Rgba{ 0x00ff00, 128 }); });
+        bench_history_edit("remove", count, [](Document* d, History* h, const std::vector<Id>& ids) { h->remove(d, ids); });
+        bench_history_edit("add", count, [](Document* d, History* h, const std::vector<Id>& ids)
+        {
+            std::vector<RectangleShape> shapes;
+            for (const auto id : ids)
+            {
+                shapes.push_back({ Id{0}, Rgba{ 0x0000ff }, *d->get_bounds(id) });
+            }
+            h->add(d, &shapes);
+        });
+    }
+
+    std::printf("\nhit test in world space against projecting every shape to the screen\n");
+    std::printf("%9s %9s | %10s %10s | %s\n", "cases", "hits", "ns screen", "ns world", "mismatches");
+    bench_world_hit_test(10000000);
+
+    std::printf("\npicking, every hit against the topmost one, us per query\n");
+    std::printf("%11s %9s | %8s | %10s %10s %10s | %s\n", "scene", "shapes", "hits", "us set", "us sorted", "us topmost", "mismatches");
+    for (const auto kind : {SceneKind::uniform, SceneKind::overlapping})
+    {
+        bench_topmost_hit(kind, 1000000);
+    }
+
+    std::printf("\nhover and marquee events, new sets per event against reused sets\n");
+    std::printf
+    (
+        "%9s | %10s %10s | %10s %10s | %10s %10s | %10s %10s | %s\n",
+        "shapes",
+        "hover old", "allocs", "marq old", "allocs",
+        "us old", "us hover", "ms old", "ms marq",
+        "mismatches"
+    );
+    for (const int count : {10000, 1000000})
+    {
+        bench_selection_events(count);
+    }
+
+    std::printf("\ndragging a selection, moving the shapes every event against a preview transform and one commit\n");
+    std::printf("%9s %9s | %10s %10s %10s | %10s %10s | %s\n", "shapes", "selected", "ms moved", "ms preview", "ms zoomed", "ms static", "ms commit", "mismatches");
+    bench_drag_preview(1000000, 100000);
+
+    std::printf("\nheap allocations, frames and queries after a first pass has grown the scratch memory\n");
+    std::printf("%9s | %10s %10s %10s | %10s %10s | %10s %10s | %s\n", "shapes", "build", "save", "load", "frame", "queries", "KiB held", "KiB live", "mismatches");
+    bench_allocations(1000000);
+
+    std::printf("\nbezier paths during a continuous zoom at 1920x1080, flattened every frame against once per zoom level\n");
+    std::printf("%9s %9s %9s | %10s %10s | %10s %10s | %s\n", "paths", "frames", "levels", "ms every", "ms cached", "flattens", "cached", "mismatches");
+    bench_path_zoom(100000);
+
+    std::printf("\nsymbol instances during a zoom at 1920x1080, against each instance as shapes of its own\n");
+    std::printf("%9s %9s | %10s %10s | %10s %10s | %10s %10s | %s\n", "instances", "shapes", "MiB inst", "MiB shapes", "ms inst", "ms shapes", "recorded", "px differ", "mismatches");
+    bench_instances(50000);
+
+#if defined(VECY_PROFILER)
+    std::printf("\nprofiler zones, %d hardware threads\n", get_hardware_thread_count());
+    std::printf("%9s | %10s %10s | %10s | %s\n", "zones", "ns/scope", "ns threads", "ms read", "mismatches");
+    bench_profiler(1000000);
+#endif
+
+    // VECY_BENCH_SVG_MB sets the size of the generated file
+    const char* svg_mib = std::getenv("VECY_BENCH_SVG_MB");
+    const std::size_t svg_bytes = static_cast<std::size_t>(svg_mib != nullptr ? std::max(1, std::atoi(svg_mib)) : 64) * 1024 * 1024;
+    std::printf("\nsvg import and export, bulk index build vs inserting one by one\n");
+    std::printf
+    (
+        "%9s %10s | %10s %10s %10s %10s | %10s %10s | %10s %10s | %10s | %s\n",
+        "MiB", "rects",
+        "ms import", "MiB/s", "Mrects/s", "parser KiB",
+        "ms insert", "ms bulk",
+        "us query", "us bulk q",
+        "export MiB/s",
+        "mismatches"
+    );
+    bench_svg(svg_bytes);
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "vecy_bench/scenes.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "vecy/document.h"
+
+const char* to_string(SceneKind kind)
+{
+    switch (kind)
+    {
+    case SceneKind::uniform: return "uniform";
+    case SceneKind::clustered: return "clustered";
+    case SceneKind::overlapping: return "overlapping";
+    default: return "?";
+    }
+}
+
+GeneratedScene generate_scene(const SceneSpec& spec)
+{
+    SceneRandom random{ spec.seed };
+
+    GeneratedScene scene;
+    scene.shapes.reserve(spec.count);
+    const auto add = [&](float x, float y, float width, float height)
+    {
+        // clamped so every shape is inside the world
+        x = std::min(std::max(x, 0.0f), scene.world_size - width);
+        y = std::min(std::max(y, 0.0f), scene.world_size - height);
+        scene.shapes.push_back({ Id{0}, Rgba{ random.next_color() }, Rect{ {x, y}, {width, height} } });
+    };
+
+    switch (spec.kind)
+    {
+    case SceneKind::uniform:
+        // the same density as the other benchmarks, about one shape per 40x40
+        scene.world_size = std::sqrt(static_cast<float>(spec.count)) * 40.0f + 40.0f;
+        for (int i = 0; i < spec.count; i += 1)
+        {
+            add(random.next(0.0f, scene.world_size), random.next(0.0f, scene.world_size), random.next(5.0f, 30.0f), random.next(5.0f, 30.0f));
+        }
+        break;
+    case SceneKind::clustered:
+    {
+        // a thousand shapes per cluster in a world as big as the uniform one
+        scene.world_size = std::sqrt(static_cast<float>(spec.count)) * 40.0f + 400.0f;
+        const int cluster_count = std::max(1, spec.count / 1000);
+        std::vector<glm::vec2> centers;
+        for (int i = 0; i < cluster_count; i += 1)
+        {
+            centers.push_back({ random.next(0.0f, scene.world_size), random.next(0.0f, scene.world_size) });
+        }
+        for (int i = 0; i < spec.count; i += 1)
+        {
+            const auto& center = centers[static_cast<std::size_t>(i) % centers.size()];
+            add(center.x + random.next_centered(200.0f), center.y + random.next_centered(200.0f), random.next(2.0f, 12.0f), random.next(2.0f, 12.0f));
+        }
+        break;
+    }
+    case SceneKind::overlapping:
+        // every point is covered by about 50 shapes
+        scene.world_size = std::sqrt(static_cast<float>(spec.count)) * 10.0f + 200.0f;
+        for (int i = 0; i < spec.count; i += 1)
+        {
+            add(random.next(0.0f, scene.world_size), random.next(0.0f, scene.world_size), random.next(20.0f, 120.0f), random.next(20.0f, 120.0f));
+        }
+        break;
+    }
+
+    return scene;
+}
+
+float fill_document(Document* document, const SceneSpec& spec)
+{
+    auto scene = generate_scene(spec);
+    document->add_rectangles(&scene.shapes);
+    return scene.world_size;
+}
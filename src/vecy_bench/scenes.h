@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <random>
+
+#include "vecy/types.h"
+#include "vecy/rect.h"
+#include "vecy/shape_store.h"
+
+struct Document;
+
+enum class SceneKind
+{
+    // spread evenly with the same density at every size
+    uniform,
+
+    // dense groups with empty space between them
+    clustered,
+
+    // large shapes stacked many deep
+    overlapping
+};
+
+[[nodiscard]] const char* to_string(SceneKind kind);
+
+// mt19937 is specified to the bit but the std distributions aren't, so this makes
+// the same numbers everywhere
+struct SceneRandom
+{
+    std::mt19937 gen;
+
+    explicit SceneRandom(u32 seed)
+        : gen(seed)
+    {
+    }
+
+    // [0, 1)
+    float next()
+    {
+        return static_cast<float>(gen() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    float next(float min, float max)
+    {
+        return min + next() * (max - min);
+    }
+
+    // roughly normal, the sum of uniforms
+    float next_centered(float radius)
+    {
+        return (next() + next() + next() + next() - 2.0f) * radius * 0.5f;
+    }
+
+    u32 next_color()
+    {
+        return gen() & 0xffffff;
+    }
+};
+
+// the same spec gives the same shapes on every platform and standard library
+struct SceneSpec
+{
+    SceneKind kind = SceneKind::uniform;
+    int count = 0;
+    u32 seed = 42;
+};
+
+struct GeneratedScene
+{
+    std::vector<RectangleShape> shapes;
+
+    // the shapes are inside 0,0 to world_size,world_size
+    float world_size = 0.0f;
+};
+
+[[nodiscard]] GeneratedScene generate_scene(const SceneSpec& spec);
+
+// adds the scene to the document with the bulk index load, returns the world size
+float fill_document(Document* document, const SceneSpec& spec);
@@ -0,0 +1,336 @@
+#include "vecy_bench/suite.h"
+
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+#include "vecy/document.h"
+#include "vecy/document_file.h"
+#include "vecy/render.h"
+#include "vecy/raster.h"
+#include "vecy_bench/scenes.h"
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    double get_ns_since(const clock::time_point& start)
+    {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+    }
+
+    // the fastest run, repeated until enough time is spent that a slow run from the machine
+    // doesn't decide the result. setup runs before each timed run and isn't counted
+    template<typename Setup, typename F>
+    double measure_best_ns(Setup&& setup, F&& f)
+    {
+        constexpr int min_runs = 5;
+        constexpr int max_runs = 200;
+        constexpr double min_total_ns = 200.0 * 1000000.0;
+
+        double best = 0.0;
+        double total = 0.0;
+        for (int run = 0; run < max_runs && (run < min_runs || total < min_total_ns); run += 1)
+        {
+            setup();
+            const auto start = clock::now();
+            f();
+            const auto ns = get_ns_since(start);
+            best = run == 0 ? ns : std::min(best, ns);
+            total += ns;
+        }
+        return best;
+    }
+
+    template<typename F>
+    double measure_best_ns(F&& f)
+    {
+        return measure_best_ns([]() {}, f);
+    }
+
+    const glm::ivec2 screen_size = { 1920, 1080 };
+
+    // the transform that centers the world point on the screen
+    CanvasTransform get_view(const glm::vec2& center, float scale)
+    {
+        CanvasTransform t;
+        t.scale = scale;
+        t.scroll = glm::vec2{ screen_size } * 0.5f - center * scale;
+        return t;
+    }
+
+    struct SuiteRun
+    {
+        std::vector<BenchResult> results;
+
+        void add(const char* name, const SceneSpec& spec, double value, const char* unit)
+        {
+            results.push_back({ name, to_string(spec.kind), spec.count, value, unit });
+            std::printf("%-16s %-12s %9d | %12.3f %s\n", name, to_string(spec.kind), spec.count, value, unit);
+            std::fflush(stdout);
+        }
+    };
+
+    void run_scene(SuiteRun* run, const SceneSpec& spec)
+    {
+        auto scene = generate_scene(spec);
+        const float world_size = scene.world_size;
+
+        std::vector<RectangleShape> shapes;
+        auto built = std::make_unique<Document>();
+        const auto build_ns = measure_best_ns
+        (
+            [&]() { shapes = scene.shapes; built = std::make_unique<Document>(); },
+            [&]() { built->add_rectangles(&shapes); }
+        );
+        run->add("build", spec, build_ns / 1000000.0, "ms");
+        Document& document = *built;
+        shapes = {};
+
+        // the screen is the world so the queries are in world units
+        const auto identity = CanvasTransform{};
+        SceneRandom random{ spec.seed + 1 };
+
+        constexpr int hit_count = 2000;
+        std::vector<glm::vec2> points;
+        for (int i = 0; i < hit_count; i += 1)
+        {
+            points.push_back({ random.next(0.0f, world_size), random.next(0.0f, world_size) });
+        }
+        std::size_t hits = 0;
+        IdSet found;
+        const auto hit_ns = measure_best_ns([&]()
+        {
+            for (const auto& p : points)
+            {
+                document.get_hit(identity, p, 10.0f, &found);
+                hits += found.size();
+            }
+        });
+        run->add("hit", spec, hit_ns / hit_count, "ns/query");
+
+        constexpr int marquee_count = 200;
+        std::vector<Rect> marquees;
+        for (int i = 0; i < marquee_count; i += 1)
+        {
+            marquees.push_back(Rect{ {random.next(0.0f, world_size), random.next(0.0f, world_size)}, {400.0f, 300.0f} });
+        }
+        for (const bool enclosed : {false, true})
+        {
+            const auto ns = measure_best_ns([&]()
+            {
+                for (const auto& r : marquees)
+                {
+                    document.get_selection(identity, r, enclosed, &found);
+                    hits += found.size();
+                }
+            });
+            run->add(enclosed ? "marquee enclosed" : "marquee", spec, ns / marquee_count / 1000.0, "us/query");
+        }
+
+        // what a 1:1 view in the middle of the world has to look at
+        const auto center = glm::vec2{ world_size, world_size } * 0.5f;
+        const auto view = from_screen_to_world(get_view(center, 1.0f), Rect{ {0, 0}, screen_size });
+        const auto cull_ns = measure_best_ns([&]()
+        {
+            document.index.query_intersecting(view, [&](Id, const Rect&) { hits += 1; });
+        });
+        run->add("cull", spec, cull_ns / 1000.0, "us/frame");
+
+        // full frames on the raster painter, at 1:1 and with all of the world on the screen
+        Image image{ screen_size.x, screen_size.y };
+        RenderCache cache;
+        const auto fit_scale = std::min(screen_size.x, screen_size.y) / world_size;
+        for (const float scale : {1.0f, fit_scale})
+        {
+            const auto t = get_view(center, scale);
+            const auto ns = measure_best_ns([&]()
+            {
+                RasterPainter painter{ &image };
+                render_scene(&painter, &document, Settings{}, t, screen_size, &cache);
+            });
+            run->add(scale == 1.0f ? "render 1:1" : "render fit", spec, ns / 1000000.0, "ms/frame");
+        }
+
+        const std::string path = "vecy_suite.vecy";
+        const auto save_ns = measure_best_ns([&]() { save_document(document, path); });
+        run->add("save", spec, save_ns / 1000000.0, "ms");
+
+        Document loaded;
+        const auto load_ns = measure_best_ns([&]() { load_document(&loaded, path); });
+        run->add("load", spec, load_ns / 1000000.0, "ms");
+        loaded.set_base(nullptr);
+        std::remove(path.c_str());
+
+        // keeps the queries from being optimized away
+        if (hits == 0)
+        {
+            std::printf("%s %d: no hits\n", to_string(spec.kind), spec.count);
+        }
+    }
+
+    std::string get_key(const BenchResult& r)
+    {
+        return r.name + "|" + r.scene + "|" + std::to_string(r.shapes);
+    }
+
+    // the text after "key": on the line, without quotes
+    std::string get_json_field(const std::string& line, const char* key)
+    {
+        const auto pattern = std::string{ "\"" } + key + "\":";
+        auto found = line.find(pattern);
+        if (found == std::string::npos)
+        {
+            return {};
+        }
+        found += pattern.size();
+        while (found < line.size() && line[found] == ' ') { found += 1; }
+        if (found < line.size() && line[found] == '"')
+        {
+            const auto end = line.find('"', found + 1);
+            return line.substr(found + 1, end == std::string::npos ? std::string::npos : end - found - 1);
+        }
+        const auto end = line.find_first_of(",}", found);
+        return line.substr(found, end == std::string::npos ? std::string::npos : end - found);
+    }
+}
+
+std::vector<BenchResult> run_suite_cases(int max_shapes)
+{
+    SuiteRun run;
+    for (const int count : {1000, 10000, 100000, 1000000, 10000000})
+    {
+        if (count > max_shapes)
+        {
+            break;
+        }
+        for (const auto kind : {SceneKind::uniform, SceneKind::clustered, SceneKind::overlapping})
+        {
+            run_scene(&run, SceneSpec{ kind, count });
+        }
+    }
+    return run.results;
+}
+
+bool write_results_json(const std::vector<BenchResult>& results, const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    // one result per line so the file diffs well and is easy to read back
+    std::fprintf(file, "{\n\"version\": 1,\n\"results\": [\n");
+    for (std::size_t i = 0; i < results.size(); i += 1)
+    {
+        const auto& r = results[i];
+        std::fprintf
+        (
+            file, "{\"name\": \"%s\", \"scene\": \"%s\", \"shapes\": %d, \"value\": %.6g, \"unit\": \"%s\"}%s\n",
+            r.name.c_str(), r.scene.c_str(), r.shapes, r.value, r.unit.c_str(), i + 1 < results.size() ? "," : ""
+        );
+    }
+    std::fprintf(file, "]\n}\n");
+    return std::fclose(file) == 0;
+}
+
+std::vector<BenchResult> read_results_json(const std::string& path)
+{
+    std::vector<BenchResult> results;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return results;
+    }
+
+    std::string line;
+    for (int c = std::fgetc(file); ; c = std::fgetc(file))
+    {
+        if (c != '\n' && c != EOF)
+        {
+            line.push_back(static_cast<char>(c));
+            continue;
+        }
+
+        const auto name = get_json_field(line, "name");
+        if (name.empty() == false)
+        {
+            results.push_back
+            ({
+                name, get_json_field(line, "scene"),
+                std::atoi(get_json_field(line, "shapes").c_str()),
+                std::atof(get_json_field(line, "value").c_str()),
+                get_json_field(line, "unit")
+            });
+        }
+        line.clear();
+        if (c == EOF)
+        {
+            break;
+        }
+    }
+    std::fclose(file);
+    return results;
+}
+
+int run_suite(const SuiteOptions& options)
+{
+    std::printf("%-16s %-12s %9s | %12s\n", "case", "scene", "shapes", "value");
+    const auto results = run_suite_cases(options.max_shapes);
+
+    if (options.json_path.empty() == false && write_results_json(results, options.json_path) == false)
+    {
+        std::fprintf(stderr, "failed to write %s\n", options.json_path.c_str());
+        return 2;
+    }
+
+    if (options.compare_path.empty())
+    {
+        return 0;
+    }
+
+    const auto baseline = read_results_json(options.compare_path);
+    if (baseline.empty())
+    {
+        std::fprintf(stderr, "no results in %s\n", options.compare_path.c_str());
+        return 2;
+    }
+    std::unordered_map<std::string, double> baseline_values;
+    for (const auto& r : baseline)
+    {
+        baseline_values[get_key(r)] = r.value;
+    }
+
+    std::printf("\ncompared to %s, slower than %.2fx is a regression\n", options.compare_path.c_str(), options.threshold);
+    std::printf("%-16s %-12s %9s | %12s %12s %8s\n", "case", "scene", "shapes", "baseline", "value", "ratio");
+    int regressions = 0;
+    for (const auto& r : results)
+    {
+        const auto found = baseline_values.find(get_key(r));
+        if (found == baseline_values.end() || found->second <= 0.0)
+        {
+            continue;
+        }
+
+        const double ratio = r.value / found->second;
+        const char* verdict = "";
+        if (ratio > options.threshold)
+        {
+            verdict = " slower";
+            regressions += 1;
+        }
+        else if (ratio < 1.0 / options.threshold)
+        {
+            verdict = " faster";
+        }
+        std::printf("%-16s %-12s %9d | %12.3f %12.3f %7.2fx%s\n", r.name.c_str(), r.scene.c_str(), r.shapes, found->second, r.value, ratio, verdict);
+    }
+    std::printf("%d regressions\n", regressions);
+    return regressions > 0 ? 1 : 0;
+}
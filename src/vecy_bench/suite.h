@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// The regression suite: every case on every generated scene, written as json so two
+// runs can be compared.
+//
+//   vecy_bench --suite [--json results.json] [--max-shapes 10000000] [--compare baseline.json] [--threshold 1.1]
+//
+// Lower values are better for every case.
+
+struct BenchResult
+{
+    std::string name;
+    std::string scene;
+    int shapes = 0;
+    double value = 0.0;
+    std::string unit;
+};
+
+struct SuiteOptions
+{
+    std::string json_path;
+    std::string compare_path;
+    int max_shapes = 1000000;
+
+    // a case is slower if it takes more than this many times the baseline
+    double threshold = 1.1;
+};
+
+// returns the exit code, 1 if a comparison found a case that got slower
+int run_suite(const SuiteOptions& options);
+
+[[nodiscard]] std::vector<BenchResult> run_suite_cases(int max_shapes);
+
+bool write_results_json(const std::vector<BenchResult>& results, const std::string& path);
+
+// reads the results written by write_results_json
+[[nodiscard]] std::vector<BenchResult> read_results_json(const std::string& path);